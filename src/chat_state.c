@@ -156,10 +156,9 @@ _send_if_supported(const char * const barejid, void(*send_func)(const char * con
     GString *jid = g_string_new(barejid);
     ChatSession *session = chat_session_get(barejid);
     if (session) {
-        if (session->send_states) {
-            g_string_append(jid, "/");
-            g_string_append(jid, session->resource);
-        } else {
+        g_string_append(jid, "/");
+        g_string_append(jid, session->resource);
+        if (!session->send_states && !caps_jid_has_feature(jid->str, FEATURE_CHATSTATES)) {
             send = FALSE;
         }
     }
@@ -75,6 +75,7 @@
 static gboolean _cmd_execute(ProfWin *window, const char * const command, const char * const inp);
 
 static char * _cmd_complete_parameters(ProfWin *window, const char * const input);
+static void _cmd_completers_check(void);
 
 static char * _sub_autocomplete(ProfWin *window, const char * const input);
 static char * _notify_autocomplete(ProfWin *window, const char * const input);
@@ -746,7 +747,8 @@ static struct cmd_t command_defs[] =
             "/wins tidy",
             "/wins autotidy on|off",
             "/wins prune",
-            "/wins swap <source> <target>")
+            "/wins swap <source> <target>",
+            "/wins hibernate <minutes>|off")
         CMD_DESC(
             "Manage windows. "
             "Passing no argument will list all currently active windows and information about their usage.")
@@ -754,7 +756,9 @@ static struct cmd_t command_defs[] =
             { "tidy",                   "Move windows so there are no gaps." },
             { "autotidy on|off",        "Automatically remove gaps when closing windows." },
             { "prune",                  "Close all windows with no unread messages, and then tidy so there are no gaps." },
-            { "swap <source> <target>", "Swap windows, target may be an empty position." })
+            { "swap <source> <target>", "Swap windows, target may be an empty position." },
+            { "hibernate <minutes>",    "Release the display memory of chat and private windows not viewed for the given number of minutes, they are rebuilt when next shown." },
+            { "hibernate off",          "Do not hibernate idle windows." })
         CMD_NOEXAMPLES
     },
 
@@ -997,7 +1001,7 @@ static struct cmd_t command_defs[] =
     },
 
     { "/notify",
-        cmd_notify, parse_args, 2, 3, &cons_notify_setting,
+        cmd_notify, parse_args, 2, 4, &cons_notify_setting,
         CMD_TAGS(
             CMD_TAG_UI,
             CMD_TAG_CHAT,
@@ -1009,6 +1013,9 @@ static struct cmd_t command_defs[] =
             "/notify room on|off|mention",
             "/notify room current on|off",
             "/notify room text on|off",
+            "/notify room trigger add <text>",
+            "/notify room trigger remove <text>",
+            "/notify room trigger list",
             "/notify remind <seconds>",
             "/notify typing on|off",
             "/notify typing current on|off",
@@ -1020,9 +1027,12 @@ static struct cmd_t command_defs[] =
             { "message on|off", "Notifications for regular chat messages." },
             { "message current on|off", "Whether messages in the current window trigger notifications." },
             { "message text on|off", "Show message text in regular message notifications." },
-            { "room on|off|mention", "Notifications for chat room messages, mention triggers notifications only when your nick is mentioned." },
+            { "room on|off|mention", "Notifications for chat room messages, mention triggers notifications only when your nick or a trigger is mentioned." },
             { "room current on|off", "Whether chat room messages in the current window trigger notifications." },
             { "room text on|off", "Show message text in chat room message notifications." },
+            { "room trigger add <text>", "Add a word that counts as a mention in chat rooms, matched ignoring case." },
+            { "room trigger remove <text>", "Remove a chat room mention trigger." },
+            { "room trigger list", "List chat room mention triggers." },
             { "remind <seconds>", "Notification reminder period for unread messages, use 0 to disable." },
             { "typing on|off", "Notifications when contacts are typing." },
             { "typing current on|off", "Whether typing notifications are triggered for the current window." },
@@ -1034,6 +1044,7 @@ static struct cmd_t command_defs[] =
             "/notify room mention",
             "/notify room current off",
             "/notify room text off",
+            "/notify room trigger add kernel",
             "/notify remind 10",
             "/notify typing on",
             "/notify invite on")
@@ -1053,6 +1064,22 @@ static struct cmd_t command_defs[] =
         CMD_NOEXAMPLES
     },
 
+    { "/fuzzy",
+        cmd_fuzzy, parse_args, 1, 1, &cons_fuzzy_setting,
+        CMD_TAGS(
+            CMD_TAG_UI)
+        CMD_SYN(
+            "/fuzzy on|off")
+        CMD_DESC(
+            "Fuzzy tab completion of contact names, JIDs and room nicknames. "
+            "Matches need not start with the text typed, and are ordered by "
+            "how closely they match and how recently you talked to them. "
+            "Falls back to prefix completion when nothing matches.")
+        CMD_ARGS(
+            { "on|off", "Enable or disable fuzzy completion." })
+        CMD_NOEXAMPLES
+    },
+
     { "/intype",
         cmd_intype, parse_args, 1, 1, &cons_intype_setting,
         CMD_TAGS(
@@ -1380,6 +1407,21 @@ static struct cmd_t command_defs[] =
         CMD_NOEXAMPLES
     },
 
+    { "/sm",
+        cmd_sm, parse_args, 1, 1, &cons_sm_setting,
+        CMD_TAGS(
+            CMD_TAG_CONNECTION)
+        CMD_SYN(
+            "/sm on|off")
+        CMD_DESC(
+            "Enable or disable stream management (XEP-0198) for new connections. "
+            "The server acknowledges the stanzas it receives, and messages left unacknowledged when the connection is lost are sent again after reconnecting. "
+            "Only enable if your server supports stream management.")
+        CMD_ARGS(
+            { "on|off", "Enable or disable stream management." })
+        CMD_NOEXAMPLES
+    },
+
     { "/autoping",
         cmd_autoping, parse_args, 1, 1, &cons_autoping_setting,
         CMD_TAGS(
@@ -1690,6 +1732,7 @@ static Autocomplete help_ac;
 static Autocomplete help_commands_ac;
 static Autocomplete notify_ac;
 static Autocomplete notify_room_ac;
+static Autocomplete notify_room_trigger_ac;
 static Autocomplete notify_message_ac;
 static Autocomplete notify_typing_ac;
 static Autocomplete prefs_ac;
@@ -1746,6 +1789,92 @@ static Autocomplete pgp_log_ac;
 static Autocomplete tls_ac;
 static Autocomplete tls_certpath_ac;
 
+// completion choices, sorted by strcmp so autocompleters wrap them without copying
+static const char * const help_commands_choices[] = { "chat", "connection", "discovery",
+    "groupchat", "presence", "roster", "ui" };
+static const char * const prefs_choices[] = { "chat", "conn", "desktop", "log", "otr", "pgp",
+    "presence", "ui" };
+static const char * const notify_choices[] = { "invite", "message", "remind", "room", "sub",
+    "typing" };
+static const char * const notify_message_choices[] = { "current", "off", "on", "text" };
+static const char * const notify_room_choices[] = { "current", "mention", "off", "on", "text",
+    "trigger" };
+static const char * const notify_room_trigger_choices[] = { "add", "list", "remove" };
+static const char * const notify_typing_choices[] = { "current", "off", "on" };
+static const char * const sub_choices[] = { "allow", "deny", "received", "request", "sent", "show" };
+static const char * const titlebar_choices[] = { "goodbye", "show" };
+static const char * const log_choices[] = { "maxsize", "rotate", "shared", "where" };
+static const char * const autoaway_choices[] = { "check", "message", "mode", "time" };
+static const char * const autoaway_mode_choices[] = { "away", "idle", "off" };
+static const char * const autoaway_presence_choices[] = { "away", "xa" };
+static const char * const autoconnect_choices[] = { "off", "set" };
+static const char * const theme_choices[] = { "colours", "list", "load" };
+static const char * const disco_choices[] = { "info", "items" };
+static const char * const account_choices[] = { "add", "clear", "default", "disable", "enable",
+    "list", "remove", "rename", "set", "show" };
+static const char * const account_set_choices[] = { "away", "chat", "dnd", "eval_password", "jid",
+    "muc", "nick", "online", "otr", "password", "pgpkeyid", "port", "resource", "server", "status",
+    "xa" };
+static const char * const account_clear_choices[] = { "eval_password", "otr", "password",
+    "pgpkeyid", "port", "server" };
+static const char * const account_default_choices[] = { "off", "set" };
+static const char * const account_status_choices[] = { "away", "chat", "dnd", "last", "online", "xa" };
+static const char * const close_choices[] = { "all", "read" };
+static const char * const wins_choices[] = { "autotidy", "hibernate", "prune", "swap", "tidy" };
+static const char * const roster_choices[] = { "add", "by", "clearnick", "hide", "nick", "online",
+    "remove", "remove_all", "show", "size" };
+static const char * const roster_option_choices[] = { "empty", "offline", "resource" };
+static const char * const roster_by_choices[] = { "group", "none", "presence" };
+static const char * const roster_remove_all_choices[] = { "contacts" };
+static const char * const group_choices[] = { "add", "remove", "show" };
+static const char * const who_roster_choices[] = { "any", "available", "away", "chat", "dnd",
+    "offline", "online", "unavailable", "xa" };
+static const char * const who_room_choices[] = { "admin", "available", "away", "chat", "dnd",
+    "member", "moderator", "online", "owner", "participant", "unavailable", "visitor", "xa" };
+static const char * const bookmark_choices[] = { "add", "join", "list", "remove", "update" };
+static const char * const bookmark_property_choices[] = { "autojoin", "nick", "password" };
+static const char * const otr_choices[] = { "answer", "char", "end", "gen", "libver", "log", "myfp",
+    "policy", "question", "secret", "start", "theirfp", "trust", "untrust" };
+static const char * const otr_log_choices[] = { "off", "on", "redact" };
+static const char * const otr_policy_choices[] = { "always", "manual", "opportunistic" };
+static const char * const connect_property_choices[] = { "port", "server" };
+static const char * const join_property_choices[] = { "nick", "password" };
+static const char * const statuses_choices[] = { "chat", "console", "muc" };
+static const char * const statuses_setting_choices[] = { "all", "none", "online" };
+static const char * const alias_choices[] = { "add", "list", "remove" };
+static const char * const room_choices[] = { "accept", "config", "destroy" };
+static const char * const affiliation_choices[] = { "admin", "member", "none", "outcast", "owner" };
+static const char * const role_choices[] = { "moderator", "none", "participant", "visitor" };
+static const char * const privilege_cmd_choices[] = { "list", "set" };
+static const char * const subject_choices[] = { "clear", "set" };
+static const char * const form_choices[] = { "cancel", "help", "show", "submit" };
+static const char * const form_field_multi_choices[] = { "add", "remove" };
+static const char * const occupants_choices[] = { "default", "hide", "show", "size" };
+static const char * const occupants_default_choices[] = { "hide", "show" };
+static const char * const occupants_show_choices[] = { "jid" };
+static const char * const time_choices[] = { "chat", "console", "lastactivity", "muc", "mucconfig",
+    "private", "statusbar", "xml" };
+static const char * const time_format_choices[] = { "off", "set" };
+static const char * const resource_choices[] = { "message", "off", "set", "title" };
+static const char * const inpblock_choices[] = { "dynamic", "timeout" };
+static const char * const receipts_choices[] = { "request", "send" };
+static const char * const pgp_choices[] = { "char", "contacts", "end", "keys", "libver", "log",
+    "setkey", "start" };
+static const char * const pgp_log_choices[] = { "off", "on", "redact" };
+static const char * const tls_choices[] = { "allow", "always", "certpath", "deny", "revoke",
+    "trusted" };
+static const char * const tls_certpath_choices[] = { "clear", "set" };
+
+// command and help topic names point into command_defs
+static const char *command_names[ARRAY_SIZE(command_defs)];
+static const char *help_names[ARRAY_SIZE(command_defs) + 2];
+
+static int
+_cmd_name_compare(const void *a, const void *b)
+{
+    return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
 /*
  * Initialise command autocompleter and history
  */
@@ -1753,13 +1882,7 @@ void
 cmd_init(void)
 {
     log_info("Initialising commands");
-
-    commands_ac = autocomplete_new();
-    aliases_ac = autocomplete_new();
-
-    help_ac = autocomplete_new();
-    autocomplete_add(help_ac, "commands");
-    autocomplete_add(help_ac, "navigation");
+    _cmd_completers_check();
 
     // load command defs into hash table
     commands = g_hash_table_new(g_str_hash, g_str_equal);
@@ -1770,10 +1893,19 @@ cmd_init(void)
         // add to hash
         g_hash_table_insert(commands, pcmd->cmd, pcmd);
 
-        // add to commands and help autocompleters
-        autocomplete_add(commands_ac, pcmd->cmd);
-        autocomplete_add(help_ac, pcmd->cmd+1);
+        // name the commands and help topics from the defs, sorted once
+        command_names[i] = pcmd->cmd;
+        help_names[i] = pcmd->cmd+1;
     }
+    help_names[i++] = "commands";
+    help_names[i++] = "navigation";
+    qsort(command_names, ARRAY_SIZE(command_names), sizeof(char *), _cmd_name_compare);
+    qsort(help_names, ARRAY_SIZE(help_names), sizeof(char *), _cmd_name_compare);
+
+    // aliases and form fields are added over the command names
+    commands_ac = autocomplete_new_static(command_names, ARRAY_SIZE(command_names));
+    aliases_ac = autocomplete_new();
+    help_ac = autocomplete_new_static(help_names, ARRAY_SIZE(help_names));
 
     // load aliases
     GList *aliases = prefs_get_aliases();
@@ -1789,379 +1921,68 @@ cmd_init(void)
     }
     prefs_free_aliases(aliases);
 
-    help_commands_ac = autocomplete_new();
-    autocomplete_add(help_commands_ac, "chat");
-    autocomplete_add(help_commands_ac, "groupchat");
-    autocomplete_add(help_commands_ac, "roster");
-    autocomplete_add(help_commands_ac, "presence");
-    autocomplete_add(help_commands_ac, "discovery");
-    autocomplete_add(help_commands_ac, "connection");
-    autocomplete_add(help_commands_ac, "ui");
-
-    prefs_ac = autocomplete_new();
-    autocomplete_add(prefs_ac, "ui");
-    autocomplete_add(prefs_ac, "desktop");
-    autocomplete_add(prefs_ac, "chat");
-    autocomplete_add(prefs_ac, "log");
-    autocomplete_add(prefs_ac, "conn");
-    autocomplete_add(prefs_ac, "presence");
-    autocomplete_add(prefs_ac, "otr");
-    autocomplete_add(prefs_ac, "pgp");
-
-    notify_ac = autocomplete_new();
-    autocomplete_add(notify_ac, "message");
-    autocomplete_add(notify_ac, "room");
-    autocomplete_add(notify_ac, "typing");
-    autocomplete_add(notify_ac, "remind");
-    autocomplete_add(notify_ac, "invite");
-    autocomplete_add(notify_ac, "sub");
-
-    notify_message_ac = autocomplete_new();
-    autocomplete_add(notify_message_ac, "on");
-    autocomplete_add(notify_message_ac, "off");
-    autocomplete_add(notify_message_ac, "current");
-    autocomplete_add(notify_message_ac, "text");
-
-    notify_room_ac = autocomplete_new();
-    autocomplete_add(notify_room_ac, "on");
-    autocomplete_add(notify_room_ac, "off");
-    autocomplete_add(notify_room_ac, "mention");
-    autocomplete_add(notify_room_ac, "current");
-    autocomplete_add(notify_room_ac, "text");
-
-    notify_typing_ac = autocomplete_new();
-    autocomplete_add(notify_typing_ac, "on");
-    autocomplete_add(notify_typing_ac, "off");
-    autocomplete_add(notify_typing_ac, "current");
-
-    sub_ac = autocomplete_new();
-    autocomplete_add(sub_ac, "request");
-    autocomplete_add(sub_ac, "allow");
-    autocomplete_add(sub_ac, "deny");
-    autocomplete_add(sub_ac, "show");
-    autocomplete_add(sub_ac, "sent");
-    autocomplete_add(sub_ac, "received");
-
-    titlebar_ac = autocomplete_new();
-    autocomplete_add(titlebar_ac, "show");
-    autocomplete_add(titlebar_ac, "goodbye");
-
-    log_ac = autocomplete_new();
-    autocomplete_add(log_ac, "maxsize");
-    autocomplete_add(log_ac, "rotate");
-    autocomplete_add(log_ac, "shared");
-    autocomplete_add(log_ac, "where");
-
-    autoaway_ac = autocomplete_new();
-    autocomplete_add(autoaway_ac, "mode");
-    autocomplete_add(autoaway_ac, "time");
-    autocomplete_add(autoaway_ac, "message");
-    autocomplete_add(autoaway_ac, "check");
-
-    autoaway_mode_ac = autocomplete_new();
-    autocomplete_add(autoaway_mode_ac, "away");
-    autocomplete_add(autoaway_mode_ac, "idle");
-    autocomplete_add(autoaway_mode_ac, "off");
-
-    autoaway_presence_ac = autocomplete_new();
-    autocomplete_add(autoaway_presence_ac, "away");
-    autocomplete_add(autoaway_presence_ac, "xa");
-
-    autoconnect_ac = autocomplete_new();
-    autocomplete_add(autoconnect_ac, "set");
-    autocomplete_add(autoconnect_ac, "off");
-
-    theme_ac = autocomplete_new();
-    autocomplete_add(theme_ac, "load");
-    autocomplete_add(theme_ac, "list");
-    autocomplete_add(theme_ac, "colours");
-
-    disco_ac = autocomplete_new();
-    autocomplete_add(disco_ac, "info");
-    autocomplete_add(disco_ac, "items");
-
-    account_ac = autocomplete_new();
-    autocomplete_add(account_ac, "list");
-    autocomplete_add(account_ac, "show");
-    autocomplete_add(account_ac, "add");
-    autocomplete_add(account_ac, "remove");
-    autocomplete_add(account_ac, "enable");
-    autocomplete_add(account_ac, "disable");
-    autocomplete_add(account_ac, "default");
-    autocomplete_add(account_ac, "rename");
-    autocomplete_add(account_ac, "set");
-    autocomplete_add(account_ac, "clear");
-
-    account_set_ac = autocomplete_new();
-    autocomplete_add(account_set_ac, "jid");
-    autocomplete_add(account_set_ac, "server");
-    autocomplete_add(account_set_ac, "port");
-    autocomplete_add(account_set_ac, "status");
-    autocomplete_add(account_set_ac, "online");
-    autocomplete_add(account_set_ac, "chat");
-    autocomplete_add(account_set_ac, "away");
-    autocomplete_add(account_set_ac, "xa");
-    autocomplete_add(account_set_ac, "dnd");
-    autocomplete_add(account_set_ac, "resource");
-    autocomplete_add(account_set_ac, "password");
-    autocomplete_add(account_set_ac, "eval_password");
-    autocomplete_add(account_set_ac, "muc");
-    autocomplete_add(account_set_ac, "nick");
-    autocomplete_add(account_set_ac, "otr");
-    autocomplete_add(account_set_ac, "pgpkeyid");
-
-    account_clear_ac = autocomplete_new();
-    autocomplete_add(account_clear_ac, "password");
-    autocomplete_add(account_clear_ac, "eval_password");
-    autocomplete_add(account_clear_ac, "server");
-    autocomplete_add(account_clear_ac, "port");
-    autocomplete_add(account_clear_ac, "otr");
-    autocomplete_add(account_clear_ac, "pgpkeyid");
-
-    account_default_ac = autocomplete_new();
-    autocomplete_add(account_default_ac, "set");
-    autocomplete_add(account_default_ac, "off");
-
-    account_status_ac = autocomplete_new();
-    autocomplete_add(account_status_ac, "online");
-    autocomplete_add(account_status_ac, "chat");
-    autocomplete_add(account_status_ac, "away");
-    autocomplete_add(account_status_ac, "xa");
-    autocomplete_add(account_status_ac, "dnd");
-    autocomplete_add(account_status_ac, "last");
-
-    close_ac = autocomplete_new();
-    autocomplete_add(close_ac, "read");
-    autocomplete_add(close_ac, "all");
-
-    wins_ac = autocomplete_new();
-    autocomplete_add(wins_ac, "prune");
-    autocomplete_add(wins_ac, "tidy");
-    autocomplete_add(wins_ac, "autotidy");
-    autocomplete_add(wins_ac, "swap");
-
-    roster_ac = autocomplete_new();
-    autocomplete_add(roster_ac, "add");
-    autocomplete_add(roster_ac, "online");
-    autocomplete_add(roster_ac, "nick");
-    autocomplete_add(roster_ac, "clearnick");
-    autocomplete_add(roster_ac, "remove");
-    autocomplete_add(roster_ac, "remove_all");
-    autocomplete_add(roster_ac, "show");
-    autocomplete_add(roster_ac, "hide");
-    autocomplete_add(roster_ac, "by");
-    autocomplete_add(roster_ac, "size");
-
-    roster_option_ac = autocomplete_new();
-    autocomplete_add(roster_option_ac, "offline");
-    autocomplete_add(roster_option_ac, "resource");
-    autocomplete_add(roster_option_ac, "empty");
-
-    roster_by_ac = autocomplete_new();
-    autocomplete_add(roster_by_ac, "group");
-    autocomplete_add(roster_by_ac, "presence");
-    autocomplete_add(roster_by_ac, "none");
-
-    roster_remove_all_ac = autocomplete_new();
-    autocomplete_add(roster_remove_all_ac, "contacts");
-
-    group_ac = autocomplete_new();
-    autocomplete_add(group_ac, "show");
-    autocomplete_add(group_ac, "add");
-    autocomplete_add(group_ac, "remove");
+    help_commands_ac = autocomplete_new_static(help_commands_choices, ARRAY_SIZE(help_commands_choices));
+    prefs_ac = autocomplete_new_static(prefs_choices, ARRAY_SIZE(prefs_choices));
+    notify_ac = autocomplete_new_static(notify_choices, ARRAY_SIZE(notify_choices));
+    notify_message_ac = autocomplete_new_static(notify_message_choices, ARRAY_SIZE(notify_message_choices));
+    notify_room_ac = autocomplete_new_static(notify_room_choices, ARRAY_SIZE(notify_room_choices));
+    notify_room_trigger_ac = autocomplete_new_static(notify_room_trigger_choices, ARRAY_SIZE(notify_room_trigger_choices));
+    notify_typing_ac = autocomplete_new_static(notify_typing_choices, ARRAY_SIZE(notify_typing_choices));
+    sub_ac = autocomplete_new_static(sub_choices, ARRAY_SIZE(sub_choices));
+    titlebar_ac = autocomplete_new_static(titlebar_choices, ARRAY_SIZE(titlebar_choices));
+    log_ac = autocomplete_new_static(log_choices, ARRAY_SIZE(log_choices));
+    autoaway_ac = autocomplete_new_static(autoaway_choices, ARRAY_SIZE(autoaway_choices));
+    autoaway_mode_ac = autocomplete_new_static(autoaway_mode_choices, ARRAY_SIZE(autoaway_mode_choices));
+    autoaway_presence_ac = autocomplete_new_static(autoaway_presence_choices, ARRAY_SIZE(autoaway_presence_choices));
+    autoconnect_ac = autocomplete_new_static(autoconnect_choices, ARRAY_SIZE(autoconnect_choices));
+    theme_ac = autocomplete_new_static(theme_choices, ARRAY_SIZE(theme_choices));
+    disco_ac = autocomplete_new_static(disco_choices, ARRAY_SIZE(disco_choices));
+    account_ac = autocomplete_new_static(account_choices, ARRAY_SIZE(account_choices));
+    account_set_ac = autocomplete_new_static(account_set_choices, ARRAY_SIZE(account_set_choices));
+    account_clear_ac = autocomplete_new_static(account_clear_choices, ARRAY_SIZE(account_clear_choices));
+    account_default_ac = autocomplete_new_static(account_default_choices, ARRAY_SIZE(account_default_choices));
+    account_status_ac = autocomplete_new_static(account_status_choices, ARRAY_SIZE(account_status_choices));
+    close_ac = autocomplete_new_static(close_choices, ARRAY_SIZE(close_choices));
+    wins_ac = autocomplete_new_static(wins_choices, ARRAY_SIZE(wins_choices));
+    roster_ac = autocomplete_new_static(roster_choices, ARRAY_SIZE(roster_choices));
+    roster_option_ac = autocomplete_new_static(roster_option_choices, ARRAY_SIZE(roster_option_choices));
+    roster_by_ac = autocomplete_new_static(roster_by_choices, ARRAY_SIZE(roster_by_choices));
+    roster_remove_all_ac = autocomplete_new_static(roster_remove_all_choices, ARRAY_SIZE(roster_remove_all_choices));
+    group_ac = autocomplete_new_static(group_choices, ARRAY_SIZE(group_choices));
 
     theme_load_ac = NULL;
 
-    who_roster_ac = autocomplete_new();
-    autocomplete_add(who_roster_ac, "chat");
-    autocomplete_add(who_roster_ac, "online");
-    autocomplete_add(who_roster_ac, "away");
-    autocomplete_add(who_roster_ac, "xa");
-    autocomplete_add(who_roster_ac, "dnd");
-    autocomplete_add(who_roster_ac, "offline");
-    autocomplete_add(who_roster_ac, "available");
-    autocomplete_add(who_roster_ac, "unavailable");
-    autocomplete_add(who_roster_ac, "any");
-
-    who_room_ac = autocomplete_new();
-    autocomplete_add(who_room_ac, "chat");
-    autocomplete_add(who_room_ac, "online");
-    autocomplete_add(who_room_ac, "away");
-    autocomplete_add(who_room_ac, "xa");
-    autocomplete_add(who_room_ac, "dnd");
-    autocomplete_add(who_room_ac, "available");
-    autocomplete_add(who_room_ac, "unavailable");
-    autocomplete_add(who_room_ac, "moderator");
-    autocomplete_add(who_room_ac, "participant");
-    autocomplete_add(who_room_ac, "visitor");
-    autocomplete_add(who_room_ac, "owner");
-    autocomplete_add(who_room_ac, "admin");
-    autocomplete_add(who_room_ac, "member");
-
-    bookmark_ac = autocomplete_new();
-    autocomplete_add(bookmark_ac, "list");
-    autocomplete_add(bookmark_ac, "add");
-    autocomplete_add(bookmark_ac, "update");
-    autocomplete_add(bookmark_ac, "remove");
-    autocomplete_add(bookmark_ac, "join");
-
-    bookmark_property_ac = autocomplete_new();
-    autocomplete_add(bookmark_property_ac, "nick");
-    autocomplete_add(bookmark_property_ac, "password");
-    autocomplete_add(bookmark_property_ac, "autojoin");
-
-    otr_ac = autocomplete_new();
-    autocomplete_add(otr_ac, "gen");
-    autocomplete_add(otr_ac, "start");
-    autocomplete_add(otr_ac, "end");
-    autocomplete_add(otr_ac, "myfp");
-    autocomplete_add(otr_ac, "theirfp");
-    autocomplete_add(otr_ac, "trust");
-    autocomplete_add(otr_ac, "untrust");
-    autocomplete_add(otr_ac, "secret");
-    autocomplete_add(otr_ac, "log");
-    autocomplete_add(otr_ac, "libver");
-    autocomplete_add(otr_ac, "policy");
-    autocomplete_add(otr_ac, "question");
-    autocomplete_add(otr_ac, "answer");
-    autocomplete_add(otr_ac, "char");
-
-    otr_log_ac = autocomplete_new();
-    autocomplete_add(otr_log_ac, "on");
-    autocomplete_add(otr_log_ac, "off");
-    autocomplete_add(otr_log_ac, "redact");
-
-    otr_policy_ac = autocomplete_new();
-    autocomplete_add(otr_policy_ac, "manual");
-    autocomplete_add(otr_policy_ac, "opportunistic");
-    autocomplete_add(otr_policy_ac, "always");
-
-    connect_property_ac = autocomplete_new();
-    autocomplete_add(connect_property_ac, "server");
-    autocomplete_add(connect_property_ac, "port");
-
-    join_property_ac = autocomplete_new();
-    autocomplete_add(join_property_ac, "nick");
-    autocomplete_add(join_property_ac, "password");
-
-    statuses_ac = autocomplete_new();
-    autocomplete_add(statuses_ac, "console");
-    autocomplete_add(statuses_ac, "chat");
-    autocomplete_add(statuses_ac, "muc");
-
-    statuses_setting_ac = autocomplete_new();
-    autocomplete_add(statuses_setting_ac, "all");
-    autocomplete_add(statuses_setting_ac, "online");
-    autocomplete_add(statuses_setting_ac, "none");
-
-    alias_ac = autocomplete_new();
-    autocomplete_add(alias_ac, "add");
-    autocomplete_add(alias_ac, "remove");
-    autocomplete_add(alias_ac, "list");
-
-    room_ac = autocomplete_new();
-    autocomplete_add(room_ac, "accept");
-    autocomplete_add(room_ac, "destroy");
-    autocomplete_add(room_ac, "config");
-
-    affiliation_ac = autocomplete_new();
-    autocomplete_add(affiliation_ac, "owner");
-    autocomplete_add(affiliation_ac, "admin");
-    autocomplete_add(affiliation_ac, "member");
-    autocomplete_add(affiliation_ac, "none");
-    autocomplete_add(affiliation_ac, "outcast");
-
-    role_ac = autocomplete_new();
-    autocomplete_add(role_ac, "moderator");
-    autocomplete_add(role_ac, "participant");
-    autocomplete_add(role_ac, "visitor");
-    autocomplete_add(role_ac, "none");
-
-    privilege_cmd_ac = autocomplete_new();
-    autocomplete_add(privilege_cmd_ac, "list");
-    autocomplete_add(privilege_cmd_ac, "set");
-
-    subject_ac = autocomplete_new();
-    autocomplete_add(subject_ac, "set");
-    autocomplete_add(subject_ac, "clear");
-
-    form_ac = autocomplete_new();
-    autocomplete_add(form_ac, "submit");
-    autocomplete_add(form_ac, "cancel");
-    autocomplete_add(form_ac, "show");
-    autocomplete_add(form_ac, "help");
-
-    form_field_multi_ac = autocomplete_new();
-    autocomplete_add(form_field_multi_ac, "add");
-    autocomplete_add(form_field_multi_ac, "remove");
-
-    occupants_ac = autocomplete_new();
-    autocomplete_add(occupants_ac, "show");
-    autocomplete_add(occupants_ac, "hide");
-    autocomplete_add(occupants_ac, "default");
-    autocomplete_add(occupants_ac, "size");
-
-    occupants_default_ac = autocomplete_new();
-    autocomplete_add(occupants_default_ac, "show");
-    autocomplete_add(occupants_default_ac, "hide");
-
-    occupants_show_ac = autocomplete_new();
-    autocomplete_add(occupants_show_ac, "jid");
-
-    time_ac = autocomplete_new();
-    autocomplete_add(time_ac, "console");
-    autocomplete_add(time_ac, "chat");
-    autocomplete_add(time_ac, "muc");
-    autocomplete_add(time_ac, "mucconfig");
-    autocomplete_add(time_ac, "private");
-    autocomplete_add(time_ac, "xml");
-    autocomplete_add(time_ac, "statusbar");
-    autocomplete_add(time_ac, "lastactivity");
-
-    time_format_ac = autocomplete_new();
-    autocomplete_add(time_format_ac, "set");
-    autocomplete_add(time_format_ac, "off");
-
-    resource_ac = autocomplete_new();
-    autocomplete_add(resource_ac, "set");
-    autocomplete_add(resource_ac, "off");
-    autocomplete_add(resource_ac, "title");
-    autocomplete_add(resource_ac, "message");
-
-    inpblock_ac = autocomplete_new();
-    autocomplete_add(inpblock_ac, "timeout");
-    autocomplete_add(inpblock_ac, "dynamic");
-
-    receipts_ac = autocomplete_new();
-    autocomplete_add(receipts_ac, "send");
-    autocomplete_add(receipts_ac, "request");
-
-    pgp_ac = autocomplete_new();
-    autocomplete_add(pgp_ac, "keys");
-    autocomplete_add(pgp_ac, "contacts");
-    autocomplete_add(pgp_ac, "setkey");
-    autocomplete_add(pgp_ac, "libver");
-    autocomplete_add(pgp_ac, "start");
-    autocomplete_add(pgp_ac, "end");
-    autocomplete_add(pgp_ac, "log");
-    autocomplete_add(pgp_ac, "char");
-
-    pgp_log_ac = autocomplete_new();
-    autocomplete_add(pgp_log_ac, "on");
-    autocomplete_add(pgp_log_ac, "off");
-    autocomplete_add(pgp_log_ac, "redact");
-
-    tls_ac = autocomplete_new();
-    autocomplete_add(tls_ac, "allow");
-    autocomplete_add(tls_ac, "always");
-    autocomplete_add(tls_ac, "deny");
-    autocomplete_add(tls_ac, "trusted");
-    autocomplete_add(tls_ac, "revoke");
-    autocomplete_add(tls_ac, "certpath");
-
-    tls_certpath_ac = autocomplete_new();
-    autocomplete_add(tls_certpath_ac, "set");
-    autocomplete_add(tls_certpath_ac, "clear");
+    who_roster_ac = autocomplete_new_static(who_roster_choices, ARRAY_SIZE(who_roster_choices));
+    who_room_ac = autocomplete_new_static(who_room_choices, ARRAY_SIZE(who_room_choices));
+    bookmark_ac = autocomplete_new_static(bookmark_choices, ARRAY_SIZE(bookmark_choices));
+    bookmark_property_ac = autocomplete_new_static(bookmark_property_choices, ARRAY_SIZE(bookmark_property_choices));
+    otr_ac = autocomplete_new_static(otr_choices, ARRAY_SIZE(otr_choices));
+    otr_log_ac = autocomplete_new_static(otr_log_choices, ARRAY_SIZE(otr_log_choices));
+    otr_policy_ac = autocomplete_new_static(otr_policy_choices, ARRAY_SIZE(otr_policy_choices));
+    connect_property_ac = autocomplete_new_static(connect_property_choices, ARRAY_SIZE(connect_property_choices));
+    join_property_ac = autocomplete_new_static(join_property_choices, ARRAY_SIZE(join_property_choices));
+    statuses_ac = autocomplete_new_static(statuses_choices, ARRAY_SIZE(statuses_choices));
+    statuses_setting_ac = autocomplete_new_static(statuses_setting_choices, ARRAY_SIZE(statuses_setting_choices));
+    alias_ac = autocomplete_new_static(alias_choices, ARRAY_SIZE(alias_choices));
+    room_ac = autocomplete_new_static(room_choices, ARRAY_SIZE(room_choices));
+    affiliation_ac = autocomplete_new_static(affiliation_choices, ARRAY_SIZE(affiliation_choices));
+    role_ac = autocomplete_new_static(role_choices, ARRAY_SIZE(role_choices));
+    privilege_cmd_ac = autocomplete_new_static(privilege_cmd_choices, ARRAY_SIZE(privilege_cmd_choices));
+    subject_ac = autocomplete_new_static(subject_choices, ARRAY_SIZE(subject_choices));
+    form_ac = autocomplete_new_static(form_choices, ARRAY_SIZE(form_choices));
+    form_field_multi_ac = autocomplete_new_static(form_field_multi_choices, ARRAY_SIZE(form_field_multi_choices));
+    occupants_ac = autocomplete_new_static(occupants_choices, ARRAY_SIZE(occupants_choices));
+    occupants_default_ac = autocomplete_new_static(occupants_default_choices, ARRAY_SIZE(occupants_default_choices));
+    occupants_show_ac = autocomplete_new_static(occupants_show_choices, ARRAY_SIZE(occupants_show_choices));
+    time_ac = autocomplete_new_static(time_choices, ARRAY_SIZE(time_choices));
+    time_format_ac = autocomplete_new_static(time_format_choices, ARRAY_SIZE(time_format_choices));
+    resource_ac = autocomplete_new_static(resource_choices, ARRAY_SIZE(resource_choices));
+    inpblock_ac = autocomplete_new_static(inpblock_choices, ARRAY_SIZE(inpblock_choices));
+    receipts_ac = autocomplete_new_static(receipts_choices, ARRAY_SIZE(receipts_choices));
+    pgp_ac = autocomplete_new_static(pgp_choices, ARRAY_SIZE(pgp_choices));
+    pgp_log_ac = autocomplete_new_static(pgp_log_choices, ARRAY_SIZE(pgp_log_choices));
+    tls_ac = autocomplete_new_static(tls_choices, ARRAY_SIZE(tls_choices));
+    tls_certpath_ac = autocomplete_new_static(tls_certpath_choices, ARRAY_SIZE(tls_certpath_choices));
 }
 
 void
@@ -2175,6 +1996,7 @@ cmd_uninit(void)
     autocomplete_free(notify_ac);
     autocomplete_free(notify_message_ac);
     autocomplete_free(notify_room_ac);
+    autocomplete_free(notify_room_trigger_ac);
     autocomplete_free(notify_typing_ac);
     autocomplete_free(sub_ac);
     autocomplete_free(titlebar_ac);
@@ -2352,6 +2174,7 @@ cmd_reset_autocomplete(ProfWin *window)
     autocomplete_reset(notify_ac);
     autocomplete_reset(notify_message_ac);
     autocomplete_reset(notify_room_ac);
+    autocomplete_reset(notify_room_trigger_ac);
     autocomplete_reset(notify_typing_ac);
     autocomplete_reset(sub_ac);
 
@@ -2552,144 +2375,178 @@ _cmd_execute(ProfWin *window, const char * const command, const char * const inp
 }
 
 static char *
-_cmd_complete_parameters(ProfWin *window, const char * const input)
+_boolean_autocomplete(ProfWin *window, const char * const command, const char * const input)
+{
+    return autocomplete_param_with_func(input, command, prefs_autocomplete_boolean_choice);
+}
+
+static char *
+_contact_autocomplete(ProfWin *window, const char * const command, const char * const input)
 {
-    int i;
     char *result = NULL;
 
-    // autocomplete boolean settings
-    gchar *boolean_choices[] = { "/beep", "/intype", "/states", "/outtype",
-        "/flash", "/splash", "/chlog", "/grlog", "/history", "/vercheck",
-        "/privileges", "/presence", "/wrap", "/winstidy", "/carbons", "/encwarn" };
+    // Remove quote character before and after names when doing autocomplete
+    char *unquoted = strip_arg_quotes(input);
 
-    for (i = 0; i < ARRAY_SIZE(boolean_choices); i++) {
-        result = autocomplete_param_with_func(input, boolean_choices[i], prefs_autocomplete_boolean_choice);
-        if (result) {
-            return result;
-        }
-    }
-
-    // autocomplete nickname in chat rooms
+    // autocomplete nickname in chat rooms, otherwise using roster
     if (window->type == WIN_MUC) {
         ProfMucWin *mucwin = (ProfMucWin*)window;
         assert(mucwin->memcheck == PROFMUCWIN_MEMCHECK);
         Autocomplete nick_ac = muc_roster_ac(mucwin->roomjid);
         if (nick_ac) {
-            gchar *nick_choices[] = { "/msg", "/info", "/caps", "/status", "/software" } ;
-
-            // Remove quote character before and after names when doing autocomplete
-            char *unquoted = strip_arg_quotes(input);
-            for (i = 0; i < ARRAY_SIZE(nick_choices); i++) {
-                result = autocomplete_param_with_ac(unquoted, nick_choices[i], nick_ac, TRUE);
-                if (result) {
-                    free(unquoted);
-                    return result;
-                }
-            }
-            free(unquoted);
+            result = autocomplete_param_with_ac(unquoted, command, nick_ac, TRUE);
         }
-
-    // otherwise autocomplete using roster
     } else {
-        gchar *contact_choices[] = { "/msg", "/info", "/status" };
-        // Remove quote character before and after names when doing autocomplete
-        char *unquoted = strip_arg_quotes(input);
-        for (i = 0; i < ARRAY_SIZE(contact_choices); i++) {
-            result = autocomplete_param_with_func(unquoted, contact_choices[i], roster_contact_autocomplete);
-            if (result) {
-                free(unquoted);
-                return result;
-            }
-        }
-        free(unquoted);
-
-        gchar *resource_choices[] = { "/caps", "/software", "/ping" };
-        for (i = 0; i < ARRAY_SIZE(resource_choices); i++) {
-            result = autocomplete_param_with_func(input, resource_choices[i], roster_fulljid_autocomplete);
-            if (result) {
-                return result;
-            }
-        }
+        result = autocomplete_param_with_func(unquoted, command, roster_contact_autocomplete);
     }
+    free(unquoted);
 
-    result = autocomplete_param_with_func(input, "/invite", roster_contact_autocomplete);
-    if (result) {
-        return result;
-    }
+    return result;
+}
 
-    gchar *invite_choices[] = { "/decline", "/join" };
-    for (i = 0; i < ARRAY_SIZE(invite_choices); i++) {
-        result = autocomplete_param_with_func(input, invite_choices[i], muc_invites_find);
-        if (result) {
-            return result;
+static char *
+_fulljid_autocomplete(ProfWin *window, const char * const command, const char * const input)
+{
+    // autocomplete nickname in chat rooms, otherwise using roster
+    if (window->type == WIN_MUC) {
+        if (g_strcmp0(command, "/ping") == 0) {
+            return NULL;
         }
+        return _contact_autocomplete(window, command, input);
+    } else {
+        return autocomplete_param_with_func(input, command, roster_fulljid_autocomplete);
     }
+}
 
-    gchar *cmds[] = { "/prefs", "/disco", "/close", "/subject", "/room" };
-    Autocomplete completers[] = { prefs_ac, disco_ac, close_ac, subject_ac, room_ac };
+static char *
+_invite_autocomplete(ProfWin *window, const char * const command, const char * const input)
+{
+    return autocomplete_param_with_func(input, command, roster_contact_autocomplete);
+}
 
-    for (i = 0; i < ARRAY_SIZE(cmds); i++) {
-        result = autocomplete_param_with_ac(input, cmds[i], completers[i], TRUE);
-        if (result) {
-            return result;
-        }
+static char *
+_decline_autocomplete(ProfWin *window, const char * const command, const char * const input)
+{
+    return autocomplete_param_with_func(input, command, muc_invites_find);
+}
+
+// parameter completion for a command, exactly one of func, cmd_func or ac is set
+typedef struct cmd_completer_t {
+    const char *cmd;
+    char * (*func)(ProfWin *window, const char * const input);
+    char * (*cmd_func)(ProfWin *window, const char * const command, const char * const input);
+    Autocomplete *ac;
+} CommandCompleter;
+
+// sorted by command for binary search
+static const CommandCompleter cmd_completers[] = {
+    { "/account",       _account_autocomplete,      NULL,                   NULL },
+    { "/affiliation",   _affiliation_autocomplete,  NULL,                   NULL },
+    { "/alias",         _alias_autocomplete,        NULL,                   NULL },
+    { "/autoaway",      _autoaway_autocomplete,     NULL,                   NULL },
+    { "/autoconnect",   _autoconnect_autocomplete,  NULL,                   NULL },
+    { "/ban",           _ban_autocomplete,          NULL,                   NULL },
+    { "/beep",          NULL,                       _boolean_autocomplete,  NULL },
+    { "/bookmark",      _bookmark_autocomplete,     NULL,                   NULL },
+    { "/caps",          NULL,                       _fulljid_autocomplete,  NULL },
+    { "/carbons",       NULL,                       _boolean_autocomplete,  NULL },
+    { "/chlog",         NULL,                       _boolean_autocomplete,  NULL },
+    { "/close",         NULL,                       NULL,                   &close_ac },
+    { "/connect",       _connect_autocomplete,      NULL,                   NULL },
+    { "/decline",       NULL,                       _decline_autocomplete,  NULL },
+    { "/disco",         NULL,                       NULL,                   &disco_ac },
+    { "/encwarn",       NULL,                       _boolean_autocomplete,  NULL },
+    { "/flash",         NULL,                       _boolean_autocomplete,  NULL },
+    { "/form",          _form_autocomplete,         NULL,                   NULL },
+    { "/fuzzy",         NULL,                       _boolean_autocomplete,  NULL },
+    { "/grlog",         NULL,                       _boolean_autocomplete,  NULL },
+    { "/group",         _group_autocomplete,        NULL,                   NULL },
+    { "/help",          _help_autocomplete,         NULL,                   NULL },
+    { "/history",       NULL,                       _boolean_autocomplete,  NULL },
+    { "/info",          NULL,                       _contact_autocomplete,  NULL },
+    { "/inpblock",      _inpblock_autocomplete,     NULL,                   NULL },
+    { "/intype",        NULL,                       _boolean_autocomplete,  NULL },
+    { "/invite",        NULL,                       _invite_autocomplete,   NULL },
+    { "/join",          _join_autocomplete,         NULL,                   NULL },
+    { "/kick",          _kick_autocomplete,         NULL,                   NULL },
+    { "/log",           _log_autocomplete,          NULL,                   NULL },
+    { "/msg",           NULL,                       _contact_autocomplete,  NULL },
+    { "/notify",        _notify_autocomplete,       NULL,                   NULL },
+    { "/occupants",     _occupants_autocomplete,    NULL,                   NULL },
+    { "/otr",           _otr_autocomplete,          NULL,                   NULL },
+    { "/outtype",       NULL,                       _boolean_autocomplete,  NULL },
+    { "/pgp",           _pgp_autocomplete,          NULL,                   NULL },
+    { "/ping",          NULL,                       _fulljid_autocomplete,  NULL },
+    { "/prefs",         NULL,                       NULL,                   &prefs_ac },
+    { "/presence",      NULL,                       _boolean_autocomplete,  NULL },
+    { "/privileges",    NULL,                       _boolean_autocomplete,  NULL },
+    { "/receipts",      _receipts_autocomplete,     NULL,                   NULL },
+    { "/resource",      _resource_autocomplete,     NULL,                   NULL },
+    { "/role",          _role_autocomplete,         NULL,                   NULL },
+    { "/room",          NULL,                       NULL,                   &room_ac },
+    { "/roster",        _roster_autocomplete,       NULL,                   NULL },
+    { "/sm",            NULL,                       _boolean_autocomplete,  NULL },
+    { "/software",      NULL,                       _fulljid_autocomplete,  NULL },
+    { "/splash",        NULL,                       _boolean_autocomplete,  NULL },
+    { "/states",        NULL,                       _boolean_autocomplete,  NULL },
+    { "/status",        NULL,                       _contact_autocomplete,  NULL },
+    { "/statuses",      _statuses_autocomplete,     NULL,                   NULL },
+    { "/sub",           _sub_autocomplete,          NULL,                   NULL },
+    { "/subject",       NULL,                       NULL,                   &subject_ac },
+    { "/theme",         _theme_autocomplete,        NULL,                   NULL },
+    { "/time",          _time_autocomplete,         NULL,                   NULL },
+    { "/titlebar",      _titlebar_autocomplete,     NULL,                   NULL },
+    { "/tls",           _tls_autocomplete,          NULL,                   NULL },
+    { "/vercheck",      NULL,                       _boolean_autocomplete,  NULL },
+    { "/who",           _who_autocomplete,          NULL,                   NULL },
+    { "/wins",          _wins_autocomplete,         NULL,                   NULL },
+    { "/winstidy",      NULL,                       _boolean_autocomplete,  NULL },
+    { "/wrap",          NULL,                       _boolean_autocomplete,  NULL },
+};
+
+// parameter completers are looked up by binary search
+static void
+_cmd_completers_check(void)
+{
+    unsigned int i;
+    for (i = 1; i < ARRAY_SIZE(cmd_completers); i++) {
+        assert(strcmp(cmd_completers[i-1].cmd, cmd_completers[i].cmd) < 0);
     }
+}
 
-    GHashTable *ac_funcs = g_hash_table_new(g_str_hash, g_str_equal);
-    g_hash_table_insert(ac_funcs, "/help",          _help_autocomplete);
-    g_hash_table_insert(ac_funcs, "/who",           _who_autocomplete);
-    g_hash_table_insert(ac_funcs, "/sub",           _sub_autocomplete);
-    g_hash_table_insert(ac_funcs, "/notify",        _notify_autocomplete);
-    g_hash_table_insert(ac_funcs, "/autoaway",      _autoaway_autocomplete);
-    g_hash_table_insert(ac_funcs, "/theme",         _theme_autocomplete);
-    g_hash_table_insert(ac_funcs, "/log",           _log_autocomplete);
-    g_hash_table_insert(ac_funcs, "/account",       _account_autocomplete);
-    g_hash_table_insert(ac_funcs, "/roster",        _roster_autocomplete);
-    g_hash_table_insert(ac_funcs, "/group",         _group_autocomplete);
-    g_hash_table_insert(ac_funcs, "/bookmark",      _bookmark_autocomplete);
-    g_hash_table_insert(ac_funcs, "/autoconnect",   _autoconnect_autocomplete);
-    g_hash_table_insert(ac_funcs, "/otr",           _otr_autocomplete);
-    g_hash_table_insert(ac_funcs, "/pgp",           _pgp_autocomplete);
-    g_hash_table_insert(ac_funcs, "/connect",       _connect_autocomplete);
-    g_hash_table_insert(ac_funcs, "/statuses",      _statuses_autocomplete);
-    g_hash_table_insert(ac_funcs, "/alias",         _alias_autocomplete);
-    g_hash_table_insert(ac_funcs, "/join",          _join_autocomplete);
-    g_hash_table_insert(ac_funcs, "/form",          _form_autocomplete);
-    g_hash_table_insert(ac_funcs, "/occupants",     _occupants_autocomplete);
-    g_hash_table_insert(ac_funcs, "/kick",          _kick_autocomplete);
-    g_hash_table_insert(ac_funcs, "/ban",           _ban_autocomplete);
-    g_hash_table_insert(ac_funcs, "/affiliation",   _affiliation_autocomplete);
-    g_hash_table_insert(ac_funcs, "/role",          _role_autocomplete);
-    g_hash_table_insert(ac_funcs, "/resource",      _resource_autocomplete);
-    g_hash_table_insert(ac_funcs, "/titlebar",      _titlebar_autocomplete);
-    g_hash_table_insert(ac_funcs, "/inpblock",      _inpblock_autocomplete);
-    g_hash_table_insert(ac_funcs, "/time",          _time_autocomplete);
-    g_hash_table_insert(ac_funcs, "/receipts",      _receipts_autocomplete);
-    g_hash_table_insert(ac_funcs, "/wins",          _wins_autocomplete);
-    g_hash_table_insert(ac_funcs, "/tls",           _tls_autocomplete);
-
-    int len = strlen(input);
+static int
+_cmd_completer_compare(const void *key, const void *elem)
+{
+    return strcmp(key, ((const CommandCompleter *)elem)->cmd);
+}
+
+static char *
+_cmd_complete_parameters(ProfWin *window, const char * const input)
+{
+    char *result = NULL;
+
+    // command word, completers are only needed once a space is typed
+    const char *space = strchr(input, ' ');
+    if (space == NULL) {
+        return NULL;
+    }
+    int len = space - input;
     char parsed[len+1];
-    i = 0;
-    while (i < len) {
-        if (input[i] == ' ') {
-            break;
+    memcpy(parsed, input, len);
+    parsed[len] = '\0';
+
+    const CommandCompleter *completer = bsearch(parsed, cmd_completers,
+        ARRAY_SIZE(cmd_completers), sizeof(CommandCompleter), _cmd_completer_compare);
+    if (completer) {
+        if (completer->func) {
+            result = completer->func(window, input);
+        } else if (completer->cmd_func) {
+            result = completer->cmd_func(window, completer->cmd, input);
         } else {
-            parsed[i] = input[i];
-        }
-        i++;
-    }
-    parsed[i] = '\0';
-
-    char * (*ac_func)(ProfWin*, const char * const) = g_hash_table_lookup(ac_funcs, parsed);
-    if (ac_func) {
-        result = ac_func(window, input);
-        if (result) {
-            g_hash_table_destroy(ac_funcs);
-            return result;
+            result = autocomplete_param_with_ac(input, completer->cmd, *completer->ac, TRUE);
         }
+        return result;
     }
-    g_hash_table_destroy(ac_funcs);
 
     if (g_str_has_prefix(input, "/field")) {
         result = _form_field_autocomplete(window, input);
@@ -2936,6 +2793,11 @@ _notify_autocomplete(ProfWin *window, const char * const input)
         return result;
     }
 
+    result = autocomplete_param_with_ac(input, "/notify room trigger", notify_room_trigger_ac, TRUE);
+    if (result) {
+        return result;
+    }
+
     result = autocomplete_param_with_ac(input, "/notify room", notify_room_ac, TRUE);
     if (result) {
         return result;
@@ -3736,6 +3598,11 @@ _join_autocomplete(ProfWin *window, const char * const input)
     char *found = NULL;
     gboolean result = FALSE;
 
+    found = autocomplete_param_with_func(input, "/join", muc_invites_find);
+    if (found) {
+        return found;
+    }
+
     found = autocomplete_param_with_func(input, "/join", bookmark_find);
     if (found) {
         return found;
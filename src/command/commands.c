@@ -846,6 +846,21 @@ cmd_wins(ProfWin *window, const char * const command, gchar **args)
         } else {
             cons_bad_cmd_usage(command);
         }
+    } else if (strcmp(args[0], "hibernate") == 0) {
+        if (g_strcmp0(args[1], "off") == 0) {
+            prefs_set_wins_hibernate(0);
+            cons_show("Window hibernation disabled.");
+        } else if (args[1] == NULL || atoi(args[1]) <= 0) {
+            cons_bad_cmd_usage(command);
+        } else {
+            int minutes = atoi(args[1]);
+            prefs_set_wins_hibernate(minutes);
+            if (minutes == 1) {
+                cons_show("Hibernating windows after 1 minute of inactivity.");
+            } else {
+                cons_show("Hibernating windows after %d minutes of inactivity.", minutes);
+            }
+        }
     } else {
         cons_bad_cmd_usage(command);
     }
@@ -1782,11 +1797,13 @@ cmd_roster(ProfWin *window, const char * const command, gchar **args)
 
         GSList *all = roster_get_contacts();
         GSList *curr = all;
+        jabber_cork();
         while (curr) {
             PContact contact = curr->data;
             roster_send_remove(p_contact_barejid(contact));
             curr = g_slist_next(curr);
         }
+        jabber_uncork();
 
         g_slist_free(all);
         return TRUE;
@@ -2850,10 +2867,12 @@ cmd_affiliation(ProfWin *window, const char * const command, gchar **args)
 
     if (g_strcmp0(cmd, "list") == 0) {
         if (!affiliation) {
+            jabber_cork();
             iq_room_affiliation_list(mucwin->roomjid, "owner");
             iq_room_affiliation_list(mucwin->roomjid, "admin");
             iq_room_affiliation_list(mucwin->roomjid, "member");
             iq_room_affiliation_list(mucwin->roomjid, "outcast");
+            jabber_uncork();
         } else if (g_strcmp0(affiliation, "none") == 0) {
             win_print((ProfWin*) mucwin, '!', 0, NULL, 0, 0, "", "Cannot list users with no affiliation.");
         } else {
@@ -2919,9 +2938,11 @@ cmd_role(ProfWin *window, const char * const command, gchar **args)
 
     if (g_strcmp0(cmd, "list") == 0) {
         if (!role) {
+            jabber_cork();
             iq_room_role_list(mucwin->roomjid, "moderator");
             iq_room_role_list(mucwin->roomjid, "participant");
             iq_room_role_list(mucwin->roomjid, "visitor");
+            jabber_uncork();
         } else if (g_strcmp0(role, "none") == 0) {
             win_print((ProfWin*) mucwin, '!', 0, NULL, 0, 0, "", "Cannot list users with no role.");
         } else {
@@ -3862,6 +3883,37 @@ cmd_notify(ProfWin *window, const char * const command, gchar **args)
             } else {
                 cons_show("Usage: /notify room text on|off");
             }
+        } else if (strcmp(args[1], "trigger") == 0) {
+            if (g_strcmp0(args[2], "add") == 0 && args[3]) {
+                if (prefs_add_room_notify_trigger(args[3])) {
+                    muc_load_mention_triggers();
+                    cons_show("Added room notification trigger: %s", args[3]);
+                } else {
+                    cons_show("Room notification trigger already exists: %s", args[3]);
+                }
+            } else if (g_strcmp0(args[2], "remove") == 0 && args[3]) {
+                if (prefs_remove_room_notify_trigger(args[3])) {
+                    muc_load_mention_triggers();
+                    cons_show("Removed room notification trigger: %s", args[3]);
+                } else {
+                    cons_show("Room notification trigger does not exist: %s", args[3]);
+                }
+            } else if (g_strcmp0(args[2], "list") == 0) {
+                GList *triggers = prefs_get_room_notify_triggers();
+                if (triggers == NULL) {
+                    cons_show("No room notification triggers");
+                } else {
+                    cons_show("Room notification triggers:");
+                    GList *curr = triggers;
+                    while (curr) {
+                        cons_show("  %s", curr->data);
+                        curr = g_list_next(curr);
+                    }
+                }
+                g_list_free_full(triggers, free);
+            } else {
+                cons_bad_cmd_usage(command);
+            }
         } else {
             cons_show("Usage: /notify room on|off|mention");
         }
@@ -4057,6 +4109,20 @@ cmd_reconnect(ProfWin *window, const char * const command, gchar **args)
     return TRUE;
 }
 
+gboolean
+cmd_sm(ProfWin *window, const char * const command, gchar **args)
+{
+    gboolean result = _cmd_set_boolean_preference(args[0], command, "Stream management preference", PREF_SM);
+
+    // cannot be turned off mid stream, takes effect on the next connection
+    jabber_conn_status_t conn_status = jabber_get_connection_status();
+    if (conn_status == JABBER_CONNECTED && (g_strcmp0(args[0], "on") == 0)) {
+        sm_enable();
+    }
+
+    return result;
+}
+
 gboolean
 cmd_autoping(ProfWin *window, const char * const command, gchar **args)
 {
@@ -4317,6 +4383,15 @@ cmd_flash(ProfWin *window, const char * const command, gchar **args)
     return _cmd_set_boolean_preference(args[0], command, "Screen flash", PREF_FLASH);
 }
 
+gboolean
+cmd_fuzzy(ProfWin *window, const char * const command, gchar **args)
+{
+    gboolean result = _cmd_set_boolean_preference(args[0], command, "Fuzzy completion", PREF_FUZZY);
+    autocomplete_fuzzy_enable(prefs_get_boolean(PREF_FUZZY));
+
+    return result;
+}
+
 gboolean
 cmd_intype(ProfWin *window, const char * const command, gchar **args)
 {
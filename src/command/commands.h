@@ -89,6 +89,7 @@ gboolean cmd_lastactivity(ProfWin *window, const char * const command, gchar **a
 gboolean cmd_disconnect(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_dnd(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_flash(ProfWin *window, const char * const command, gchar **args);
+gboolean cmd_fuzzy(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_gone(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_grlog(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_group(ProfWin *window, const char * const command, gchar **args);
@@ -114,6 +115,7 @@ gboolean cmd_prefs(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_priority(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_quit(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_reconnect(ProfWin *window, const char * const command, gchar **args);
+gboolean cmd_sm(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_room(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_rooms(ProfWin *window, const char * const command, gchar **args);
 gboolean cmd_bookmark(ProfWin *window, const char * const command, gchar **args);
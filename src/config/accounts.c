@@ -42,6 +42,7 @@
 
 #include "common.h"
 #include "config/account.h"
+#include "config/persist.h"
 #include "jid.h"
 #include "log.h"
 #include "tools/autocomplete.h"
@@ -54,6 +55,7 @@ static Autocomplete all_ac;
 static Autocomplete enabled_ac;
 
 static void _save_accounts(void);
+static void _write_accounts(void);
 static gchar * _get_accounts_file(void);
 static void _remove_from_list(GKeyFile *accounts, const char * const account_name, const char * const key, const char * const contact_jid);
 
@@ -90,6 +92,7 @@ accounts_load(void)
 void
 accounts_close(void)
 {
+    persist_flush(_write_accounts);
     autocomplete_free(all_ac);
     autocomplete_free(enabled_ac);
     g_key_file_free(accounts);
@@ -869,17 +872,19 @@ accounts_get_login_presence(const char * const account_name)
 static void
 _save_accounts(void)
 {
-    gsize g_data_size;
-    gchar *g_accounts_data = g_key_file_to_data(accounts, &g_data_size, NULL);
+    persist_schedule(_write_accounts);
+}
+
+static void
+_write_accounts(void)
+{
     gchar *xdg_data = xdg_get_data_home();
     GString *base_str = g_string_new(xdg_data);
     g_string_append(base_str, "/profanity/");
     gchar *true_loc = get_file_or_linked(accounts_loc, base_str->str);
-    g_file_set_contents(true_loc, g_accounts_data, g_data_size, NULL);
-    g_chmod(accounts_loc, S_IRUSR | S_IWUSR);
+    persist_write_keyfile(accounts, true_loc);
     g_free(xdg_data);
     free(true_loc);
-    g_free(g_accounts_data);
     g_string_free(base_str, TRUE);
 }
 
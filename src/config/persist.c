@@ -0,0 +1,146 @@
+/*
+ * persist.c
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "log.h"
+#include "config/persist.h"
+
+typedef struct pending_write_t {
+    persist_write_func write_func;
+    gint64 due;
+} PendingWrite;
+
+static GSList *pending = NULL;
+
+static GSList * _find_pending(persist_write_func write_func);
+static void _write_pending(GSList *link);
+
+void
+persist_schedule(persist_write_func write_func)
+{
+    if (_find_pending(write_func)) {
+        return;
+    }
+
+    PendingWrite *write = g_malloc(sizeof(PendingWrite));
+    write->write_func = write_func;
+    write->due = g_get_monotonic_time() + (PERSIST_INTERVAL * G_USEC_PER_SEC);
+    pending = g_slist_append(pending, write);
+}
+
+void
+persist_write_due(void)
+{
+    if (pending == NULL) {
+        return;
+    }
+
+    gint64 now = g_get_monotonic_time();
+    GSList *curr = pending;
+    while (curr) {
+        GSList *next = g_slist_next(curr);
+        PendingWrite *write = curr->data;
+        if (write->due <= now) {
+            _write_pending(curr);
+        }
+        curr = next;
+    }
+}
+
+void
+persist_flush(persist_write_func write_func)
+{
+    GSList *found = _find_pending(write_func);
+    if (found) {
+        _write_pending(found);
+    }
+}
+
+void
+persist_flush_all(void)
+{
+    while (pending) {
+        _write_pending(pending);
+    }
+}
+
+gboolean
+persist_write_keyfile(GKeyFile *keyfile, const char * const loc)
+{
+    gsize data_size;
+    gchar *data = g_key_file_to_data(keyfile, &data_size, NULL);
+
+    // g_file_set_contents writes to a temporary file and renames it over loc,
+    // so readers never see a partially written file
+    GError *err = NULL;
+    gboolean result = g_file_set_contents(loc, data, data_size, &err);
+    if (result) {
+        g_chmod(loc, S_IRUSR | S_IWUSR);
+    } else {
+        log_error("Error writing %s: %s", loc, err->message);
+        g_error_free(err);
+    }
+    g_free(data);
+
+    return result;
+}
+
+static GSList *
+_find_pending(persist_write_func write_func)
+{
+    GSList *curr = pending;
+    while (curr) {
+        PendingWrite *write = curr->data;
+        if (write->write_func == write_func) {
+            return curr;
+        }
+        curr = g_slist_next(curr);
+    }
+
+    return NULL;
+}
+
+static void
+_write_pending(GSList *link)
+{
+    PendingWrite *write = link->data;
+    pending = g_slist_delete_link(pending, link);
+
+    write->write_func();
+    g_free(write);
+}
@@ -0,0 +1,60 @@
+/*
+ * persist.h
+ *
+ * Copyright (C) 2012 - 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <glib.h>
+
+// seconds a file may stay dirty before its pending changes are written
+#define PERSIST_INTERVAL 5
+
+typedef void(*persist_write_func)(void);
+
+// mark a file as dirty, write_func will be called at most once per interval
+void persist_schedule(persist_write_func write_func);
+
+// write all files whose interval has elapsed, called from the main loop
+void persist_write_due(void);
+
+// write a file immediately if it has pending changes
+void persist_flush(persist_write_func write_func);
+
+// write every file with pending changes, used on shutdown
+void persist_flush_all(void);
+
+// write contents to loc via a temporary file and rename
+gboolean persist_write_keyfile(GKeyFile *keyfile, const char * const loc);
+
+#endif
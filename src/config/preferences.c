@@ -44,6 +44,7 @@
 #include "common.h"
 #include "log.h"
 #include "preferences.h"
+#include "config/persist.h"
 #include "tools/autocomplete.h"
 
 // preference groups refer to the sections in .profrc, for example [ui]
@@ -65,7 +66,32 @@ gint log_maxsize = 0;
 
 static Autocomplete boolean_choice_ac;
 
+// decoded copy of every preference, refreshed by prefs_load and the setters
+// so the getters never need to consult the key file
+static struct prefs_snapshot_t {
+    gboolean booleans[PREF_COUNT];
+    char *strings[PREF_COUNT];
+    gint gone;
+    gint notify_remind;
+    gint inpblock;
+    gint priority;
+    gint reconnect;
+    gint autoping;
+    gint autoaway_time;
+    gint autoxa_time;
+    gint occupants_size;
+    gint roster_size;
+    gint wins_hibernate;
+    char otr_char;
+    char pgp_char;
+} snapshot;
+
 static void _save_prefs(void);
+static void _write_prefs(void);
+static void _snapshot_pref(preference_t pref);
+static void _snapshot_integers(void);
+static void _snapshot_load(void);
+static void _snapshot_clear(void);
 static gchar * _get_preferences_file(void);
 static const char * _get_group(preference_t pref);
 static const char * _get_key(preference_t pref);
@@ -128,6 +154,7 @@ prefs_load(void)
     }
 
     _save_prefs();
+    _snapshot_load();
 
     boolean_choice_ac = autocomplete_new();
     autocomplete_add(boolean_choice_ac, "on");
@@ -137,7 +164,9 @@ prefs_load(void)
 void
 prefs_close(void)
 {
+    persist_flush(_write_prefs);
     autocomplete_free(boolean_choice_ac);
+    _snapshot_clear();
     g_key_file_free(prefs);
     prefs = NULL;
 }
@@ -157,15 +186,7 @@ prefs_reset_boolean_choice(void)
 gboolean
 prefs_get_boolean(preference_t pref)
 {
-    const char *group = _get_group(pref);
-    const char *key = _get_key(pref);
-    gboolean def = _get_default_boolean(pref);
-
-    if (!g_key_file_has_key(prefs, group, key, NULL)) {
-        return def;
-    }
-
-    return g_key_file_get_boolean(prefs, group, key, NULL);
+    return snapshot.booleans[pref];
 }
 
 void
@@ -174,27 +195,22 @@ prefs_set_boolean(preference_t pref, gboolean value)
     const char *group = _get_group(pref);
     const char *key = _get_key(pref);
     g_key_file_set_boolean(prefs, group, key, value);
+    _snapshot_pref(pref);
     _save_prefs();
 }
 
 char *
 prefs_get_string(preference_t pref)
 {
-    const char *group = _get_group(pref);
-    const char *key = _get_key(pref);
-    char *def = _get_default_string(pref);
-
-    char *result = g_key_file_get_string(prefs, group, key, NULL);
+    return g_strdup(snapshot.strings[pref]);
+}
 
-    if (result == NULL) {
-        if (def) {
-            return g_strdup(def);
-        } else {
-            return NULL;
-        }
-    } else {
-        return result;
-    }
+// returns the current value without copying it, the result is owned by the
+// preferences module and is only valid until the preference is next set
+const char *
+prefs_get_string_const(preference_t pref)
+{
+    return snapshot.strings[pref];
 }
 
 void
@@ -217,32 +233,35 @@ prefs_set_string(preference_t pref, char *value)
     } else {
         g_key_file_set_string(prefs, group, key, value);
     }
+    _snapshot_pref(pref);
     _save_prefs();
 }
 
 gint
 prefs_get_gone(void)
 {
-    return g_key_file_get_integer(prefs, PREF_GROUP_CHATSTATES, "gone", NULL);
+    return snapshot.gone;
 }
 
 void
 prefs_set_gone(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_CHATSTATES, "gone", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
 gint
 prefs_get_notify_remind(void)
 {
-    return g_key_file_get_integer(prefs, PREF_GROUP_NOTIFICATIONS, "remind", NULL);
+    return snapshot.notify_remind;
 }
 
 void
 prefs_set_notify_remind(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_NOTIFICATIONS, "remind", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
@@ -265,82 +284,67 @@ prefs_set_max_log_size(gint value)
 
 gint prefs_get_inpblock(void)
 {
-    int val = g_key_file_get_integer(prefs, PREF_GROUP_UI, "inpblock", NULL);
-    if (val == 0) {
-        return INPBLOCK_DEFAULT;
-    } else {
-        return val;
-    }
+    return snapshot.inpblock;
 }
 
 void prefs_set_inpblock(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_UI, "inpblock", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
 gint
 prefs_get_priority(void)
 {
-    return g_key_file_get_integer(prefs, PREF_GROUP_PRESENCE, "priority", NULL);
+    return snapshot.priority;
 }
 
 gint
 prefs_get_reconnect(void)
 {
-    if (!g_key_file_has_key(prefs, PREF_GROUP_CONNECTION, "reconnect", NULL)) {
-        return 30;
-    } else {
-        return g_key_file_get_integer(prefs, PREF_GROUP_CONNECTION, "reconnect", NULL);
-    }
+    return snapshot.reconnect;
 }
 
 void
 prefs_set_reconnect(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_CONNECTION, "reconnect", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
 gint
 prefs_get_autoping(void)
 {
-    if (!g_key_file_has_key(prefs, PREF_GROUP_CONNECTION, "autoping", NULL)) {
-        return 60;
-    } else {
-        return g_key_file_get_integer(prefs, PREF_GROUP_CONNECTION, "autoping", NULL);
-    }
+    return snapshot.autoping;
 }
 
 void
 prefs_set_autoping(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_CONNECTION, "autoping", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
 gint
 prefs_get_autoaway_time(void)
 {
-    gint result = g_key_file_get_integer(prefs, PREF_GROUP_PRESENCE, "autoaway.awaytime", NULL);
-
-    if (result == 0) {
-        return 15;
-    } else {
-        return result;
-    }
+    return snapshot.autoaway_time;
 }
 
 gint
 prefs_get_autoxa_time(void)
 {
-    return g_key_file_get_integer(prefs, PREF_GROUP_PRESENCE, "autoaway.xatime", NULL);
+    return snapshot.autoxa_time;
 }
 
 void
 prefs_set_autoaway_time(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_PRESENCE, "autoaway.awaytime", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
@@ -348,6 +352,7 @@ void
 prefs_set_autoxa_time(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_PRESENCE, "autoaway.xatime", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
@@ -355,54 +360,48 @@ void
 prefs_set_occupants_size(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_UI, "occupants.size", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
 gint
 prefs_get_occupants_size(void)
 {
-    gint result = g_key_file_get_integer(prefs, PREF_GROUP_UI, "occupants.size", NULL);
-
-    if (result > 99 || result < 1) {
-        return 15;
-    } else {
-        return result;
-    }
+    return snapshot.occupants_size;
 }
 
 void
 prefs_set_roster_size(gint value)
 {
     g_key_file_set_integer(prefs, PREF_GROUP_UI, "roster.size", value);
+    _snapshot_integers();
     _save_prefs();
 }
 
 gint
 prefs_get_roster_size(void)
 {
-    gint result = g_key_file_get_integer(prefs, PREF_GROUP_UI, "roster.size", NULL);
+    return snapshot.roster_size;
+}
 
-    if (result > 99 || result < 1) {
-        return 25;
-    } else {
-        return result;
-    }
+void
+prefs_set_wins_hibernate(gint value)
+{
+    g_key_file_set_integer(prefs, PREF_GROUP_UI, "wins.hibernate", value);
+    _snapshot_integers();
+    _save_prefs();
+}
+
+gint
+prefs_get_wins_hibernate(void)
+{
+    return snapshot.wins_hibernate;
 }
 
 char
 prefs_get_otr_char(void)
 {
-    char result = '~';
-
-    char *resultstr = g_key_file_get_string(prefs, PREF_GROUP_OTR, "otr.char", NULL);
-    if (!resultstr) {
-        result =  '~';
-    } else {
-        result = resultstr[0];
-    }
-    free(resultstr);
-
-    return result;
+    return snapshot.otr_char;
 }
 
 void
@@ -413,23 +412,14 @@ prefs_set_otr_char(char ch)
     str[1] = '\0';
 
     g_key_file_set_string(prefs, PREF_GROUP_OTR, "otr.char", str);
+    _snapshot_integers();
     _save_prefs();
 }
 
 char
 prefs_get_pgp_char(void)
 {
-    char result = '~';
-
-    char *resultstr = g_key_file_get_string(prefs, PREF_GROUP_PGP, "pgp.char", NULL);
-    if (!resultstr) {
-        result =  '~';
-    } else {
-        result = resultstr[0];
-    }
-    free(resultstr);
-
-    return result;
+    return snapshot.pgp_char;
 }
 
 void
@@ -440,6 +430,7 @@ prefs_set_pgp_char(char ch)
     str[1] = '\0';
 
     g_key_file_set_string(prefs, PREF_GROUP_PGP, "pgp.char", str);
+    _snapshot_integers();
     _save_prefs();
 }
 
@@ -528,23 +519,203 @@ prefs_free_aliases(GList *aliases)
     g_list_free_full(aliases, (GDestroyNotify)_free_alias);
 }
 
+gboolean
+prefs_add_room_notify_trigger(const char * const text)
+{
+    gsize len = 0;
+    gchar **triggers = g_key_file_get_string_list(prefs, PREF_GROUP_NOTIFICATIONS, "room.trigger.list", &len, NULL);
+    gsize i;
+    for (i = 0; i < len; i++) {
+        if (g_strcmp0(triggers[i], text) == 0) {
+            g_strfreev(triggers);
+            return FALSE;
+        }
+    }
+
+    triggers = g_realloc(triggers, (len + 2) * sizeof(gchar *));
+    triggers[len] = g_strdup(text);
+    triggers[len + 1] = NULL;
+    g_key_file_set_string_list(prefs, PREF_GROUP_NOTIFICATIONS, "room.trigger.list",
+        (const gchar * const *)triggers, len + 1);
+    g_strfreev(triggers);
+    _save_prefs();
+
+    return TRUE;
+}
+
+gboolean
+prefs_remove_room_notify_trigger(const char * const text)
+{
+    gsize len = 0;
+    gchar **triggers = g_key_file_get_string_list(prefs, PREF_GROUP_NOTIFICATIONS, "room.trigger.list", &len, NULL);
+    gboolean removed = FALSE;
+    gsize kept = 0;
+    gsize i;
+    for (i = 0; i < len; i++) {
+        if (g_strcmp0(triggers[i], text) == 0) {
+            g_free(triggers[i]);
+            removed = TRUE;
+        } else {
+            triggers[kept++] = triggers[i];
+        }
+    }
+
+    if (removed) {
+        triggers[kept] = NULL;
+        if (kept == 0) {
+            g_key_file_remove_key(prefs, PREF_GROUP_NOTIFICATIONS, "room.trigger.list", NULL);
+        } else {
+            g_key_file_set_string_list(prefs, PREF_GROUP_NOTIFICATIONS, "room.trigger.list",
+                (const gchar * const *)triggers, kept);
+        }
+        _save_prefs();
+    }
+    g_strfreev(triggers);
+
+    return removed;
+}
+
+GList *
+prefs_get_room_notify_triggers(void)
+{
+    GList *result = NULL;
+    gsize len = 0;
+    gchar **triggers = g_key_file_get_string_list(prefs, PREF_GROUP_NOTIFICATIONS, "room.trigger.list", &len, NULL);
+    gsize i;
+    for (i = 0; i < len; i++) {
+        result = g_list_append(result, strdup(triggers[i]));
+    }
+    g_strfreev(triggers);
+
+    return result;
+}
+
 static void
 _save_prefs(void)
 {
-    gsize g_data_size;
-    gchar *g_prefs_data = g_key_file_to_data(prefs, &g_data_size, NULL);
+    persist_schedule(_write_prefs);
+}
+
+static void
+_write_prefs(void)
+{
     gchar *xdg_config = xdg_get_config_home();
     GString *base_str = g_string_new(xdg_config);
     g_string_append(base_str, "/profanity/");
     gchar *true_loc = get_file_or_linked(prefs_loc, base_str->str);
-    g_file_set_contents(true_loc, g_prefs_data, g_data_size, NULL);
-    g_chmod(prefs_loc, S_IRUSR | S_IWUSR);
+    persist_write_keyfile(prefs, true_loc);
     g_free(xdg_config);
     free(true_loc);
-    g_free(g_prefs_data);
     g_string_free(base_str, TRUE);
 }
 
+static void
+_snapshot_pref(preference_t pref)
+{
+    const char *group = _get_group(pref);
+    const char *key = _get_key(pref);
+
+    // integer preferences such as PREF_ROSTER_SIZE have no generic key
+    if (group == NULL || key == NULL) {
+        return;
+    }
+
+    if (g_key_file_has_key(prefs, group, key, NULL)) {
+        snapshot.booleans[pref] = g_key_file_get_boolean(prefs, group, key, NULL);
+    } else {
+        snapshot.booleans[pref] = _get_default_boolean(pref);
+    }
+
+    g_free(snapshot.strings[pref]);
+    snapshot.strings[pref] = g_key_file_get_string(prefs, group, key, NULL);
+    if (snapshot.strings[pref] == NULL) {
+        snapshot.strings[pref] = g_strdup(_get_default_string(pref));
+    }
+}
+
+static char
+_snapshot_char(const char * const group, const char * const key)
+{
+    char result = '~';
+
+    char *resultstr = g_key_file_get_string(prefs, group, key, NULL);
+    if (resultstr) {
+        result = resultstr[0];
+    }
+    g_free(resultstr);
+
+    return result;
+}
+
+static void
+_snapshot_integers(void)
+{
+    snapshot.gone = g_key_file_get_integer(prefs, PREF_GROUP_CHATSTATES, "gone", NULL);
+    snapshot.notify_remind = g_key_file_get_integer(prefs, PREF_GROUP_NOTIFICATIONS, "remind", NULL);
+    snapshot.priority = g_key_file_get_integer(prefs, PREF_GROUP_PRESENCE, "priority", NULL);
+    snapshot.autoxa_time = g_key_file_get_integer(prefs, PREF_GROUP_PRESENCE, "autoaway.xatime", NULL);
+
+    snapshot.inpblock = g_key_file_get_integer(prefs, PREF_GROUP_UI, "inpblock", NULL);
+    if (snapshot.inpblock == 0) {
+        snapshot.inpblock = INPBLOCK_DEFAULT;
+    }
+
+    if (!g_key_file_has_key(prefs, PREF_GROUP_CONNECTION, "reconnect", NULL)) {
+        snapshot.reconnect = 30;
+    } else {
+        snapshot.reconnect = g_key_file_get_integer(prefs, PREF_GROUP_CONNECTION, "reconnect", NULL);
+    }
+
+    if (!g_key_file_has_key(prefs, PREF_GROUP_CONNECTION, "autoping", NULL)) {
+        snapshot.autoping = 60;
+    } else {
+        snapshot.autoping = g_key_file_get_integer(prefs, PREF_GROUP_CONNECTION, "autoping", NULL);
+    }
+
+    snapshot.autoaway_time = g_key_file_get_integer(prefs, PREF_GROUP_PRESENCE, "autoaway.awaytime", NULL);
+    if (snapshot.autoaway_time == 0) {
+        snapshot.autoaway_time = 15;
+    }
+
+    snapshot.occupants_size = g_key_file_get_integer(prefs, PREF_GROUP_UI, "occupants.size", NULL);
+    if (snapshot.occupants_size > 99 || snapshot.occupants_size < 1) {
+        snapshot.occupants_size = 15;
+    }
+
+    snapshot.roster_size = g_key_file_get_integer(prefs, PREF_GROUP_UI, "roster.size", NULL);
+    if (snapshot.roster_size > 99 || snapshot.roster_size < 1) {
+        snapshot.roster_size = 25;
+    }
+
+    snapshot.wins_hibernate = g_key_file_get_integer(prefs, PREF_GROUP_UI, "wins.hibernate", NULL);
+    if (snapshot.wins_hibernate < 0) {
+        snapshot.wins_hibernate = 0;
+    }
+
+    snapshot.otr_char = _snapshot_char(PREF_GROUP_OTR, "otr.char");
+    snapshot.pgp_char = _snapshot_char(PREF_GROUP_PGP, "pgp.char");
+}
+
+static void
+_snapshot_load(void)
+{
+    preference_t pref;
+    for (pref = 0; pref < PREF_COUNT; pref++) {
+        _snapshot_pref(pref);
+    }
+    _snapshot_integers();
+}
+
+static void
+_snapshot_clear(void)
+{
+    preference_t pref;
+    for (pref = 0; pref < PREF_COUNT; pref++) {
+        g_free(snapshot.strings[pref]);
+    }
+    memset(&snapshot, 0, sizeof(snapshot));
+}
+
 static gchar *
 _get_preferences_file(void)
 {
@@ -602,6 +773,7 @@ _get_group(preference_t pref)
         case PREF_RESOURCE_MESSAGE:
         case PREF_ENC_WARN:
         case PREF_INPBLOCK_DYNAMIC:
+        case PREF_FUZZY:
             return PREF_GROUP_UI;
         case PREF_STATES:
         case PREF_OUTTYPE:
@@ -633,6 +805,7 @@ _get_group(preference_t pref)
         case PREF_RECEIPTS_SEND:
         case PREF_RECEIPTS_REQUEST:
         case PREF_CERT_PATH:
+        case PREF_SM:
             return PREF_GROUP_CONNECTION;
         case PREF_OTR_LOG:
         case PREF_OTR_POLICY:
@@ -777,10 +950,14 @@ _get_key(preference_t pref)
             return "inpblock.dynamic";
         case PREF_ENC_WARN:
             return "enc.warn";
+        case PREF_FUZZY:
+            return "fuzzy";
         case PREF_PGP_LOG:
             return "log";
         case PREF_CERT_PATH:
             return "certpath";
+        case PREF_SM:
+            return "sm";
         default:
             return NULL;
     }
@@ -110,8 +110,11 @@ typedef enum {
     PREF_RESOURCE_MESSAGE,
     PREF_INPBLOCK_DYNAMIC,
     PREF_ENC_WARN,
+    PREF_FUZZY,
     PREF_PGP_LOG,
     PREF_CERT_PATH,
+    PREF_SM,
+    PREF_COUNT
 } preference_t;
 
 typedef struct prof_alias_t {
@@ -147,6 +150,8 @@ void prefs_set_occupants_size(gint value);
 gint prefs_get_occupants_size(void);
 void prefs_set_roster_size(gint value);
 gint prefs_get_roster_size(void);
+void prefs_set_wins_hibernate(gint value);
+gint prefs_get_wins_hibernate(void);
 
 gint prefs_get_autoaway_time(void);
 void prefs_set_autoaway_time(gint value);
@@ -166,9 +171,14 @@ char* prefs_get_alias(const char * const name);
 GList* prefs_get_aliases(void);
 void prefs_free_aliases(GList *aliases);
 
+gboolean prefs_add_room_notify_trigger(const char * const text);
+gboolean prefs_remove_room_notify_trigger(const char * const text);
+GList* prefs_get_room_notify_triggers(void);
+
 gboolean prefs_get_boolean(preference_t pref);
 void prefs_set_boolean(preference_t pref, gboolean value);
 char * prefs_get_string(preference_t pref);
+const char * prefs_get_string_const(preference_t pref);
 void prefs_free_string(char *pref);
 void prefs_set_string(preference_t pref, char *value);
 
@@ -54,6 +54,7 @@ struct p_contact_t {
     gboolean pending_out;
     GDateTime *last_activity;
     GHashTable *available_resources;
+    GList *ordered_resources;
     Autocomplete resource_ac;
 };
 
@@ -91,6 +92,7 @@ p_contact_new(const char * const barejid, const char * const name,
 
     contact->available_resources = g_hash_table_new_full(g_str_hash, g_str_equal, free,
         (GDestroyNotify)resource_destroy);
+    contact->ordered_resources = NULL;
 
     contact->resource_ac = autocomplete_new();
 
@@ -142,6 +144,11 @@ p_contact_groups(const PContact contact)
 gboolean
 p_contact_remove_resource(PContact contact, const char * const resource)
 {
+    Resource *current = g_hash_table_lookup(contact->available_resources, resource);
+    if (current) {
+        contact->ordered_resources = g_list_remove(contact->ordered_resources, current);
+    }
+
     gboolean result = g_hash_table_remove(contact->available_resources, resource);
     autocomplete_remove(contact->resource_ac, resource);
 
@@ -167,6 +174,7 @@ p_contact_free(PContact contact)
             g_date_time_unref(contact->last_activity);
         }
 
+        g_list_free(contact->ordered_resources);
         g_hash_table_destroy(contact->available_resources);
         autocomplete_free(contact->resource_ac);
         free(contact);
@@ -230,61 +238,10 @@ p_contact_create_display_string(const PContact contact, const char * const resou
 }
 
 static Resource *
-_highest_presence(Resource *first, Resource *second)
-{
-    if (first->presence == RESOURCE_CHAT) {
-        return first;
-    } else if (second->presence == RESOURCE_CHAT) {
-        return second;
-    } else if (first->presence == RESOURCE_ONLINE) {
-        return first;
-    } else if (second->presence == RESOURCE_ONLINE) {
-        return second;
-    } else if (first->presence == RESOURCE_AWAY) {
-        return first;
-    } else if (second->presence == RESOURCE_AWAY) {
-        return second;
-    } else if (first->presence == RESOURCE_XA) {
-        return first;
-    } else if (second->presence == RESOURCE_XA) {
-        return second;
-    } else {
-        return first;
-    }
-}
-
-Resource *
 _get_most_available_resource(PContact contact)
 {
-    // find resource with highest priority, if more than one,
-    // use highest availability, in the following order:
-    //      chat
-    //      online
-    //      away
-    //      xa
-    //      dnd
-    GList *resources = g_hash_table_get_values(contact->available_resources);
-    GList *curr = resources;
-    Resource *current = curr->data;
-    Resource *highest = current;
-    curr = g_list_next(curr);
-    while (curr) {
-        current = curr->data;
-
-        // priority is same as current highest, choose presence
-        if (current->priority == highest->priority) {
-            highest = _highest_presence(highest, current);
-
-        // priority higher than current highest, set new presence
-        } else if (current->priority > highest->priority) {
-            highest = current;
-        }
-
-        curr = g_list_next(curr);
-    }
-    g_list_free(resources);
-
-    return highest;
+    // resources are kept ordered by priority, then availability
+    return contact->ordered_resources->data;
 }
 
 const char *
@@ -359,19 +316,8 @@ GList *
 p_contact_get_available_resources(const PContact contact)
 {
     assert(contact != NULL);
-    GList *resources = g_hash_table_get_values(contact->available_resources);
-    GList *ordered = NULL;
-
-    GList *curr_resource = resources;
-    while (curr_resource) {
-        Resource *resource = curr_resource->data;
-        ordered = g_list_insert_sorted(ordered, resource, (GCompareFunc)resource_compare_availability);
-        curr_resource = g_list_next(curr_resource);
-    }
 
-    g_list_free(resources);
-
-    return ordered;
+    return g_list_copy(contact->ordered_resources);
 }
 
 gboolean
@@ -398,11 +344,28 @@ p_contact_has_available_resource(const PContact contact)
     return (g_hash_table_size(contact->available_resources) > 0);
 }
 
-void
+Resource *
 p_contact_set_presence(const PContact contact, Resource *resource)
 {
-    g_hash_table_replace(contact->available_resources, strdup(resource->name), resource);
+    Resource *current = g_hash_table_lookup(contact->available_resources, resource->name);
+
+    // known resource, update the held record and only reorder when availability changed
+    if (current) {
+        if (resource_update(current, resource->presence, resource->status, resource->priority)) {
+            contact->ordered_resources = g_list_remove(contact->ordered_resources, current);
+            contact->ordered_resources = g_list_insert_sorted(contact->ordered_resources, current,
+                (GCompareFunc)resource_compare_availability);
+        }
+        resource_destroy(resource);
+        return current;
+    }
+
+    contact->ordered_resources = g_list_insert_sorted(contact->ordered_resources, resource,
+        (GCompareFunc)resource_compare_availability);
+    g_hash_table_insert(contact->available_resources, strdup(resource->name), resource);
     autocomplete_add(contact->resource_ac, resource->name);
+
+    return resource;
 }
 
 void
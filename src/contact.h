@@ -57,7 +57,7 @@ const char* p_contact_subscription(const PContact contact);
 GList * p_contact_get_available_resources(const PContact contact);
 GDateTime* p_contact_last_activity(const PContact contact);
 gboolean p_contact_pending_out(const PContact contact);
-void p_contact_set_presence(const PContact contact, Resource *resource);
+Resource * p_contact_set_presence(const PContact contact, Resource *resource);
 void p_contact_set_status(const PContact contact, const char * const status);
 void p_contact_set_name(const PContact contact, const char * const name);
 void p_contact_set_subscription(const PContact contact, const char * const subscription);
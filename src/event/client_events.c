@@ -37,6 +37,7 @@
 
 #include "config.h"
 #include "log.h"
+#include "roster_list.h"
 #include "ui/ui.h"
 #include "window_list.h"
 #include "xmpp/xmpp.h"
@@ -87,6 +88,7 @@ void
 cl_ev_send_msg(ProfChatWin *chatwin, const char * const msg)
 {
     chat_state_active(chatwin->state);
+    roster_touch(chatwin->barejid);
 
 // OTR suported, PGP supported
 #ifdef HAVE_LIBOTR
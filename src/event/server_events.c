@@ -72,6 +72,7 @@ sv_ev_login_account_success(char *account_name)
     ui_handle_login_account_success(account);
 
     // attempt to rejoin rooms with passwords
+    jabber_cork();
     GList *curr = muc_rooms();
     while (curr) {
         char *password = muc_password(curr->data);
@@ -81,6 +82,7 @@ sv_ev_login_account_success(char *account_name)
         }
         curr = g_list_next(curr);
     }
+    jabber_uncork();
     g_list_free(curr);
 
     log_info("%s logged in successfully", account->jid);
@@ -150,6 +152,7 @@ void
 sv_ev_room_history(const char * const room_jid, const char * const nick,
     GDateTime *timestamp, const char * const message)
 {
+    muc_set_last_seen(room_jid, timestamp);
     ui_room_history(room_jid, nick, timestamp, message);
 }
 
@@ -157,6 +160,15 @@ void
 sv_ev_room_message(const char * const room_jid, const char * const nick,
     const char * const message)
 {
+    muc_roster_touch(room_jid, nick);
+
+    // live messages carry no server stamp, allow for clock skew so a rejoin
+    // repeats a few messages rather than losing any
+    GDateTime *now = g_date_time_new_now_utc();
+    GDateTime *seen = g_date_time_add_seconds(now, -MUC_LAST_SEEN_SKEW);
+    muc_set_last_seen(room_jid, seen);
+    g_date_time_unref(seen);
+    g_date_time_unref(now);
     ui_room_message(room_jid, nick, message);
 
     if (prefs_get_boolean(PREF_GRLOG)) {
@@ -181,6 +193,8 @@ sv_ev_outgoing_carbon(char *barejid, char *message)
 void
 sv_ev_incoming_carbon(char *barejid, char *resource, char *message)
 {
+    roster_touch(barejid);
+
     gboolean new_win = FALSE;
     ProfChatWin *chatwin = wins_get_chat(barejid);
     if (!chatwin) {
@@ -244,6 +258,8 @@ _sv_ev_incoming_plain(ProfChatWin *chatwin, gboolean new_win, char *barejid, cha
 void
 sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_message, GDateTime *timestamp)
 {
+    roster_touch(barejid);
+
     gboolean new_win = FALSE;
     ProfChatWin *chatwin = wins_get_chat(barejid);
     if (!chatwin) {
@@ -396,10 +412,10 @@ sv_ev_contact_offline(char *barejid, char *resource, char *status)
 void
 sv_ev_contact_online(char *barejid, Resource *resource, GDateTime *last_activity, char *pgpsig)
 {
-    gboolean updated = roster_update_presence(barejid, resource, last_activity);
+    Resource *current = roster_update_presence(barejid, resource, last_activity);
 
-    if (updated) {
-        ui_contact_online(barejid, resource, last_activity);
+    if (current) {
+        ui_contact_online(barejid, current, last_activity);
     }
 
 #ifdef HAVE_LIBGPGME
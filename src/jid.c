@@ -32,6 +32,7 @@
  *
  */
 
+#include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -41,16 +42,118 @@
 
 #include "common.h"
 
+// live jids by their string, plus the most recently released ones
+static GHashTable *interned = NULL;
+static GQueue released = G_QUEUE_INIT;
+
+#define JID_RELEASED_MAX 512
+
+static Jid* _jid_parse(const gchar * const str);
+static void _jid_free(Jid *jid);
+
 Jid *
 jid_create(const gchar * const str)
+{
+    if (str == NULL) {
+        return NULL;
+    }
+
+    if (interned == NULL) {
+        interned = g_hash_table_new(g_str_hash, g_str_equal);
+    }
+
+    Jid *result = g_hash_table_lookup(interned, str);
+    if (result) {
+        return jid_ref(result);
+    }
+
+    result = _jid_parse(str);
+    if (result) {
+        result->refcount = 1;
+        result->released = NULL;
+        g_hash_table_insert(interned, result->str, result);
+    }
+
+    return result;
+}
+
+Jid *
+jid_create_from_bare_and_resource(const char * const room, const char * const nick)
+{
+    Jid *result;
+    char *jid = create_fulljid(room, nick);
+    result = jid_create(jid);
+    free(jid);
+
+    return result;
+}
+
+Jid *
+jid_ref(Jid *jid)
+{
+    if (jid) {
+        if (jid->released) {
+            g_queue_delete_link(&released, jid->released);
+            jid->released = NULL;
+        }
+        jid->refcount++;
+    }
+
+    return jid;
+}
+
+// drop a reference, unreferenced jids are kept for reuse until evicted
+void
+jid_destroy(Jid *jid)
+{
+    if (jid == NULL) {
+        return;
+    }
+
+    assert(jid->refcount > 0);
+    jid->refcount--;
+    if (jid->refcount > 0) {
+        return;
+    }
+
+    // outlived a jid_cache_clear, no longer interned
+    if (interned == NULL || g_hash_table_lookup(interned, jid->str) != jid) {
+        _jid_free(jid);
+        return;
+    }
+
+    g_queue_push_tail(&released, jid);
+    jid->released = g_queue_peek_tail_link(&released);
+
+    if (g_queue_get_length(&released) > JID_RELEASED_MAX) {
+        Jid *oldest = g_queue_pop_head(&released);
+        g_hash_table_remove(interned, oldest->str);
+        _jid_free(oldest);
+    }
+}
+
+void
+jid_cache_clear(void)
+{
+    Jid *jid = g_queue_pop_head(&released);
+    while (jid) {
+        g_hash_table_remove(interned, jid->str);
+        _jid_free(jid);
+        jid = g_queue_pop_head(&released);
+    }
+
+    if (interned) {
+        g_hash_table_destroy(interned);
+        interned = NULL;
+    }
+}
+
+static Jid*
+_jid_parse(const gchar * const str)
 {
     Jid *result = NULL;
 
-    /* if str is NULL g_strdup returns NULL */
     gchar *trimmed = g_strdup(str);
-    if (trimmed == NULL) {
-        return NULL;
-    }
 
     if (strlen(trimmed) == 0) {
         g_free(trimmed);
@@ -75,60 +178,46 @@ jid_create(const gchar * const str)
     result->barejid = NULL;
     result->fulljid = NULL;
 
-    gchar *atp = g_utf8_strchr(trimmed, -1, '@');
-    gchar *slashp = g_utf8_strchr(trimmed, -1, '/');
+    // '@' and '/' are ascii and never part of a multibyte sequence
+    gchar *atp = strchr(trimmed, '@');
+    gchar *slashp = strchr(trimmed, '/');
     gchar *domain_start = trimmed;
 
+    // an '@' in the resource does not start a domain
+    if (atp && slashp && atp > slashp) {
+        atp = NULL;
+    }
+
     if (atp) {
-        result->localpart = g_utf8_substring(trimmed, 0, g_utf8_pointer_to_offset(trimmed, atp));
+        result->localpart = g_strndup(trimmed, atp - trimmed);
         domain_start = atp + 1;
     }
 
     if (slashp) {
         result->resourcepart = g_strdup(slashp + 1);
-        result->domainpart = g_utf8_substring(domain_start, 0, g_utf8_pointer_to_offset(domain_start, slashp));
-        char *barejidraw = g_utf8_substring(trimmed, 0, g_utf8_pointer_to_offset(trimmed, slashp));
-        result->barejid = g_utf8_strdown(barejidraw, -1);
+        result->domainpart = g_strndup(domain_start, slashp - domain_start);
+        result->barejid = g_utf8_strdown(trimmed, slashp - trimmed);
         result->fulljid = g_strdup(trimmed);
-        g_free(barejidraw);
     } else {
         result->domainpart = g_strdup(domain_start);
         result->barejid = g_utf8_strdown(trimmed, -1);
     }
 
-    if (result->domainpart == NULL) {
-        jid_destroy(result);
-        return NULL;
-    }
-
     result->str = trimmed;
 
     return result;
 }
 
-Jid *
-jid_create_from_bare_and_resource(const char * const room, const char * const nick)
+static void
+_jid_free(Jid *jid)
 {
-    Jid *result;
-    char *jid = create_fulljid(room, nick);
-    result = jid_create(jid);
+    g_free(jid->str);
+    g_free(jid->localpart);
+    g_free(jid->domainpart);
+    g_free(jid->resourcepart);
+    g_free(jid->barejid);
+    g_free(jid->fulljid);
     free(jid);
-
-    return result;
-}
-
-void
-jid_destroy(Jid *jid)
-{
-    if (jid) {
-        g_free(jid->str);
-        g_free(jid->localpart);
-        g_free(jid->domainpart);
-        g_free(jid->resourcepart);
-        g_free(jid->barejid);
-        g_free(jid->fulljid);
-        free(jid);
-    }
 }
 
 gboolean
@@ -37,6 +37,7 @@
 
 #include <glib.h>
 
+// interned and shared, the string fields must not be modified
 struct jid_t {
     char *str;
     char *localpart;
@@ -44,13 +45,17 @@ struct jid_t {
     char *resourcepart;
     char *barejid;
     char *fulljid;
+    guint refcount;
+    GList *released;
 };
 
 typedef struct jid_t Jid;
 
 Jid * jid_create(const gchar * const str);
 Jid * jid_create_from_bare_and_resource(const char * const room, const char * const nick);
+Jid * jid_ref(Jid *jid);
 void jid_destroy(Jid *jid);
+void jid_cache_clear(void);
 
 gboolean jid_is_valid_room_form(Jid *jid);
 char * create_fulljid(const char * const barejid, const char * const resource);
@@ -266,10 +266,8 @@ void
 chat_log_msg_out(const char * const barejid, const char * const msg)
 {
     if (prefs_get_boolean(PREF_CHLOG)) {
-        const char *jid = jabber_get_fulljid();
-        Jid *jidp = jid_create(jid);
+        Jid *jidp = jabber_get_jid();
         _chat_log_chat(jidp->barejid, barejid, msg, PROF_OUT_LOG, NULL);
-        jid_destroy(jidp);
     }
 }
 
@@ -277,8 +275,7 @@ void
 chat_log_otr_msg_out(const char * const barejid, const char * const msg)
 {
     if (prefs_get_boolean(PREF_CHLOG)) {
-        const char *jid = jabber_get_fulljid();
-        Jid *jidp = jid_create(jid);
+        Jid *jidp = jabber_get_jid();
         char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
         if (strcmp(pref_otr_log, "on") == 0) {
             _chat_log_chat(jidp->barejid, barejid, msg, PROF_OUT_LOG, NULL);
@@ -286,7 +283,6 @@ chat_log_otr_msg_out(const char * const barejid, const char * const msg)
             _chat_log_chat(jidp->barejid, barejid, "[redacted]", PROF_OUT_LOG, NULL);
         }
         prefs_free_string(pref_otr_log);
-        jid_destroy(jidp);
     }
 }
 
@@ -294,8 +290,7 @@ void
 chat_log_pgp_msg_out(const char * const barejid, const char * const msg)
 {
     if (prefs_get_boolean(PREF_CHLOG)) {
-        const char *jid = jabber_get_fulljid();
-        Jid *jidp = jid_create(jid);
+        Jid *jidp = jabber_get_jid();
         char *pref_pgp_log = prefs_get_string(PREF_PGP_LOG);
         if (strcmp(pref_pgp_log, "on") == 0) {
             _chat_log_chat(jidp->barejid, barejid, msg, PROF_OUT_LOG, NULL);
@@ -303,7 +298,6 @@ chat_log_pgp_msg_out(const char * const barejid, const char * const msg)
             _chat_log_chat(jidp->barejid, barejid, "[redacted]", PROF_OUT_LOG, NULL);
         }
         prefs_free_string(pref_pgp_log);
-        jid_destroy(jidp);
     }
 }
 
@@ -311,8 +305,7 @@ void
 chat_log_otr_msg_in(const char * const barejid, const char * const msg, gboolean was_decrypted, GDateTime *timestamp)
 {
     if (prefs_get_boolean(PREF_CHLOG)) {
-        const char *jid = jabber_get_fulljid();
-        Jid *jidp = jid_create(jid);
+        Jid *jidp = jabber_get_jid();
         char *pref_otr_log = prefs_get_string(PREF_OTR_LOG);
         if (!was_decrypted || (strcmp(pref_otr_log, "on") == 0)) {
             _chat_log_chat(jidp->barejid, barejid, msg, PROF_IN_LOG, timestamp);
@@ -320,7 +313,6 @@ chat_log_otr_msg_in(const char * const barejid, const char * const msg, gboolean
             _chat_log_chat(jidp->barejid, barejid, "[redacted]", PROF_IN_LOG, timestamp);
         }
         prefs_free_string(pref_otr_log);
-        jid_destroy(jidp);
     }
 }
 
@@ -328,8 +320,7 @@ void
 chat_log_pgp_msg_in(const char * const barejid, const char * const msg, GDateTime *timestamp)
 {
     if (prefs_get_boolean(PREF_CHLOG)) {
-        const char *jid = jabber_get_fulljid();
-        Jid *jidp = jid_create(jid);
+        Jid *jidp = jabber_get_jid();
         char *pref_pgp_log = prefs_get_string(PREF_PGP_LOG);
         if (strcmp(pref_pgp_log, "on") == 0) {
             _chat_log_chat(jidp->barejid, barejid, msg, PROF_IN_LOG, timestamp);
@@ -337,7 +328,6 @@ chat_log_pgp_msg_in(const char * const barejid, const char * const msg, GDateTim
             _chat_log_chat(jidp->barejid, barejid, "[redacted]", PROF_IN_LOG, timestamp);
         }
         prefs_free_string(pref_pgp_log);
-        jid_destroy(jidp);
     }
 }
 
@@ -345,10 +335,8 @@ void
 chat_log_msg_in(const char * const barejid, const char * const msg, GDateTime *timestamp)
 {
     if (prefs_get_boolean(PREF_CHLOG)) {
-        const char *jid = jabber_get_fulljid();
-        Jid *jidp = jid_create(jid);
+        Jid *jidp = jabber_get_jid();
         _chat_log_chat(jidp->barejid, barejid, msg, PROF_IN_LOG, timestamp);
-        jid_destroy(jidp);
     }
 }
 
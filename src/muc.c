@@ -41,7 +41,9 @@
 #include "contact.h"
 #include "common.h"
 #include "jid.h"
+#include "config/preferences.h"
 #include "tools/autocomplete.h"
+#include "tools/keyword_matcher.h"
 #include "ui/ui.h"
 #include "window_list.h"
 #include "muc.h"
@@ -59,6 +61,10 @@ typedef struct _muc_room_t {
     gboolean autojoin;
     gboolean pending_nick_change;
     GHashTable *roster;
+    GSequence *occupants;
+    GSequence *occupants_by_role[MUC_ROLE_MODERATOR + 1];
+    GHashTable *occupant_iters;
+    KeywordMatcher mention_matcher;
     Autocomplete nick_ac;
     Autocomplete jid_ac;
     GHashTable *nick_changes;
@@ -66,12 +72,26 @@ typedef struct _muc_room_t {
     muc_member_type_t member_type;
 } ChatRoom;
 
+// position of an occupant in the room's sorted sequences
+typedef struct _occupant_iters_t {
+    GSequenceIter *all;
+    GSequenceIter *by_role;
+} OccupantIters;
+
 GHashTable *rooms = NULL;
 GHashTable *invite_passwords = NULL;
+GHashTable *last_seen = NULL;
+GList *mention_triggers = NULL;
 Autocomplete invite_ac;
 
 static void _free_room(ChatRoom *room);
 static gint _compare_occupants(Occupant *a, Occupant *b);
+static gint _compare_occupants_seq(gconstpointer a, gconstpointer b, gpointer data);
+static void _roster_insert(ChatRoom *chat_room, const char * const nick, Occupant *occupant);
+static void _roster_remove(ChatRoom *chat_room, const char * const nick);
+static void _roster_set_role(ChatRoom *chat_room, const char * const nick, Occupant *occupant,
+    muc_role_t role);
+static void _compile_mention_matcher(ChatRoom *chat_room);
 static muc_role_t _role_from_string(const char * const role);
 static muc_affiliation_t _affiliation_from_string(const char * const affiliation);
 static char* _role_to_string(muc_role_t role);
@@ -86,6 +106,7 @@ muc_init(void)
     invite_ac = autocomplete_new();
     rooms = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_free_room);
     invite_passwords = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    last_seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_date_time_unref);
 }
 
 void
@@ -94,8 +115,12 @@ muc_close(void)
     autocomplete_free(invite_ac);
     g_hash_table_destroy(rooms);
     g_hash_table_destroy(invite_passwords);
+    g_hash_table_destroy(last_seen);
+    g_list_free_full(mention_triggers, free);
     rooms = NULL;
     invite_passwords = NULL;
+    last_seen = NULL;
+    mention_triggers = NULL;
 }
 
 void
@@ -190,7 +215,16 @@ muc_join(const char * const room, const char * const nick,
     new_room->pending_broadcasts = NULL;
     new_room->pending_config = FALSE;
     new_room->roster = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_occupant_free);
+    new_room->occupants = g_sequence_new(NULL);
+    int i;
+    for (i = 0; i <= MUC_ROLE_MODERATOR; i++) {
+        new_room->occupants_by_role[i] = g_sequence_new(NULL);
+    }
+    new_room->occupant_iters = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    new_room->mention_matcher = NULL;
+    _compile_mention_matcher(new_room);
     new_room->nick_ac = autocomplete_new();
+    autocomplete_set_fuzzy(new_room->nick_ac, TRUE);
     new_room->jid_ac = autocomplete_new();
     new_room->nick_changes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
     new_room->roster_received = FALSE;
@@ -356,11 +390,12 @@ muc_nick_change_complete(const char * const room, const char * const nick)
 {
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
-        g_hash_table_remove(chat_room->roster, chat_room->nick);
+        _roster_remove(chat_room, chat_room->nick);
         autocomplete_remove(chat_room->nick_ac, chat_room->nick);
         free(chat_room->nick);
         chat_room->nick = strdup(nick);
         chat_room->pending_nick_change = FALSE;
+        _compile_mention_matcher(chat_room);
         g_hash_table_remove(chat_room->nick_changes, nick);
     }
 }
@@ -376,6 +411,77 @@ muc_rooms(void)
     return g_hash_table_get_keys(rooms);
 }
 
+/*
+ * Set the words, besides our nick, that mention us in chat rooms
+ */
+void
+muc_set_mention_triggers(GList *triggers)
+{
+    g_list_free_full(mention_triggers, free);
+    mention_triggers = NULL;
+    GList *curr = triggers;
+    while (curr) {
+        mention_triggers = g_list_append(mention_triggers, strdup(curr->data));
+        curr = g_list_next(curr);
+    }
+
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, rooms);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        _compile_mention_matcher(value);
+    }
+}
+
+/*
+ * Set the mention triggers from the room notify triggers preference
+ */
+void
+muc_load_mention_triggers(void)
+{
+    GList *triggers = prefs_get_room_notify_triggers();
+    muc_set_mention_triggers(triggers);
+    g_list_free_full(triggers, free);
+}
+
+/*
+ * Returns TRUE if the message mentions our nick or a trigger, ignoring case
+ */
+gboolean
+muc_message_mentions(const char * const room, const char * const message)
+{
+    ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
+    if (chat_room) {
+        return keyword_matcher_match(chat_room->mention_matcher, message);
+    } else {
+        return FALSE;
+    }
+}
+
+/*
+ * Record the time of a message seen in the room, kept after leaving so
+ * rejoining only requests newer history
+ */
+void
+muc_set_last_seen(const char * const room, GDateTime *timestamp)
+{
+    GDateTime *current = g_hash_table_lookup(last_seen, room);
+    if (current == NULL || g_date_time_compare(timestamp, current) > 0) {
+        g_hash_table_replace(last_seen, strdup(room), g_date_time_ref(timestamp));
+    }
+}
+
+/*
+ * Return the time of the latest message seen in the room, or NULL
+ * The timestamp is owned by the last_seen table and should not be unreffed
+ */
+GDateTime *
+muc_last_seen(const char * const room)
+{
+    return g_hash_table_lookup(last_seen, room);
+}
+
 /*
  * Return current users nickname for the specified room
  * The nickname is owned by the chat room and should not be modified or freed
@@ -433,23 +539,41 @@ muc_roster_add(const char * const room, const char * const nick, const char * co
     resource_presence_t new_presence = resource_presence_from_string(show);
 
     if (chat_room) {
-        Occupant *old = g_hash_table_lookup(chat_room->roster, nick);
+        muc_role_t role_t = _role_from_string(role);
+        muc_affiliation_t affiliation_t = _affiliation_from_string(affiliation);
+        Occupant *occupant = g_hash_table_lookup(chat_room->roster, nick);
+        gboolean jid_changed = FALSE;
 
-        if (!old) {
+        if (!occupant) {
             updated = TRUE;
+            jid_changed = TRUE;
             autocomplete_add(chat_room->nick_ac, nick);
-        } else if (old->presence != new_presence ||
-                    (g_strcmp0(old->status, status) != 0)) {
-            updated = TRUE;
-        }
+            occupant = _muc_occupant_new(nick, jid, role_t, affiliation_t, new_presence, status);
+            _roster_insert(chat_room, nick, occupant);
 
-        resource_presence_t presence = resource_presence_from_string(show);
-        muc_role_t role_t = _role_from_string(role);
-        muc_affiliation_t affiliation_t = _affiliation_from_string(affiliation);
-        Occupant *occupant = _muc_occupant_new(nick, jid, role_t, affiliation_t, presence, status);
-        g_hash_table_replace(chat_room->roster, strdup(nick), occupant);
+        // update in place, only copying strings that changed
+        } else {
+            if (occupant->presence != new_presence) {
+                occupant->presence = new_presence;
+                updated = TRUE;
+            }
+            if (g_strcmp0(occupant->status, status) != 0) {
+                free(occupant->status);
+                occupant->status = status ? strdup(status) : NULL;
+                updated = TRUE;
+            }
+            if (g_strcmp0(occupant->jid, jid) != 0) {
+                free(occupant->jid);
+                occupant->jid = jid ? strdup(jid) : NULL;
+                jid_changed = TRUE;
+            }
+            if (occupant->role != role_t) {
+                _roster_set_role(chat_room, nick, occupant, role_t);
+            }
+            occupant->affiliation = affiliation_t;
+        }
 
-        if (jid) {
+        if (jid && jid_changed) {
             Jid *jidp = jid_create(jid);
             if (jidp->barejid) {
                 autocomplete_add(chat_room->jid_ac, jidp->barejid);
@@ -469,7 +593,7 @@ muc_roster_remove(const char * const room, const char * const nick)
 {
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
-        g_hash_table_remove(chat_room->roster, nick);
+        _roster_remove(chat_room, nick);
         autocomplete_remove(chat_room->nick_ac, nick);
     }
 }
@@ -487,7 +611,8 @@ muc_roster_item(const char * const room, const char * const nick)
 }
 
 /*
- * Return a list of PContacts representing the room members in the room's roster
+ * Return a list of Occupants representing the room members in the room's roster,
+ * ordered by nick
  */
 GList *
 muc_roster(const char * const room)
@@ -495,22 +620,34 @@ muc_roster(const char * const room)
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
         GList *result = NULL;
-        GList *occupants = g_hash_table_get_values(chat_room->roster);
 
-        GList *curr = occupants;
-        while (curr) {
-            result = g_list_insert_sorted(result, curr->data, (GCompareFunc)_compare_occupants);
-            curr = g_list_next(curr);
+        // walk backwards so prepending keeps the order
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->occupants);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            result = g_list_prepend(result, g_sequence_get(curr));
         }
 
-        g_list_free(occupants);
-
         return result;
     } else {
         return NULL;
     }
 }
 
+/*
+ * Return the number of occupants in the room's roster
+ */
+int
+muc_roster_size(const char * const room)
+{
+    ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
+    if (chat_room) {
+        return g_hash_table_size(chat_room->roster);
+    } else {
+        return 0;
+    }
+}
+
 /*
  * Return a Autocomplete representing the room member's in the roster
  */
@@ -525,6 +662,15 @@ muc_roster_ac(const char * const room)
     }
 }
 
+void
+muc_roster_touch(const char * const room, const char * const nick)
+{
+    ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
+    if (chat_room) {
+        autocomplete_touch(chat_room->nick_ac, nick);
+    }
+}
+
 Autocomplete
 muc_roster_jid_ac(const char * const room)
 {
@@ -586,17 +732,14 @@ muc_occupants_by_role(const char * const room, muc_role_t role)
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
         GSList *result = NULL;
-        GHashTableIter iter;
-        gpointer key;
-        gpointer value;
-
-        g_hash_table_iter_init(&iter, chat_room->roster);
-        while (g_hash_table_iter_next(&iter, &key, &value)) {
-            Occupant *occupant = (Occupant *)value;
-            if (occupant->role == role) {
-                result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_occupants);
-            }
+
+        // walk backwards so prepending keeps the order
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->occupants_by_role[role]);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            result = g_slist_prepend(result, g_sequence_get(curr));
         }
+
         return result;
     } else {
         return NULL;
@@ -609,15 +752,14 @@ muc_occupants_by_affiliation(const char * const room, muc_affiliation_t affiliat
     ChatRoom *chat_room = g_hash_table_lookup(rooms, room);
     if (chat_room) {
         GSList *result = NULL;
-        GHashTableIter iter;
-        gpointer key;
-        gpointer value;
 
-        g_hash_table_iter_init(&iter, chat_room->roster);
-        while (g_hash_table_iter_next(&iter, &key, &value)) {
-            Occupant *occupant = (Occupant *)value;
+        // walk backwards so prepending keeps the order
+        GSequenceIter *curr = g_sequence_get_end_iter(chat_room->occupants);
+        while (!g_sequence_iter_is_begin(curr)) {
+            curr = g_sequence_iter_prev(curr);
+            Occupant *occupant = g_sequence_get(curr);
             if (occupant->affiliation == affiliation) {
-                result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_occupants);
+                result = g_slist_prepend(result, occupant);
             }
         }
         return result;
@@ -817,6 +959,15 @@ _free_room(ChatRoom *room)
         free(room->subject);
         free(room->password);
         free(room->autocomplete_prefix);
+        keyword_matcher_free(room->mention_matcher);
+        if (room->occupant_iters) {
+            g_hash_table_destroy(room->occupant_iters);
+        }
+        g_sequence_free(room->occupants);
+        int i;
+        for (i = 0; i <= MUC_ROLE_MODERATOR; i++) {
+            g_sequence_free(room->occupants_by_role[i]);
+        }
         if (room->roster) {
             g_hash_table_destroy(room->roster);
         }
@@ -843,6 +994,72 @@ gint _compare_occupants(Occupant *a, Occupant *b)
     return result;
 }
 
+// compiled once per nick or trigger change, matched on every room message
+static void
+_compile_mention_matcher(ChatRoom *chat_room)
+{
+    GList *keywords = g_list_copy(mention_triggers);
+    keywords = g_list_prepend(keywords, chat_room->nick);
+
+    keyword_matcher_free(chat_room->mention_matcher);
+    chat_room->mention_matcher = keyword_matcher_new(keywords);
+
+    g_list_free(keywords);
+}
+
+static gint
+_compare_occupants_seq(gconstpointer a, gconstpointer b, gpointer data)
+{
+    Occupant *occupant_a = (Occupant *)a;
+    Occupant *occupant_b = (Occupant *)b;
+
+    gint result = _compare_occupants(occupant_a, occupant_b);
+    if (result == 0) {
+        result = g_strcmp0(occupant_a->nick, occupant_b->nick);
+    }
+
+    return result;
+}
+
+// add or replace the occupant, keeping the sorted sequences in step
+static void
+_roster_insert(ChatRoom *chat_room, const char * const nick, Occupant *occupant)
+{
+    _roster_remove(chat_room, nick);
+
+    OccupantIters *iters = malloc(sizeof(OccupantIters));
+    iters->all = g_sequence_insert_sorted(chat_room->occupants, occupant, _compare_occupants_seq, NULL);
+    iters->by_role = g_sequence_insert_sorted(chat_room->occupants_by_role[occupant->role], occupant,
+        _compare_occupants_seq, NULL);
+    g_hash_table_insert(chat_room->occupant_iters, strdup(nick), iters);
+    g_hash_table_insert(chat_room->roster, strdup(nick), occupant);
+}
+
+// move the occupant to the sequence for its new role
+static void
+_roster_set_role(ChatRoom *chat_room, const char * const nick, Occupant *occupant, muc_role_t role)
+{
+    OccupantIters *iters = g_hash_table_lookup(chat_room->occupant_iters, nick);
+    occupant->role = role;
+    if (iters) {
+        g_sequence_remove(iters->by_role);
+        iters->by_role = g_sequence_insert_sorted(chat_room->occupants_by_role[role], occupant,
+            _compare_occupants_seq, NULL);
+    }
+}
+
+static void
+_roster_remove(ChatRoom *chat_room, const char * const nick)
+{
+    OccupantIters *iters = g_hash_table_lookup(chat_room->occupant_iters, nick);
+    if (iters) {
+        g_sequence_remove(iters->all);
+        g_sequence_remove(iters->by_role);
+        g_hash_table_remove(chat_room->occupant_iters, nick);
+    }
+    g_hash_table_remove(chat_room->roster, nick);
+}
+
 static muc_role_t
 _role_from_string(const char * const role)
 {
@@ -42,6 +42,10 @@
 #include "tools/autocomplete.h"
 #include "ui/win_types.h"
 
+// seconds the local clock may be ahead of the server's, live room messages
+// are marked seen this much earlier than their local receipt time
+#define MUC_LAST_SEEN_SKEW 120
+
 typedef enum {
     MUC_ROLE_NONE,
     MUC_ROLE_VISITOR,
@@ -89,6 +93,13 @@ void muc_set_features(const char * const room, GSList *features);
 char* muc_nick(const char * const room);
 char* muc_password(const char * const room);
 
+void muc_set_mention_triggers(GList *triggers);
+void muc_load_mention_triggers(void);
+gboolean muc_message_mentions(const char * const room, const char * const message);
+
+void muc_set_last_seen(const char * const room, GDateTime *timestamp);
+GDateTime* muc_last_seen(const char * const room);
+
 void muc_nick_change_start(const char * const room, const char * const new_nick);
 void muc_nick_change_complete(const char * const room, const char * const nick);
 gboolean muc_nick_change_pending(const char * const room);
@@ -102,7 +113,9 @@ gboolean muc_roster_add(const char * const room, const char * const nick, const
 void muc_roster_remove(const char * const room, const char * const nick);
 void muc_roster_set_complete(const char * const room);
 GList * muc_roster(const char * const room);
+int muc_roster_size(const char * const room);
 Autocomplete muc_roster_ac(const char * const room);
+void muc_roster_touch(const char * const room, const char * const nick);
 Autocomplete muc_roster_jid_ac(const char * const room);
 void muc_jid_autocomplete_reset(const char * const room);
 void muc_jid_autocomplete_add_all(const char * const room, GSList *jids);
@@ -50,12 +50,15 @@
 #include "chat_state.h"
 #include "config/accounts.h"
 #include "config/preferences.h"
+#include "config/persist.h"
 #include "config/theme.h"
 #include "command/command.h"
 #include "common.h"
 #include "contact.h"
 #include "roster_list.h"
 #include "config/tlscerts.h"
+#include "tools/autocomplete.h"
+#include "jid.h"
 #include "log.h"
 #include "muc.h"
 #ifdef HAVE_LIBOTR
@@ -122,6 +125,8 @@ prof_run(const int disable_tls, char *log_level, char *account_name)
 #endif
         notify_remind();
         jabber_process_events(10);
+        persist_write_due();
+        wins_hibernate_idle(prefs_get_wins_hibernate());
         ui_update();
     }
 }
@@ -134,12 +139,14 @@ prof_handle_idle(void)
         GSList *recipients = ui_get_chat_recipients();
         GSList *curr = recipients;
 
+        jabber_cork();
         while (curr) {
             char *barejid = curr->data;
             ProfChatWin *chatwin = wins_get_chat(barejid);
             chat_state_handle_idle(chatwin->barejid, chatwin->state);
             curr = g_slist_next(curr);
         }
+        jabber_uncork();
 
         if (recipients) {
             g_slist_free(recipients);
@@ -299,6 +306,7 @@ _init(const int disable_tls, char *log_level)
     _create_directories();
     log_level_t prof_log_level = log_level_from_string(log_level);
     prefs_load();
+    autocomplete_fuzzy_enable(prefs_get_boolean(PREF_FUZZY));
     log_init(prof_log_level);
     log_stderr_init(PROF_LEVEL_ERROR);
     if (strcmp(PACKAGE_STATUS, "development") == 0) {
@@ -322,6 +330,7 @@ _init(const int disable_tls, char *log_level)
     log_info("Initialising contact list");
     roster_init();
     muc_init();
+    muc_load_mention_triggers();
     tlscerts_init();
 #ifdef HAVE_LIBOTR
     otr_init();
@@ -344,6 +353,8 @@ _shutdown(void)
         }
     }
     ui_close_all_wins();
+    // write anything still waiting on its interval before state is freed
+    persist_flush_all();
     jabber_disconnect();
     jabber_shutdown();
     roster_free();
@@ -361,6 +372,7 @@ _shutdown(void)
     accounts_close();
     tlscerts_close();
     cmd_uninit();
+    jid_cache_clear();
     log_stderr_close();
     log_close();
     prefs_close();
@@ -381,6 +393,8 @@ _create_directories(void)
     g_string_append(chatlogs_dir, "/profanity/chatlogs");
     GString *logs_dir = g_string_new(xdg_data);
     g_string_append(logs_dir, "/profanity/logs");
+    GString *rosters_dir = g_string_new(xdg_data);
+    g_string_append(rosters_dir, "/profanity/rosters");
 
     if (!mkdir_recursive(themes_dir->str)) {
         log_error("Error while creating directory %s", themes_dir->str);
@@ -391,10 +405,14 @@ _create_directories(void)
     if (!mkdir_recursive(logs_dir->str)) {
         log_error("Error while creating directory %s", logs_dir->str);
     }
+    if (!mkdir_recursive(rosters_dir->str)) {
+        log_error("Error while creating directory %s", rosters_dir->str);
+    }
 
     g_string_free(themes_dir, TRUE);
     g_string_free(chatlogs_dir, TRUE);
     g_string_free(logs_dir, TRUE);
+    g_string_free(rosters_dir, TRUE);
 
     g_free(xdg_config);
     g_free(xdg_data);
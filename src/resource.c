@@ -56,6 +56,22 @@ Resource * resource_new(const char * const name, resource_presence_t presence,
     return new_resource;
 }
 
+gboolean
+resource_update(Resource *resource, resource_presence_t presence,
+    const char * const status, const int priority)
+{
+    gboolean reorder = resource->presence != presence || resource->priority != priority;
+
+    resource->presence = presence;
+    resource->priority = priority;
+    if (g_strcmp0(resource->status, status) != 0) {
+        free(resource->status);
+        resource->status = status ? strdup(status) : NULL;
+    }
+
+    return reorder;
+}
+
 int
 resource_compare_availability(Resource *first, Resource *second)
 {
@@ -47,6 +47,8 @@ typedef struct resource_t {
 Resource * resource_new(const char * const name, resource_presence_t presence,
     const char * const status, const int priority);
 void resource_destroy(Resource *resource);
+gboolean resource_update(Resource *resource, resource_presence_t presence,
+    const char * const status, const int priority);
 
 int resource_compare_availability(Resource *first, Resource *second);
 
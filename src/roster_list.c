@@ -33,6 +33,7 @@
  */
 
 
+#include <stdlib.h>
 #include <string.h>
 #include <glib.h>
 #include <assert.h>
@@ -62,13 +63,48 @@ static GHashTable *contacts;
 // nickname to jid map
 static GHashTable *name_to_barejid;
 
+// contacts in display order
+static GSequence *contacts_ordered;
+
+// contacts without a group, in display order
+static GSequence *nogroup_view;
+
+// group name to contacts in that group, in display order
+static GHashTable *group_views;
+
+// presence to contacts with that presence, in display order
+static GHashTable *presence_views;
+
+// contact to its positions in the ordered views
+static GHashTable *contact_index;
+
+// autocomplete items collected while bulk adding
+static gboolean bulk_adding = FALSE;
+static GSList *bulk_names;
+static GSList *bulk_barejids;
+static GSList *bulk_groups;
+
+typedef struct roster_index_entry_t {
+    GSequenceIter *ordered;
+    GSequenceIter *presence;
+    char *presence_name;
+    // positions in each group view, or in the nogroup view
+    GSList *groups;
+} RosterIndexEntry;
+
 static gboolean _key_equals(void *key1, void *key2);
 static gboolean _datetimes_equal(GDateTime *dt1, GDateTime *dt2);
 static void _replace_name(const char * const current_name,
     const char * const new_name, const char * const barejid);
 static void _add_name_and_barejid(const char * const name,
     const char * const barejid);
-static gint _compare_contacts(PContact a, PContact b);
+static gint _compare_contacts(gconstpointer a, gconstpointer b, gpointer data);
+static void _index_init(void);
+static void _index_free(void);
+static void _index_add(PContact contact);
+static void _index_remove(PContact contact);
+static void _index_presence_changed(PContact contact);
+static GSList* _view_to_list(GSequence *view);
 
 void
 roster_clear(void)
@@ -83,9 +119,11 @@ roster_clear(void)
     g_hash_table_destroy(name_to_barejid);
     name_to_barejid = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
         g_free);
+    _index_free();
+    _index_init();
 }
 
-gboolean
+Resource *
 roster_update_presence(const char * const barejid, Resource *resource,
     GDateTime *last_activity)
 {
@@ -94,24 +132,35 @@ roster_update_presence(const char * const barejid, Resource *resource,
 
     PContact contact = roster_get_contact(barejid);
     if (contact == NULL) {
-        return FALSE;
+        resource_destroy(resource);
+        return NULL;
     }
     if (!_datetimes_equal(p_contact_last_activity(contact), last_activity)) {
         p_contact_set_last_activity(contact, last_activity);
     }
-    p_contact_set_presence(contact, resource);
-    Jid *jid = jid_create_from_bare_and_resource(barejid, resource->name);
-    autocomplete_add(fulljid_ac, jid->fulljid);
-    jid_destroy(jid);
+    gboolean known = p_contact_get_resource(contact, resource->name) != NULL;
+    Resource *current = p_contact_set_presence(contact, resource);
+    _index_presence_changed(contact);
+    if (!known) {
+        Jid *jid = jid_create_from_bare_and_resource(barejid, current->name);
+        autocomplete_add(fulljid_ac, jid->fulljid);
+        jid_destroy(jid);
+    }
 
-    return TRUE;
+    return current;
 }
 
 PContact
 roster_get_contact(const char * const barejid)
 {
+    // keys are lower case, most jids already are
+    PContact contact = g_hash_table_lookup(contacts, barejid);
+    if (contact) {
+        return contact;
+    }
+
     gchar *barejidlower = g_utf8_strdown(barejid, -1);
-    PContact contact = g_hash_table_lookup(contacts, barejidlower);
+    contact = g_hash_table_lookup(contacts, barejidlower);
     g_free(barejidlower);
 
     return contact;
@@ -158,6 +207,7 @@ roster_contact_offline(const char * const barejid,
     } else {
         gboolean result = p_contact_remove_resource(contact, resource);
         if (result == TRUE) {
+            _index_presence_changed(contact);
             Jid *jid = jid_create_from_bare_and_resource(barejid, resource);
             autocomplete_remove(fulljid_ac, jid->fulljid);
             jid_destroy(jid);
@@ -167,6 +217,16 @@ roster_contact_offline(const char * const barejid,
     }
 }
 
+void
+roster_touch(const char * const barejid)
+{
+    PContact contact = roster_get_contact(barejid);
+    if (contact) {
+        autocomplete_touch(name_ac, p_contact_name_or_jid(contact));
+        autocomplete_touch(barejid_ac, p_contact_barejid(contact));
+    }
+}
+
 void
 roster_reset_search_attempts(void)
 {
@@ -183,10 +243,13 @@ roster_init(void)
     barejid_ac = autocomplete_new();
     fulljid_ac = autocomplete_new();
     groups_ac = autocomplete_new();
+    autocomplete_set_fuzzy(name_ac, TRUE);
+    autocomplete_set_fuzzy(barejid_ac, TRUE);
     contacts = g_hash_table_new_full(g_str_hash, (GEqualFunc)_key_equals, g_free,
         (GDestroyNotify)p_contact_free);
     name_to_barejid = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
         g_free);
+    _index_init();
 }
 
 void
@@ -196,6 +259,7 @@ roster_free(void)
     autocomplete_free(barejid_ac);
     autocomplete_free(fulljid_ac);
     autocomplete_free(groups_ac);
+    _index_free();
 }
 
 void
@@ -212,6 +276,10 @@ roster_change_name(PContact contact, const char * const new_name)
 
     p_contact_set_name(contact, new_name);
     _replace_name(current_name, new_name, barejid);
+
+    // reposition in ordered views
+    _index_remove(contact);
+    _index_add(contact);
 }
 
 void
@@ -234,6 +302,7 @@ roster_remove(const char * const name, const char * const barejid)
             resources = g_list_next(resources);
         }
         g_list_free(resources);
+        _index_remove(contact);
     }
 
     // remove the contact
@@ -260,6 +329,10 @@ roster_update(const char * const barejid, const char * const name,
     p_contact_set_groups(contact, groups);
     _replace_name(current_name, new_name, barejid);
 
+    // name or groups may have changed, reposition in ordered views
+    _index_remove(contact);
+    _index_add(contact);
+
     // add groups
     while (groups) {
         autocomplete_add(groups_ac, groups->data);
@@ -278,6 +351,25 @@ roster_add(const char * const barejid, const char * const name, GSList *groups,
 
     contact = p_contact_new(barejid, name, groups, subscription, NULL,
         pending_out);
+    g_hash_table_insert(contacts, strdup(barejid), contact);
+    _index_add(contact);
+
+    if (bulk_adding) {
+        // autocompleters are built once in roster_add_bulk_end
+        while (groups) {
+            bulk_groups = g_slist_prepend(bulk_groups, groups->data);
+            groups = g_slist_next(groups);
+        }
+        bulk_barejids = g_slist_prepend(bulk_barejids, (char*)p_contact_barejid(contact));
+        if (name) {
+            bulk_names = g_slist_prepend(bulk_names, (char*)p_contact_name(contact));
+            g_hash_table_insert(name_to_barejid, strdup(name), strdup(barejid));
+        } else {
+            bulk_names = g_slist_prepend(bulk_names, (char*)p_contact_barejid(contact));
+            g_hash_table_insert(name_to_barejid, strdup(barejid), strdup(barejid));
+        }
+        return TRUE;
+    }
 
     // add groups
     while (groups) {
@@ -285,13 +377,38 @@ roster_add(const char * const barejid, const char * const name, GSList *groups,
         groups = g_slist_next(groups);
     }
 
-    g_hash_table_insert(contacts, strdup(barejid), contact);
     autocomplete_add(barejid_ac, barejid);
     _add_name_and_barejid(name, barejid);
 
     return TRUE;
 }
 
+void
+roster_add_bulk_begin(void)
+{
+    bulk_adding = TRUE;
+}
+
+void
+roster_add_bulk_end(void)
+{
+    if (!bulk_adding) {
+        return;
+    }
+
+    autocomplete_add_all(name_ac, bulk_names);
+    autocomplete_add_all(barejid_ac, bulk_barejids);
+    autocomplete_add_all(groups_ac, bulk_groups);
+
+    g_slist_free(bulk_names);
+    g_slist_free(bulk_barejids);
+    g_slist_free(bulk_groups);
+    bulk_names = NULL;
+    bulk_barejids = NULL;
+    bulk_groups = NULL;
+    bulk_adding = FALSE;
+}
+
 char *
 roster_barejid_from_name(const char * const name)
 {
@@ -305,55 +422,30 @@ roster_barejid_from_name(const char * const name)
 GSList *
 roster_get_contacts_by_presence(const char * const presence)
 {
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        PContact contact = (PContact)value;
-        if (g_strcmp0(p_contact_presence(contact), presence) == 0) {
-            result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
-        }
-    }
-
-    // return all contact structs
-    return result;
+    return _view_to_list(g_hash_table_lookup(presence_views, presence));
 }
 
 GSList *
 roster_get_contacts(void)
 {
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
-    }
-
-    // return all contact structs
-    return result;
+    return _view_to_list(contacts_ordered);
 }
 
 GSList *
 roster_get_contacts_online(void)
 {
     GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
 
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        if(strcmp(p_contact_presence(value), "offline"))
-            result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
+    // walk backwards so prepending keeps display order
+    GSequenceIter *curr = g_sequence_get_end_iter(contacts_ordered);
+    while (!g_sequence_iter_is_begin(curr)) {
+        curr = g_sequence_iter_prev(curr);
+        PContact contact = g_sequence_get(curr);
+        if (strcmp(p_contact_presence(contact), "offline")) {
+            result = g_slist_prepend(result, contact);
+        }
     }
 
-    // return all contact structs
     return result;
 }
 
@@ -390,45 +482,13 @@ roster_fulljid_autocomplete(const char * const search_str)
 GSList *
 roster_get_nogroup(void)
 {
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        GSList *groups = p_contact_groups(value);
-        if (groups == NULL) {
-            result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
-        }
-    }
-
-    // return all contact structs
-    return result;
+    return _view_to_list(nogroup_view);
 }
 
 GSList *
 roster_get_group(const char * const group)
 {
-    GSList *result = NULL;
-    GHashTableIter iter;
-    gpointer key;
-    gpointer value;
-
-    g_hash_table_iter_init(&iter, contacts);
-    while (g_hash_table_iter_next(&iter, &key, &value)) {
-        GSList *groups = p_contact_groups(value);
-        while (groups) {
-            if (strcmp(groups->data, group) == 0) {
-                result = g_slist_insert_sorted(result, value, (GCompareFunc)_compare_contacts);
-                break;
-            }
-            groups = g_slist_next(groups);
-        }
-    }
-
-    // return all contact structs
-    return result;
+    return _view_to_list(g_hash_table_lookup(group_views, group));
 }
 
 GSList *
@@ -501,24 +561,157 @@ _add_name_and_barejid(const char * const name, const char * const barejid)
     }
 }
 
-static
-gint _compare_contacts(PContact a, PContact b)
+static gint
+_compare_contacts(gconstpointer a, gconstpointer b, gpointer data)
 {
+    PContact contact_a = (PContact)a;
+    PContact contact_b = (PContact)b;
     const char * utf8_str_a = NULL;
     const char * utf8_str_b = NULL;
 
-    if (p_contact_name_collate_key(a)) {
-        utf8_str_a = p_contact_name_collate_key(a);
+    if (p_contact_name_collate_key(contact_a)) {
+        utf8_str_a = p_contact_name_collate_key(contact_a);
     } else {
-        utf8_str_a = p_contact_barejid_collate_key(a);
+        utf8_str_a = p_contact_barejid_collate_key(contact_a);
     }
-    if (p_contact_name_collate_key(b)) {
-        utf8_str_b = p_contact_name_collate_key(b);
+    if (p_contact_name_collate_key(contact_b)) {
+        utf8_str_b = p_contact_name_collate_key(contact_b);
     } else {
-        utf8_str_b = p_contact_barejid_collate_key(b);
+        utf8_str_b = p_contact_barejid_collate_key(contact_b);
     }
 
     gint result = g_strcmp0(utf8_str_a, utf8_str_b);
 
+    // keep contacts sharing a name in a stable order
+    if (result == 0) {
+        result = g_strcmp0(p_contact_barejid_collate_key(contact_a),
+            p_contact_barejid_collate_key(contact_b));
+    }
+
+    return result;
+}
+
+static void
+_index_entry_free(RosterIndexEntry *entry)
+{
+    if (entry) {
+        free(entry->presence_name);
+        g_slist_free(entry->groups);
+        free(entry);
+    }
+}
+
+static void
+_index_init(void)
+{
+    contacts_ordered = g_sequence_new(NULL);
+    nogroup_view = g_sequence_new(NULL);
+    group_views = g_hash_table_new_full(g_str_hash, g_str_equal, free,
+        (GDestroyNotify)g_sequence_free);
+    presence_views = g_hash_table_new_full(g_str_hash, g_str_equal, free,
+        (GDestroyNotify)g_sequence_free);
+    contact_index = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+        (GDestroyNotify)_index_entry_free);
+}
+
+static void
+_index_free(void)
+{
+    g_hash_table_destroy(contact_index);
+    g_hash_table_destroy(presence_views);
+    g_hash_table_destroy(group_views);
+    g_sequence_free(nogroup_view);
+    g_sequence_free(contacts_ordered);
+}
+
+static GSequenceIter*
+_view_insert(GHashTable *views, const char * const name, PContact contact)
+{
+    GSequence *view = g_hash_table_lookup(views, name);
+    if (view == NULL) {
+        view = g_sequence_new(NULL);
+        g_hash_table_insert(views, strdup(name), view);
+    }
+
+    return g_sequence_insert_sorted(view, contact, _compare_contacts, NULL);
+}
+
+static void
+_index_add(PContact contact)
+{
+    RosterIndexEntry *entry = malloc(sizeof(RosterIndexEntry));
+    entry->ordered = g_sequence_insert_sorted(contacts_ordered, contact,
+        _compare_contacts, NULL);
+    entry->presence_name = strdup(p_contact_presence(contact));
+    entry->presence = _view_insert(presence_views, entry->presence_name, contact);
+
+    entry->groups = NULL;
+    GSList *groups = p_contact_groups(contact);
+    if (groups == NULL) {
+        entry->groups = g_slist_append(entry->groups,
+            g_sequence_insert_sorted(nogroup_view, contact, _compare_contacts, NULL));
+    }
+    while (groups) {
+        entry->groups = g_slist_append(entry->groups,
+            _view_insert(group_views, groups->data, contact));
+        groups = g_slist_next(groups);
+    }
+
+    g_hash_table_replace(contact_index, contact, entry);
+}
+
+static void
+_index_remove(PContact contact)
+{
+    RosterIndexEntry *entry = g_hash_table_lookup(contact_index, contact);
+    if (entry == NULL) {
+        return;
+    }
+
+    g_sequence_remove(entry->ordered);
+    g_sequence_remove(entry->presence);
+    GSList *curr = entry->groups;
+    while (curr) {
+        g_sequence_remove(curr->data);
+        curr = g_slist_next(curr);
+    }
+
+    g_hash_table_remove(contact_index, contact);
+}
+
+static void
+_index_presence_changed(PContact contact)
+{
+    RosterIndexEntry *entry = g_hash_table_lookup(contact_index, contact);
+    if (entry == NULL) {
+        return;
+    }
+
+    const char *presence = p_contact_presence(contact);
+    if (g_strcmp0(presence, entry->presence_name) == 0) {
+        return;
+    }
+
+    g_sequence_remove(entry->presence);
+    free(entry->presence_name);
+    entry->presence_name = strdup(presence);
+    entry->presence = _view_insert(presence_views, entry->presence_name, contact);
+}
+
+static GSList*
+_view_to_list(GSequence *view)
+{
+    GSList *result = NULL;
+    if (view == NULL) {
+        return result;
+    }
+
+    // walk backwards so prepending keeps display order
+    GSequenceIter *curr = g_sequence_get_end_iter(view);
+    while (!g_sequence_iter_is_begin(curr)) {
+        curr = g_sequence_iter_prev(curr);
+        result = g_slist_prepend(result, g_sequence_get(curr));
+    }
+
     return result;
 }
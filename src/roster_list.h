@@ -41,12 +41,13 @@
 #include "contact.h"
 
 void roster_clear(void);
-gboolean roster_update_presence(const char * const barejid, Resource *resource,
+Resource * roster_update_presence(const char * const barejid, Resource *resource,
     GDateTime *last_activity);
 PContact roster_get_contact(const char * const barejid);
 gboolean roster_contact_offline(const char * const barejid,
     const char * const resource, const char * const status);
 void roster_reset_search_attempts(void);
+void roster_touch(const char * const barejid);
 void roster_init(void);
 void roster_free(void);
 void roster_change_name(PContact contact, const char * const new_name);
@@ -55,6 +56,8 @@ void roster_update(const char * const barejid, const char * const name,
     GSList *groups, const char * const subscription, gboolean pending_out);
 gboolean roster_add(const char * const barejid, const char * const name, GSList *groups,
     const char * const subscription, gboolean pending_out);
+void roster_add_bulk_begin(void);
+void roster_add_bulk_end(void);
 char * roster_barejid_from_name(const char * const name);
 GSList * roster_get_contacts(void);
 GSList * roster_get_contacts_online(void);
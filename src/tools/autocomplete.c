@@ -32,6 +32,7 @@
  *
  */
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,31 +41,144 @@
 #include "tools/autocomplete.h"
 #include "tools/parser.h"
 
+// trigram index for fuzzy completion, only kept for autocompleters
+// that opt in with autocomplete_set_fuzzy
+typedef struct fuzzy_index_t {
+    GHashTable *trigrams;
+    GHashTable *folded;
+    GHashTable *last_used;
+    guint clock;
+    GPtrArray *results;
+    guint current;
+} FuzzyIndex;
+
+typedef struct fuzzy_match_t {
+    char *item;
+    int score;
+    guint last_used;
+} FuzzyMatch;
+
+// items kept in a sorted array, items sharing a prefix are contiguous
+// and found with a binary search
+// a static autocompleter wraps a constant sorted base array, items added
+// at runtime go in the owned items array, indexes run through the base
+// first then the items
 struct autocomplete_t {
-    GSList *items;
-    GSList *last_found;
+    const char * const *base;
+    guint base_length;
+    char **items;
+    guint length;
+    guint allocated;
+    gint last_found;
     gchar *search_str;
+    size_t search_len;
+    FuzzyIndex *fuzzy;
 };
 
-static gchar * _search_from(Autocomplete ac, GSList *curr, gboolean quote);
+// most candidates scored per fuzzy search, bounds a tab press when the
+// query's rarest trigrams are common across the items
+#define FUZZY_MAX_CANDIDATES 512
+
+static gboolean fuzzy_enabled = FALSE;
+
+static guint _lower_bound(Autocomplete ac, const char * const item);
+static guint _base_lower_bound(Autocomplete ac, const char * const item);
+static gboolean _base_contains(Autocomplete ac, const char * const item);
+static char * _item_at(Autocomplete ac, guint index);
+static gchar * _search_first(Autocomplete ac, gboolean quote);
+static void _grow(Autocomplete ac, guint needed);
+static gchar * _search_from(Autocomplete ac, guint index, gboolean quote);
+static gchar * _search_merged(Autocomplete ac, guint base_index, guint items_index, gboolean quote);
+static gchar * _quote_item(const char * const item, gboolean quote);
+static FuzzyIndex * _fuzzy_new(void);
+static void _fuzzy_free(FuzzyIndex *fuzzy);
+static void _fuzzy_index_item(FuzzyIndex *fuzzy, char *item);
+static void _fuzzy_unindex_item(FuzzyIndex *fuzzy, char *item);
+static gboolean _fuzzy_search(Autocomplete ac, const char * const search_str);
 
 Autocomplete
 autocomplete_new(void)
 {
     Autocomplete new = malloc(sizeof(struct autocomplete_t));
+    new->base = NULL;
+    new->base_length = 0;
     new->items = NULL;
-    new->last_found = NULL;
+    new->length = 0;
+    new->allocated = 0;
+    new->last_found = -1;
     new->search_str = NULL;
+    new->search_len = 0;
+    new->fuzzy = NULL;
+
+    return new;
+}
+
+Autocomplete
+autocomplete_new_static(const char * const *items, guint length)
+{
+    guint i;
+    for (i = 1; i < length; i++) {
+        assert(strcmp(items[i-1], items[i]) < 0);
+    }
+
+    Autocomplete new = autocomplete_new();
+    new->base = items;
+    new->base_length = length;
 
     return new;
 }
 
+void
+autocomplete_fuzzy_enable(gboolean enabled)
+{
+    fuzzy_enabled = enabled;
+}
+
+void
+autocomplete_set_fuzzy(Autocomplete ac, gboolean fuzzy)
+{
+    if (fuzzy && ac->fuzzy == NULL) {
+        ac->fuzzy = _fuzzy_new();
+        guint i;
+        for (i = 0; i < ac->base_length + ac->length; i++) {
+            _fuzzy_index_item(ac->fuzzy, _item_at(ac, i));
+        }
+    } else if (!fuzzy && ac->fuzzy) {
+        _fuzzy_free(ac->fuzzy);
+        ac->fuzzy = NULL;
+    }
+}
+
+void
+autocomplete_touch(Autocomplete ac, const char * const item)
+{
+    if (ac && ac->fuzzy && item) {
+        g_hash_table_replace(ac->fuzzy->last_used, strdup(item),
+            GUINT_TO_POINTER(++ac->fuzzy->clock));
+    }
+}
+
 void
 autocomplete_clear(Autocomplete ac)
 {
     if (ac) {
-        g_slist_free_full(ac->items, free);
+        guint i;
+        for (i = 0; i < ac->length; i++) {
+            free(ac->items[i]);
+        }
+        free(ac->items);
         ac->items = NULL;
+        ac->length = 0;
+        ac->allocated = 0;
+
+        // recency is kept, items often come back after a reconnect
+        if (ac->fuzzy) {
+            g_hash_table_remove_all(ac->fuzzy->trigrams);
+            g_hash_table_remove_all(ac->fuzzy->folded);
+            for (i = 0; i < ac->base_length; i++) {
+                _fuzzy_index_item(ac->fuzzy, _item_at(ac, i));
+            }
+        }
 
         autocomplete_reset(ac);
     }
@@ -73,8 +187,14 @@ autocomplete_clear(Autocomplete ac)
 void
 autocomplete_reset(Autocomplete ac)
 {
-    ac->last_found = NULL;
+    ac->last_found = -1;
     FREE_SET_NULL(ac->search_str);
+    ac->search_len = 0;
+
+    if (ac->fuzzy && ac->fuzzy->results) {
+        g_ptr_array_free(ac->fuzzy->results, TRUE);
+        ac->fuzzy->results = NULL;
+    }
 }
 
 void
@@ -82,6 +202,9 @@ autocomplete_free(Autocomplete ac)
 {
     if (ac) {
         autocomplete_clear(ac);
+        if (ac->fuzzy) {
+            _fuzzy_free(ac->fuzzy);
+        }
         free(ac);
     }
 }
@@ -91,10 +214,8 @@ autocomplete_length(Autocomplete ac)
 {
     if (!ac) {
         return 0;
-    } else if (!ac->items) {
-        return 0;
     } else {
-        return g_slist_length(ac->items);
+        return ac->base_length + ac->length;
     }
 }
 
@@ -102,38 +223,107 @@ void
 autocomplete_add(Autocomplete ac, const char *item)
 {
     if (ac) {
-        char *item_cpy;
-        GSList *curr = g_slist_find_custom(ac->items, item, (GCompareFunc)strcmp);
+        guint index = _lower_bound(ac, item);
 
         // if item already exists
-        if (curr) {
+        if (index < ac->length && strcmp(ac->items[index], item) == 0) {
+            return;
+        }
+        if (_base_contains(ac, item)) {
             return;
         }
 
-        item_cpy = strdup(item);
-        ac->items = g_slist_insert_sorted(ac->items, item_cpy, (GCompareFunc)strcmp);
+        _grow(ac, ac->length + 1);
+        memmove(&ac->items[index + 1], &ac->items[index],
+            (ac->length - index) * sizeof(char *));
+        ac->items[index] = strdup(item);
+        ac->length++;
+        if (ac->fuzzy) {
+            _fuzzy_index_item(ac->fuzzy, ac->items[index]);
+        }
+
+        // keep last found pointing at the same item
+        if (ac->last_found >= (gint)(ac->base_length + index)) {
+            ac->last_found++;
+        }
     }
 
     return;
 }
 
+void
+autocomplete_add_all(Autocomplete ac, GSList *items)
+{
+    if (ac == NULL || items == NULL) {
+        return;
+    }
+
+    // sort a copy of the new items once, then merge into the sorted array
+    GSList *sorted = g_slist_sort(g_slist_copy(items), (GCompareFunc)strcmp);
+    guint merged_allocated = ac->length + g_slist_length(sorted);
+    char **merged = malloc(merged_allocated * sizeof(char *));
+    guint merged_len = 0;
+    guint curr_old = 0;
+    GSList *curr_new = sorted;
+    char *last = NULL;
+
+    while (curr_old < ac->length || curr_new) {
+        char *next = NULL;
+        if (curr_new == NULL || (curr_old < ac->length && strcmp(ac->items[curr_old], curr_new->data) <= 0)) {
+            next = ac->items[curr_old++];
+        } else {
+            next = curr_new->data;
+            curr_new = g_slist_next(curr_new);
+            if (last && strcmp(last, next) == 0) {
+                continue;
+            }
+            if (_base_contains(ac, next)) {
+                continue;
+            }
+            next = strdup(next);
+            if (ac->fuzzy) {
+                _fuzzy_index_item(ac->fuzzy, next);
+            }
+        }
+
+        merged[merged_len++] = next;
+        last = next;
+    }
+
+    g_slist_free(sorted);
+    free(ac->items);
+    ac->items = merged;
+    ac->length = merged_len;
+    ac->allocated = merged_allocated;
+    autocomplete_reset(ac);
+}
+
 void
 autocomplete_remove(Autocomplete ac, const char * const item)
 {
     if (ac) {
-        GSList *curr = g_slist_find_custom(ac->items, item, (GCompareFunc)strcmp);
+        guint index = _lower_bound(ac, item);
 
-        if (!curr) {
+        // items in the static base are never removed
+        if (index >= ac->length || strcmp(ac->items[index], item) != 0) {
             return;
         }
 
         // reset last found if it points to the item to be removed
-        if (ac->last_found == curr) {
-            ac->last_found = NULL;
+        gint removed = ac->base_length + index;
+        if (ac->last_found == removed) {
+            ac->last_found = -1;
+        } else if (ac->last_found > removed) {
+            ac->last_found--;
         }
 
-        free(curr->data);
-        ac->items = g_slist_delete_link(ac->items, curr);
+        if (ac->fuzzy) {
+            _fuzzy_unindex_item(ac->fuzzy, ac->items[index]);
+        }
+        free(ac->items[index]);
+        memmove(&ac->items[index], &ac->items[index + 1],
+            (ac->length - index - 1) * sizeof(char *));
+        ac->length--;
     }
 
     return;
@@ -143,11 +333,18 @@ GSList *
 autocomplete_create_list(Autocomplete ac)
 {
     GSList *copy = NULL;
-    GSList *curr = ac->items;
-
-    while(curr) {
-        copy = g_slist_append(copy, strdup(curr->data));
-        curr = g_slist_next(curr);
+    guint curr_base = ac->base_length;
+    guint curr_items = ac->length;
+
+    // merge base and items from the end, prepending keeps the list sorted
+    while (curr_base > 0 || curr_items > 0) {
+        const char *item = NULL;
+        if (curr_items == 0 || (curr_base > 0 && strcmp(ac->base[curr_base - 1], ac->items[curr_items - 1]) > 0)) {
+            item = ac->base[--curr_base];
+        } else {
+            item = ac->items[--curr_items];
+        }
+        copy = g_slist_prepend(copy, strdup(item));
     }
 
     return copy;
@@ -156,16 +353,13 @@ autocomplete_create_list(Autocomplete ac)
 gboolean
 autocomplete_contains(Autocomplete ac, const char *value)
 {
-    GSList *curr = ac->items;
+    guint index = _lower_bound(ac, value);
 
-    while(curr) {
-        if (strcmp(curr->data, value) == 0) {
-            return TRUE;
-        }
-        curr = g_slist_next(curr);
+    if (index < ac->length && strcmp(ac->items[index], value) == 0) {
+        return TRUE;
     }
 
-    return FALSE;
+    return _base_contains(ac, value);
 }
 
 gchar *
@@ -179,31 +373,58 @@ autocomplete_complete(Autocomplete ac, const gchar *search_str, gboolean quote)
     }
 
     // no items to search
-    if (!ac->items) {
+    if (ac->base_length + ac->length == 0) {
         return NULL;
     }
 
+    // subsequent fuzzy search attempt, cycle through the ranked matches
+    if (ac->fuzzy && ac->fuzzy->results) {
+        if (ac->fuzzy->results->len == 0) {
+            autocomplete_reset(ac);
+            return NULL;
+        }
+        ac->fuzzy->current = (ac->fuzzy->current + 1) % ac->fuzzy->results->len;
+        return _quote_item(g_ptr_array_index(ac->fuzzy->results, ac->fuzzy->current), quote);
+    }
+
+    // first fuzzy search attempt, falls back to prefix search with no matches
+    if (fuzzy_enabled && ac->fuzzy && ac->last_found == -1) {
+        if (_fuzzy_search(ac, search_str)) {
+            ac->fuzzy->current = 0;
+            return _quote_item(g_ptr_array_index(ac->fuzzy->results, 0), quote);
+        }
+    }
+
     // first search attempt
-    if (!ac->last_found) {
+    if (ac->last_found == -1) {
         if (ac->search_str) {
             FREE_SET_NULL(ac->search_str);
         }
 
         ac->search_str = strdup(search_str);
-        found = _search_from(ac, ac->items, quote);
+        ac->search_len = strlen(search_str);
+        found = _search_first(ac, quote);
 
         return found;
 
     // subsequent search attempt
     } else {
-        // search from here+1 to end
-        found = _search_from(ac, g_slist_next(ac->last_found), quote);
+        // base and items never share an entry, the next match in sorted
+        // order follows the last found in its own array and is the first
+        // after it in the other
+        const char *last = _item_at(ac, ac->last_found);
+        if (ac->last_found < (gint)ac->base_length) {
+            found = _search_merged(ac, ac->last_found + 1, _lower_bound(ac, last), quote);
+        } else {
+            found = _search_merged(ac, _base_lower_bound(ac, last),
+                ac->last_found - ac->base_length + 1, quote);
+        }
         if (found) {
             return found;
         }
 
-        // search from beginning
-        found = _search_from(ac, ac->items, quote);
+        // search from first match
+        found = _search_first(ac, quote);
         if (found) {
             return found;
         }
@@ -309,36 +530,337 @@ autocomplete_param_no_with_func(const char * const input, char *command, int arg
     return NULL;
 }
 
+static guint
+_lower_bound(Autocomplete ac, const char * const item)
+{
+    guint low = 0;
+    guint high = ac->length;
+
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        if (strcmp(ac->items[mid], item) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static guint
+_base_lower_bound(Autocomplete ac, const char * const item)
+{
+    guint low = 0;
+    guint high = ac->base_length;
+
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        if (strcmp(ac->base[mid], item) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+static gboolean
+_base_contains(Autocomplete ac, const char * const item)
+{
+    guint index = _base_lower_bound(ac, item);
+
+    return (index < ac->base_length && strcmp(ac->base[index], item) == 0);
+}
+
+static char *
+_item_at(Autocomplete ac, guint index)
+{
+    // base items are never written through, only compared and copied
+    if (index < ac->base_length) {
+        return (char *)ac->base[index];
+    } else {
+        return ac->items[index - ac->base_length];
+    }
+}
+
+static void
+_grow(Autocomplete ac, guint needed)
+{
+    if (needed <= ac->allocated) {
+        return;
+    }
+
+    guint allocated = ac->allocated ? ac->allocated * 2 : 16;
+    while (allocated < needed) {
+        allocated *= 2;
+    }
+    ac->items = realloc(ac->items, allocated * sizeof(char *));
+    ac->allocated = allocated;
+}
+
+static gchar *
+_search_from(Autocomplete ac, guint index, gboolean quote)
+{
+    if (index >= ac->base_length + ac->length) {
+        return NULL;
+    }
+
+    char *item = _item_at(ac, index);
+
+    // no match
+    if (strncmp(item, ac->search_str, ac->search_len) != 0) {
+        return NULL;
+    }
+
+    // set index of last found
+    ac->last_found = index;
+
+    return _quote_item(item, quote);
+}
+
+// the lesser of the base item at base_index and the added item at
+// items_index, when it matches the search
+static gchar *
+_search_merged(Autocomplete ac, guint base_index, guint items_index, gboolean quote)
+{
+    if (base_index >= ac->base_length) {
+        return _search_from(ac, ac->base_length + items_index, quote);
+    }
+    if (items_index >= ac->length || strcmp(ac->base[base_index], ac->items[items_index]) < 0) {
+        return _search_from(ac, base_index, quote);
+    } else {
+        return _search_from(ac, ac->base_length + items_index, quote);
+    }
+}
+
+static gchar *
+_search_first(Autocomplete ac, gboolean quote)
+{
+    return _search_merged(ac, _base_lower_bound(ac, ac->search_str),
+        _lower_bound(ac, ac->search_str), quote);
+}
+
 static gchar *
-_search_from(Autocomplete ac, GSList *curr, gboolean quote)
+_quote_item(const char * const item, gboolean quote)
+{
+    // if contains space, quote before returning
+    if (quote && g_strrstr(item, " ")) {
+        GString *quoted = g_string_new("\"");
+        g_string_append(quoted, item);
+        g_string_append(quoted, "\"");
+
+        gchar *result = quoted->str;
+        g_string_free(quoted, FALSE);
+
+        return result;
+
+    // otherwise just return the string
+    } else {
+        return strdup(item);
+    }
+}
+
+static FuzzyIndex *
+_fuzzy_new(void)
+{
+    FuzzyIndex *fuzzy = malloc(sizeof(FuzzyIndex));
+    fuzzy->trigrams = g_hash_table_new_full(g_str_hash, g_str_equal, free,
+        (GDestroyNotify)g_ptr_array_unref);
+    fuzzy->folded = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    fuzzy->last_used = g_hash_table_new_full(g_str_hash, g_str_equal, free, NULL);
+    fuzzy->clock = 0;
+    fuzzy->results = NULL;
+    fuzzy->current = 0;
+
+    return fuzzy;
+}
+
+static void
+_fuzzy_free(FuzzyIndex *fuzzy)
+{
+    g_hash_table_destroy(fuzzy->trigrams);
+    g_hash_table_destroy(fuzzy->folded);
+    g_hash_table_destroy(fuzzy->last_used);
+    if (fuzzy->results) {
+        g_ptr_array_free(fuzzy->results, TRUE);
+    }
+    free(fuzzy);
+}
+
+static void
+_fuzzy_index_item(FuzzyIndex *fuzzy, char *item)
+{
+    gchar *folded = g_utf8_casefold(item, -1);
+    g_hash_table_insert(fuzzy->folded, item, folded);
+
+    size_t len = strlen(folded);
+    size_t i;
+    for (i = 0; i + 3 <= len; i++) {
+        char trigram[4] = { folded[i], folded[i+1], folded[i+2], '\0' };
+        GPtrArray *posting = g_hash_table_lookup(fuzzy->trigrams, trigram);
+        if (posting == NULL) {
+            posting = g_ptr_array_new();
+            g_hash_table_insert(fuzzy->trigrams, strdup(trigram), posting);
+        }
+
+        // trigram repeated within this item
+        if (posting->len > 0 && g_ptr_array_index(posting, posting->len - 1) == item) {
+            continue;
+        }
+        g_ptr_array_add(posting, item);
+    }
+}
+
+static void
+_fuzzy_unindex_item(FuzzyIndex *fuzzy, char *item)
+{
+    gchar *folded = g_hash_table_lookup(fuzzy->folded, item);
+    if (folded == NULL) {
+        return;
+    }
+
+    size_t len = strlen(folded);
+    size_t i;
+    for (i = 0; i + 3 <= len; i++) {
+        char trigram[4] = { folded[i], folded[i+1], folded[i+2], '\0' };
+        GPtrArray *posting = g_hash_table_lookup(fuzzy->trigrams, trigram);
+        if (posting) {
+            g_ptr_array_remove_fast(posting, item);
+        }
+    }
+    g_hash_table_remove(fuzzy->folded, item);
+
+    // drop from the current ranked matches, keeping the cycle position
+    if (fuzzy->results) {
+        guint j;
+        for (j = 0; j < fuzzy->results->len; j++) {
+            if (g_ptr_array_index(fuzzy->results, j) == item) {
+                g_ptr_array_remove_index(fuzzy->results, j);
+                if (j < fuzzy->current) {
+                    fuzzy->current--;
+                } else if (j == fuzzy->current && fuzzy->results->len > 0) {
+                    // next tab press lands on the match after the removed one
+                    fuzzy->current = (j == 0) ? fuzzy->results->len - 1 : j - 1;
+                }
+                break;
+            }
+        }
+    }
+}
+
+static gint
+_fuzzy_compare_matches(gconstpointer a, gconstpointer b)
 {
-    while(curr) {
+    const FuzzyMatch *match_a = a;
+    const FuzzyMatch *match_b = b;
 
-        // match found
-        if (strncmp(curr->data, ac->search_str, strlen(ac->search_str)) == 0) {
+    if (match_a->score != match_b->score) {
+        return match_b->score - match_a->score;
+    }
+    if (match_a->last_used != match_b->last_used) {
+        return match_a->last_used > match_b->last_used ? -1 : 1;
+    }
 
-            // set pointer to last found
-            ac->last_found = curr;
+    return strcmp(match_a->item, match_b->item);
+}
 
-            // if contains space, quote before returning
-            if (quote && g_strrstr(curr->data, " ")) {
-                GString *quoted = g_string_new("\"");
-                g_string_append(quoted, curr->data);
-                g_string_append(quoted, "\"");
+static gboolean
+_fuzzy_search(Autocomplete ac, const char * const search_str)
+{
+    FuzzyIndex *fuzzy = ac->fuzzy;
+    gchar *query = g_utf8_casefold(search_str, -1);
+    size_t query_len = strlen(query);
+
+    // too short for trigrams, leave it to prefix search
+    if (query_len < 3) {
+        g_free(query);
+        return FALSE;
+    }
 
-                gchar *result = quoted->str;
-                g_string_free(quoted, FALSE);
+    // candidates come from the two rarest query trigrams, so one typo
+    // does not lose the item
+    int num_trigrams = query_len - 2;
+    GPtrArray *rarest = NULL;
+    GPtrArray *second = NULL;
+    int i;
+    for (i = 0; i < num_trigrams; i++) {
+        char trigram[4] = { query[i], query[i+1], query[i+2], '\0' };
+        GPtrArray *posting = g_hash_table_lookup(fuzzy->trigrams, trigram);
+        if (posting == NULL || posting->len == 0) {
+            continue;
+        }
+        if (rarest == NULL || posting->len < rarest->len) {
+            second = rarest;
+            rarest = posting;
+        } else if (posting != rarest && (second == NULL || posting->len < second->len)) {
+            second = posting;
+        }
+    }
 
-                return result;
+    GArray *matches = g_array_new(FALSE, FALSE, sizeof(FuzzyMatch));
+    GHashTable *seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+    GPtrArray *postings[2] = { rarest, second };
+    int p;
+    for (p = 0; p < 2; p++) {
+        if (postings[p] == NULL) {
+            continue;
+        }
+        guint j;
+        for (j = 0; j < postings[p]->len; j++) {
+            if (g_hash_table_size(seen) == FUZZY_MAX_CANDIDATES) {
+                break;
+            }
+            char *item = g_ptr_array_index(postings[p], j);
+            if (g_hash_table_lookup(seen, item)) {
+                continue;
+            }
+            g_hash_table_insert(seen, item, item);
+
+            // score on shared trigrams, then on prefix and substring matches
+            const char *folded = g_hash_table_lookup(fuzzy->folded, item);
+            int shared = 0;
+            for (i = 0; i < num_trigrams; i++) {
+                char trigram[4] = { query[i], query[i+1], query[i+2], '\0' };
+                if (strstr(folded, trigram)) {
+                    shared++;
+                }
+            }
+            if (shared * 2 < num_trigrams) {
+                continue;
+            }
 
-            // otherwise just return the string
-            } else {
-                return strdup(curr->data);
+            FuzzyMatch match;
+            match.item = item;
+            match.score = (shared * 100) / num_trigrams;
+            if (strncmp(folded, query, query_len) == 0) {
+                match.score += 100;
+            } else if (strstr(folded, query)) {
+                match.score += 50;
             }
+            match.last_used = GPOINTER_TO_UINT(g_hash_table_lookup(fuzzy->last_used, item));
+            g_array_append_val(matches, match);
         }
+    }
+    g_hash_table_destroy(seen);
+    g_free(query);
 
-        curr = g_slist_next(curr);
+    if (matches->len == 0) {
+        g_array_free(matches, TRUE);
+        return FALSE;
     }
 
-    return NULL;
+    g_array_sort(matches, _fuzzy_compare_matches);
+    if (fuzzy->results) {
+        g_ptr_array_free(fuzzy->results, TRUE);
+    }
+    fuzzy->results = g_ptr_array_sized_new(matches->len);
+    guint j;
+    for (j = 0; j < matches->len; j++) {
+        g_ptr_array_add(fuzzy->results, g_array_index(matches, FuzzyMatch, j).item);
+    }
+    g_array_free(matches, TRUE);
+
+    return TRUE;
 }
@@ -43,6 +43,17 @@ typedef struct autocomplete_t *Autocomplete;
 // allocate new autocompleter with no items
 Autocomplete autocomplete_new(void);
 
+// allocate new autocompleter over a constant array sorted by strcmp, the
+// array is not copied and must outlive the autocompleter, added items are
+// kept alongside it
+Autocomplete autocomplete_new_static(const char * const *items, guint length);
+
+// fuzzy completion, ranked by trigram similarity and recent use, applies
+// to autocompleters with fuzzy set while enabled
+void autocomplete_fuzzy_enable(gboolean enabled);
+void autocomplete_set_fuzzy(Autocomplete ac, gboolean fuzzy);
+void autocomplete_touch(Autocomplete ac, const char * const item);
+
 // Remove all items from the autocompleter
 void autocomplete_clear(Autocomplete ac);
 
@@ -50,6 +61,9 @@ void autocomplete_clear(Autocomplete ac);
 void autocomplete_free(Autocomplete ac);
 
 void autocomplete_add(Autocomplete ac, const char *item);
+
+// add many items at once, faster than adding them one by one
+void autocomplete_add_all(Autocomplete ac, GSList *items);
 void autocomplete_remove(Autocomplete ac, const char * const item);
 
 // find the next item prefixed with search string
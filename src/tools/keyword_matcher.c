@@ -0,0 +1,246 @@
+/*
+ * keyword_matcher.c
+ *
+ * Copyright (C) 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "tools/keyword_matcher.h"
+
+// Aho-Corasick automaton over lowercased unicode characters, the edges of
+// each state are sorted by character and found with a binary search
+typedef struct matcher_edge_t {
+    gunichar ch;
+    guint target;
+} MatcherEdge;
+
+typedef struct matcher_state_t {
+    guint first_edge;
+    guint num_edges;
+    guint fail;
+    gboolean output;
+} MatcherState;
+
+struct keyword_matcher_t {
+    MatcherState *states;
+    guint num_states;
+    MatcherEdge *edges;
+};
+
+static gint _compare_edges(gconstpointer a, gconstpointer b);
+static guint _trie_child(GArray *edges, gunichar ch);
+static gint _goto(KeywordMatcher matcher, guint state, gunichar ch);
+
+KeywordMatcher
+keyword_matcher_new(GList *keywords)
+{
+    // build the trie, edges kept per state while building
+    GArray *outputs = g_array_new(FALSE, TRUE, sizeof(gboolean));
+    GPtrArray *trie_edges = g_ptr_array_new();
+    gboolean no_output = FALSE;
+    g_array_append_val(outputs, no_output);
+    g_ptr_array_add(trie_edges, g_array_new(FALSE, FALSE, sizeof(MatcherEdge)));
+
+    GList *curr = keywords;
+    while (curr) {
+        const char *keyword = curr->data;
+        if (keyword && keyword[0] != '\0') {
+            guint state = 0;
+            const char *p = keyword;
+            while (*p) {
+                gunichar ch = g_unichar_tolower(g_utf8_get_char(p));
+                GArray *edges = g_ptr_array_index(trie_edges, state);
+                guint next = _trie_child(edges, ch);
+                if (next == 0) {
+                    next = outputs->len;
+                    MatcherEdge edge = { ch, next };
+                    g_array_append_val(edges, edge);
+                    g_array_append_val(outputs, no_output);
+                    g_ptr_array_add(trie_edges, g_array_new(FALSE, FALSE, sizeof(MatcherEdge)));
+                }
+                state = next;
+                p = g_utf8_next_char(p);
+            }
+            g_array_index(outputs, gboolean, state) = TRUE;
+        }
+        curr = g_list_next(curr);
+    }
+
+    // flatten into one sorted edge array
+    KeywordMatcher matcher = malloc(sizeof(struct keyword_matcher_t));
+    matcher->num_states = outputs->len;
+    matcher->states = malloc(matcher->num_states * sizeof(MatcherState));
+    guint num_edges = matcher->num_states - 1;
+    matcher->edges = malloc((num_edges > 0 ? num_edges : 1) * sizeof(MatcherEdge));
+
+    guint first_edge = 0;
+    guint i;
+    for (i = 0; i < matcher->num_states; i++) {
+        GArray *edges = g_ptr_array_index(trie_edges, i);
+        g_array_sort(edges, _compare_edges);
+        if (edges->len > 0) {
+            memcpy(&matcher->edges[first_edge], edges->data, edges->len * sizeof(MatcherEdge));
+        }
+        matcher->states[i].first_edge = first_edge;
+        matcher->states[i].num_edges = edges->len;
+        matcher->states[i].fail = 0;
+        matcher->states[i].output = g_array_index(outputs, gboolean, i);
+        first_edge += edges->len;
+        g_array_free(edges, TRUE);
+    }
+    g_ptr_array_free(trie_edges, TRUE);
+    g_array_free(outputs, TRUE);
+
+    // failure links, breadth first so shorter suffixes are resolved first
+    guint *queue = malloc(matcher->num_states * sizeof(guint));
+    guint head = 0;
+    guint tail = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+        guint state = queue[head++];
+        MatcherState *from = &matcher->states[state];
+        guint e;
+        for (e = from->first_edge; e < from->first_edge + from->num_edges; e++) {
+            MatcherEdge *edge = &matcher->edges[e];
+            guint fail = 0;
+            if (state != 0) {
+                guint f = from->fail;
+                gint next = _goto(matcher, f, edge->ch);
+                while (next < 0 && f != 0) {
+                    f = matcher->states[f].fail;
+                    next = _goto(matcher, f, edge->ch);
+                }
+                fail = next < 0 ? 0 : (guint)next;
+            }
+            MatcherState *to = &matcher->states[edge->target];
+            to->fail = fail;
+            to->output = to->output || matcher->states[fail].output;
+            queue[tail++] = edge->target;
+        }
+    }
+    free(queue);
+
+    return matcher;
+}
+
+void
+keyword_matcher_free(KeywordMatcher matcher)
+{
+    if (matcher) {
+        free(matcher->states);
+        free(matcher->edges);
+        free(matcher);
+    }
+}
+
+gboolean
+keyword_matcher_match(KeywordMatcher matcher, const char * const text)
+{
+    if (matcher == NULL || text == NULL || matcher->num_states == 1) {
+        return FALSE;
+    }
+
+    guint state = 0;
+    const char *p = text;
+    while (*p) {
+        gunichar ch = g_unichar_tolower(g_utf8_get_char(p));
+        gint next = _goto(matcher, state, ch);
+        while (next < 0 && state != 0) {
+            state = matcher->states[state].fail;
+            next = _goto(matcher, state, ch);
+        }
+        state = next < 0 ? 0 : (guint)next;
+        if (matcher->states[state].output) {
+            return TRUE;
+        }
+        p = g_utf8_next_char(p);
+    }
+
+    return FALSE;
+}
+
+static gint
+_compare_edges(gconstpointer a, gconstpointer b)
+{
+    gunichar ch_a = ((const MatcherEdge *)a)->ch;
+    gunichar ch_b = ((const MatcherEdge *)b)->ch;
+
+    if (ch_a < ch_b) {
+        return -1;
+    } else if (ch_a > ch_b) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+// child of a state while the trie is built, 0 when there is none
+static guint
+_trie_child(GArray *edges, gunichar ch)
+{
+    guint i;
+    for (i = 0; i < edges->len; i++) {
+        MatcherEdge *edge = &g_array_index(edges, MatcherEdge, i);
+        if (edge->ch == ch) {
+            return edge->target;
+        }
+    }
+
+    return 0;
+}
+
+// transition from a compiled state, -1 when there is none
+static gint
+_goto(KeywordMatcher matcher, guint state, gunichar ch)
+{
+    guint low = matcher->states[state].first_edge;
+    guint high = low + matcher->states[state].num_edges;
+
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        if (matcher->edges[mid].ch < ch) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low < matcher->states[state].first_edge + matcher->states[state].num_edges &&
+            matcher->edges[low].ch == ch) {
+        return matcher->edges[low].target;
+    } else {
+        return -1;
+    }
+}
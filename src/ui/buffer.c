@@ -53,21 +53,53 @@
 
 struct prof_buff_t {
     GSList *entries;
+    GByteArray *packed;
+    guint packed_head;
+    int packed_count;
 };
 
+// fixed part of an entry in the packed arena, followed by from, message and receipt id bytes
+typedef struct packed_entry_t {
+    gint64 time;
+    gint64 utc_offset;
+    gint32 usec;
+    gint32 pad_indent;
+    gint32 flags;
+    gint32 theme_item;
+    guint32 from_len;
+    guint32 message_len;
+    guint32 id_len;
+    char show_char;
+    char receipt;
+} PackedEntry;
+
+#define PACKED_NO_RECEIPT   0
+#define PACKED_PENDING      1
+#define PACKED_RECEIVED     2
+
 static void _free_entry(ProfBuffEntry *entry);
+static void _pack_entry(GByteArray *packed, const char show_char, int pad_indent, GDateTime *time, int flags,
+    theme_item_t theme_item, const char * const from, const char * const message, DeliveryReceipt *receipt);
+static ProfBuffEntry* _unpack_entry(const guint8 *data, PackedEntry *header);
+static GDateTime* _unpack_time(PackedEntry *header);
+static char* _packed_strdup(const char *str, guint32 len);
+static guint _packed_entry_size(const guint8 *data);
 
 ProfBuff
 buffer_create()
 {
     ProfBuff new_buff = malloc(sizeof(struct prof_buff_t));
     new_buff->entries = NULL;
+    new_buff->packed = NULL;
+    new_buff->packed_head = 0;
+    new_buff->packed_count = 0;
     return new_buff;
 }
 
 int
 buffer_size(ProfBuff buffer)
 {
+    buffer_unpack(buffer);
     return g_slist_length(buffer->entries);
 }
 
@@ -75,14 +107,114 @@ void
 buffer_free(ProfBuff buffer)
 {
     g_slist_free_full(buffer->entries, (GDestroyNotify)_free_entry);
+    if (buffer->packed) {
+        g_byte_array_free(buffer->packed, TRUE);
+    }
     free(buffer);
     buffer = NULL;
 }
 
+void
+buffer_pack(ProfBuff buffer)
+{
+    if (buffer->packed) {
+        return;
+    }
+
+    buffer->packed = g_byte_array_new();
+    buffer->packed_head = 0;
+    buffer->packed_count = 0;
+
+    GSList *curr = buffer->entries;
+    while (curr) {
+        ProfBuffEntry *e = curr->data;
+        _pack_entry(buffer->packed, e->show_char, e->pad_indent, e->time, e->flags, e->theme_item, e->from,
+            e->message, e->receipt);
+        buffer->packed_count++;
+        curr = g_slist_next(curr);
+    }
+
+    g_slist_free_full(buffer->entries, (GDestroyNotify)_free_entry);
+    buffer->entries = NULL;
+}
+
+void
+buffer_unpack(ProfBuff buffer)
+{
+    if (!buffer->packed) {
+        return;
+    }
+
+    guint offset = buffer->packed_head;
+    GSList *entries = NULL;
+
+    while (offset < buffer->packed->len) {
+        PackedEntry header;
+        memcpy(&header, buffer->packed->data + offset, sizeof(PackedEntry));
+        entries = g_slist_prepend(entries, _unpack_entry(buffer->packed->data + offset, &header));
+        offset += _packed_entry_size(buffer->packed->data + offset);
+    }
+
+    buffer->entries = g_slist_reverse(entries);
+    g_byte_array_free(buffer->packed, TRUE);
+    buffer->packed = NULL;
+    buffer->packed_head = 0;
+    buffer->packed_count = 0;
+}
+
+gboolean
+buffer_is_packed(ProfBuff buffer)
+{
+    return buffer->packed != NULL;
+}
+
+gsize
+buffer_mem_size(ProfBuff buffer)
+{
+    if (buffer->packed) {
+        return sizeof(struct prof_buff_t) + buffer->packed->len;
+    }
+
+    gsize result = sizeof(struct prof_buff_t);
+    GSList *curr = buffer->entries;
+    while (curr) {
+        ProfBuffEntry *e = curr->data;
+        result += sizeof(GSList) + sizeof(struct prof_buff_entry_t) + strlen(e->from) + strlen(e->message) + 2;
+        if (e->receipt) {
+            result += sizeof(struct delivery_receipt_t) + strlen(e->receipt->id) + 1;
+        }
+        curr = g_slist_next(curr);
+    }
+
+    return result;
+}
+
 void
 buffer_push(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *time,
     int flags, theme_item_t theme_item, const char * const from, const char * const message, DeliveryReceipt *receipt)
 {
+    // append straight to the arena, dropping the oldest entry when full
+    if (buffer->packed) {
+        _pack_entry(buffer->packed, show_char, pad_indent, time, flags, theme_item, from, message, receipt);
+        buffer->packed_count++;
+        if (receipt) {
+            free(receipt->id);
+            free(receipt);
+        }
+
+        if (buffer->packed_count > BUFF_SIZE) {
+            buffer->packed_head += _packed_entry_size(buffer->packed->data + buffer->packed_head);
+            buffer->packed_count--;
+
+            // reclaim dropped entries once they make up half the arena
+            if (buffer->packed_head > buffer->packed->len / 2) {
+                g_byte_array_remove_range(buffer->packed, 0, buffer->packed_head);
+                buffer->packed_head = 0;
+            }
+        }
+        return;
+    }
+
     ProfBuffEntry *e = malloc(sizeof(struct prof_buff_entry_t));
     e->show_char = show_char;
     e->pad_indent = pad_indent;
@@ -104,6 +236,27 @@ buffer_push(ProfBuff buffer, const char show_char, int pad_indent, GDateTime *ti
 gboolean
 buffer_mark_received(ProfBuff buffer, const char * const id)
 {
+    if (buffer->packed) {
+        size_t id_len = strlen(id);
+        guint offset = buffer->packed_head;
+        while (offset < buffer->packed->len) {
+            guint8 *data = buffer->packed->data + offset;
+            PackedEntry header;
+            memcpy(&header, data, sizeof(PackedEntry));
+            if (header.receipt != PACKED_NO_RECEIPT && header.id_len == id_len &&
+                    memcmp(data + sizeof(PackedEntry) + header.from_len + header.message_len, id, id_len) == 0) {
+                if (header.receipt == PACKED_PENDING) {
+                    header.receipt = PACKED_RECEIVED;
+                    memcpy(data, &header, sizeof(PackedEntry));
+                    return TRUE;
+                }
+            }
+            offset += _packed_entry_size(data);
+        }
+
+        return FALSE;
+    }
+
     GSList *entries = buffer->entries;
     while (entries) {
         ProfBuffEntry *entry = entries->data;
@@ -122,6 +275,7 @@ buffer_mark_received(ProfBuff buffer, const char * const id)
 ProfBuffEntry*
 buffer_yield_entry(ProfBuff buffer, int entry)
 {
+    buffer_unpack(buffer);
     GSList *node = g_slist_nth(buffer->entries, entry);
     return node->data;
 }
@@ -138,3 +292,109 @@ _free_entry(ProfBuffEntry *entry)
     }
     free(entry);
 }
+
+static void
+_pack_entry(GByteArray *packed, const char show_char, int pad_indent, GDateTime *time, int flags,
+    theme_item_t theme_item, const char * const from, const char * const message, DeliveryReceipt *receipt)
+{
+    PackedEntry header;
+    memset(&header, 0, sizeof(PackedEntry));
+    header.time = g_date_time_to_unix(time);
+    header.usec = g_date_time_get_microsecond(time);
+    header.utc_offset = g_date_time_get_utc_offset(time);
+    header.pad_indent = pad_indent;
+    header.flags = flags;
+    header.theme_item = theme_item;
+    header.show_char = show_char;
+    header.from_len = strlen(from);
+    header.message_len = strlen(message);
+    if (receipt) {
+        header.receipt = receipt->received ? PACKED_RECEIVED : PACKED_PENDING;
+        header.id_len = strlen(receipt->id);
+    } else {
+        header.receipt = PACKED_NO_RECEIPT;
+        header.id_len = 0;
+    }
+
+    g_byte_array_append(packed, (guint8 *)&header, sizeof(PackedEntry));
+    g_byte_array_append(packed, (const guint8 *)from, header.from_len);
+    g_byte_array_append(packed, (const guint8 *)message, header.message_len);
+    if (receipt) {
+        g_byte_array_append(packed, (const guint8 *)receipt->id, header.id_len);
+    }
+}
+
+static ProfBuffEntry*
+_unpack_entry(const guint8 *data, PackedEntry *header)
+{
+    const char *from = (const char *)data + sizeof(PackedEntry);
+    const char *message = from + header->from_len;
+    const char *id = message + header->message_len;
+
+    ProfBuffEntry *e = malloc(sizeof(struct prof_buff_entry_t));
+    e->show_char = header->show_char;
+    e->pad_indent = header->pad_indent;
+    e->flags = header->flags;
+    e->theme_item = header->theme_item;
+    e->time = _unpack_time(header);
+    e->from = _packed_strdup(from, header->from_len);
+    e->message = _packed_strdup(message, header->message_len);
+    if (header->receipt != PACKED_NO_RECEIPT) {
+        e->receipt = malloc(sizeof(struct delivery_receipt_t));
+        e->receipt->id = _packed_strdup(id, header->id_len);
+        e->receipt->received = header->receipt == PACKED_RECEIVED;
+    } else {
+        e->receipt = NULL;
+    }
+
+    return e;
+}
+
+// restore the instant in the offset it was recorded with
+static GDateTime*
+_unpack_time(PackedEntry *header)
+{
+    GDateTime *utc = g_date_time_new_from_unix_utc(header->time);
+    GDateTime *result = g_date_time_add(utc, header->usec);
+    g_date_time_unref(utc);
+    if (header->utc_offset == 0) {
+        return result;
+    }
+
+    GDateTime *local = g_date_time_to_local(result);
+    if (g_date_time_get_utc_offset(local) == header->utc_offset) {
+        g_date_time_unref(result);
+        return local;
+    }
+    g_date_time_unref(local);
+
+    gint64 offset_mins = header->utc_offset / G_TIME_SPAN_MINUTE;
+    char *identifier = g_strdup_printf("%c%02d:%02d", offset_mins < 0 ? '-' : '+',
+        (int)(ABS(offset_mins) / 60), (int)(ABS(offset_mins) % 60));
+    GTimeZone *tz = g_time_zone_new(identifier);
+    GDateTime *zoned = g_date_time_to_timezone(result, tz);
+    g_time_zone_unref(tz);
+    g_free(identifier);
+    g_date_time_unref(result);
+
+    return zoned;
+}
+
+static guint
+_packed_entry_size(const guint8 *data)
+{
+    PackedEntry header;
+    memcpy(&header, data, sizeof(PackedEntry));
+
+    return sizeof(PackedEntry) + header.from_len + header.message_len + header.id_len;
+}
+
+static char*
+_packed_strdup(const char *str, guint32 len)
+{
+    char *result = malloc(len + 1);
+    memcpy(result, str, len);
+    result[len] = '\0';
+
+    return result;
+}
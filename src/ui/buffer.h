@@ -65,6 +65,10 @@ void buffer_push(ProfBuff buffer, const char show_char, int pad_indent, GDateTim
 int buffer_size(ProfBuff buffer);
 ProfBuffEntry* buffer_yield_entry(ProfBuff buffer, int entry);
 gboolean buffer_mark_received(ProfBuff buffer, const char * const id);
+void buffer_pack(ProfBuff buffer);
+void buffer_unpack(ProfBuff buffer);
+gboolean buffer_is_packed(ProfBuff buffer);
+gsize buffer_mem_size(ProfBuff buffer);
 
 
 #endif
@@ -412,7 +412,7 @@ cons_show_caps(const char * const fulljid, resource_presence_t presence)
                 feature = g_slist_next(feature);
             }
         }
-        caps_destroy(caps);
+        caps_unref(caps);
 
     } else {
         cons_show("No capabilities found for %s", fulljid);
@@ -836,7 +836,7 @@ cons_show_account(ProfAccount *account)
                 if (caps->os || caps->os_version) {
                     win_newline(console);
                 }
-                caps_destroy(caps);
+                caps_unref(caps);
             }
 
             curr = g_list_next(curr);
@@ -926,6 +926,15 @@ cons_winstidy_setting(void)
         cons_show("Window Auto Tidy (/wins)      : ON");
     else
         cons_show("Window Auto Tidy (/wins)      : OFF");
+
+    gint hibernate = prefs_get_wins_hibernate();
+    if (hibernate == 0) {
+        cons_show("Window hibernate (/wins)      : OFF");
+    } else if (hibernate == 1) {
+        cons_show("Window hibernate (/wins)      : 1 minute");
+    } else {
+        cons_show("Window hibernate (/wins)      : %d minutes", hibernate);
+    }
 }
 
 void
@@ -956,6 +965,15 @@ cons_flash_setting(void)
         cons_show("Terminal flash (/flash)       : OFF");
 }
 
+void
+cons_fuzzy_setting(void)
+{
+    if (prefs_get_boolean(PREF_FUZZY))
+        cons_show("Fuzzy completion (/fuzzy)     : ON");
+    else
+        cons_show("Fuzzy completion (/fuzzy)     : OFF");
+}
+
 void
 cons_splash_setting(void)
 {
@@ -1130,6 +1148,7 @@ cons_show_ui_prefs(void)
     cons_theme_setting();
     cons_beep_setting();
     cons_flash_setting();
+    cons_fuzzy_setting();
     cons_splash_setting();
     cons_wrap_setting();
     cons_winstidy_setting();
@@ -1461,6 +1480,16 @@ cons_reconnect_setting(void)
     }
 }
 
+void
+cons_sm_setting(void)
+{
+    if (prefs_get_boolean(PREF_SM)) {
+        cons_show("Stream management (/sm)         : ON");
+    } else {
+        cons_show("Stream management (/sm)         : OFF");
+    }
+}
+
 void
 cons_autoping_setting(void)
 {
@@ -1487,6 +1516,7 @@ cons_show_connection_prefs(void)
     cons_show("Connection preferences:");
     cons_show("");
     cons_reconnect_setting();
+    cons_sm_setting();
     cons_autoping_setting();
     cons_autoconnect_setting();
 
@@ -133,6 +133,7 @@ ui_update(void)
         win_move_to_end(current);
     }
 
+    rosterwin_update();
     win_update_virtual(current);
 
     if (prefs_get_boolean(PREF_TITLEBAR_SHOW)) {
@@ -434,7 +435,7 @@ ui_incoming_msg(ProfChatWin *chatwin, const char * const resource, const char *
             flash();
         }
 
-        chatwin->unread++;
+        wins_add_unread((ProfWin*)chatwin);
         if (prefs_get_boolean(PREF_CHLOG) && prefs_get_boolean(PREF_HISTORY)) {
             _win_show_history(chatwin, chatwin->barejid);
         }
@@ -484,7 +485,7 @@ ui_incoming_private_msg(const char * const fulljid, const char * const message,
 
     // not currently viewing chat window with sender
     } else {
-        privatewin->unread++;
+        wins_add_unread((ProfWin*)privatewin);
         status_bar_new(num);
         cons_show_incoming_message(display_from, num);
         win_print_incoming_message(window, timestamp, display_from, message, PROF_MSG_PLAIN);
@@ -1680,8 +1681,11 @@ ui_room_message(const char * const roomjid, const char * const nick,
     int num = wins_get_num(window);
     char *my_nick = muc_nick(roomjid);
 
+    // one pass decides both highlighting and mention notifications
+    gboolean mention = FALSE;
     if (g_strcmp0(nick, my_nick) != 0) {
-        if (g_strrstr(message, my_nick)) {
+        mention = muc_message_mentions(roomjid, message);
+        if (mention) {
             win_print(window, '-', 0, NULL, NO_ME, THEME_ROOMMENTION, nick, message);
         } else {
             win_print(window, '-', 0, NULL, NO_ME, THEME_TEXT_THEM, nick, message);
@@ -1703,7 +1707,7 @@ ui_room_message(const char * const roomjid, const char * const nick,
             flash();
         }
 
-        mucwin->unread++;
+        wins_add_unread((ProfWin*)mucwin);
     }
 
     int ui_index = num;
@@ -1721,20 +1725,13 @@ ui_room_message(const char * const roomjid, const char * const nick,
     }
 
     gboolean notify = FALSE;
-    char *room_setting = prefs_get_string(PREF_NOTIFY_ROOM);
+    const char *room_setting = prefs_get_string_const(PREF_NOTIFY_ROOM);
     if (g_strcmp0(room_setting, "on") == 0) {
         notify = TRUE;
     }
     if (g_strcmp0(room_setting, "mention") == 0) {
-        char *message_lower = g_utf8_strdown(message, -1);
-        char *nick_lower = g_utf8_strdown(nick, -1);
-        if (g_strrstr(message_lower, nick_lower)) {
-            notify = TRUE;
-        }
-        g_free(message_lower);
-        g_free(nick_lower);
+        notify = mention;
     }
-    prefs_free_string(room_setting);
 
     if (notify) {
         gboolean is_current = wins_is_current(window);
@@ -2788,7 +2785,7 @@ ui_show_roster(void)
     ProfWin *window = wins_get_console();
     if (window && !win_has_active_subwin(window)) {
         wins_show_subwin(window);
-        rosterwin_roster();
+        rosterwin_redraw();
     }
 }
 
@@ -61,67 +61,49 @@ _occuptantswin_occupant(ProfLayoutSplit *layout, Occupant *occupant, gboolean sh
     wattroff(layout->subwin, theme_attrs(presence_colour));
 }
 
+static void
+_occupantswin_role(ProfLayoutSplit *layout, ProfMucWin *mucwin, char *header, muc_role_t role)
+{
+    wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+    win_printline_nowrap(layout->subwin, header);
+    wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+
+    GSList *occupants = muc_occupants_by_role(mucwin->roomjid, role);
+    GSList *curr = occupants;
+    while (curr) {
+        _occuptantswin_occupant(layout, curr->data, mucwin->showjid);
+        curr = g_slist_next(curr);
+    }
+    g_slist_free(occupants);
+}
+
 void
 occupantswin_occupants(const char * const roomjid)
 {
     ProfMucWin *mucwin = wins_get_muc(roomjid);
-    if (mucwin) {
-        GList *occupants = muc_roster(roomjid);
-        if (occupants) {
-            ProfLayoutSplit *layout = (ProfLayoutSplit*)mucwin->window.layout;
-            assert(layout->memcheck == LAYOUT_SPLIT_MEMCHECK);
-
-            werase(layout->subwin);
+    if (mucwin && muc_roster_size(roomjid) > 0) {
+        ProfLayoutSplit *layout = (ProfLayoutSplit*)mucwin->window.layout;
+        assert(layout->memcheck == LAYOUT_SPLIT_MEMCHECK);
 
-            if (prefs_get_boolean(PREF_MUC_PRIVILEGES)) {
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_printline_nowrap(layout->subwin, " -Moderators");
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                GList *roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    if (occupant->role == MUC_ROLE_MODERATOR) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    }
-                    roster_curr = g_list_next(roster_curr);
-                }
+        werase(layout->subwin);
 
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_printline_nowrap(layout->subwin, " -Participants");
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    if (occupant->role == MUC_ROLE_PARTICIPANT) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    }
-                    roster_curr = g_list_next(roster_curr);
-                }
-
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_printline_nowrap(layout->subwin, " -Visitors");
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    if (occupant->role == MUC_ROLE_VISITOR) {
-                        _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    }
-                    roster_curr = g_list_next(roster_curr);
-                }
-            } else {
-                wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                win_printline_nowrap(layout->subwin, " -Occupants\n");
-                wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
-                GList *roster_curr = occupants;
-                while (roster_curr) {
-                    Occupant *occupant = roster_curr->data;
-                    _occuptantswin_occupant(layout, occupant, mucwin->showjid);
-                    roster_curr = g_list_next(roster_curr);
-                }
+        // each role is kept sorted by the room, no filtering needed
+        if (prefs_get_boolean(PREF_MUC_PRIVILEGES)) {
+            _occupantswin_role(layout, mucwin, " -Moderators", MUC_ROLE_MODERATOR);
+            _occupantswin_role(layout, mucwin, " -Participants", MUC_ROLE_PARTICIPANT);
+            _occupantswin_role(layout, mucwin, " -Visitors", MUC_ROLE_VISITOR);
+        } else {
+            wattron(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+            win_printline_nowrap(layout->subwin, " -Occupants\n");
+            wattroff(layout->subwin, theme_attrs(THEME_OCCUPANTS_HEADER));
+            GList *occupants = muc_roster(roomjid);
+            GList *roster_curr = occupants;
+            while (roster_curr) {
+                Occupant *occupant = roster_curr->data;
+                _occuptantswin_occupant(layout, occupant, mucwin->showjid);
+                roster_curr = g_list_next(roster_curr);
             }
+            g_list_free(occupants);
         }
-
-        g_list_free(occupants);
     }
 }
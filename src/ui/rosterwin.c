@@ -34,6 +34,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "contact.h"
 #include "ui/ui.h"
@@ -42,8 +43,45 @@
 #include "config/preferences.h"
 #include "roster_list.h"
 
+typedef struct roster_row_t {
+    char *text;
+    int attrs;
+} RosterRow;
+
+// rows currently painted on the roster panel
+static GPtrArray *painted_rows = NULL;
+static int painted_cols = 0;
+
+// roster changed since the last frame
+static gboolean roster_dirty = FALSE;
+
+
+static void
+_rosterwin_row_free(RosterRow *row)
+{
+    if (row) {
+        free(row->text);
+        free(row);
+    }
+}
+
 static void
-_rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
+_rosterwin_add_row(GPtrArray *rows, theme_item_t theme_item, const char * const text)
+{
+    RosterRow *row = malloc(sizeof(RosterRow));
+    row->text = strdup(text);
+    row->attrs = theme_attrs(theme_item);
+    g_ptr_array_add(rows, row);
+}
+
+static gboolean
+_rosterwin_row_equal(RosterRow *row1, RosterRow *row2)
+{
+    return (row1->attrs == row2->attrs) && (g_strcmp0(row1->text, row2->text) == 0);
+}
+
+static void
+_rosterwin_contact(GPtrArray *rows, PContact contact)
 {
     const char *name = p_contact_name_or_jid(contact);
     const char *presence = p_contact_presence(contact);
@@ -52,12 +90,10 @@ _rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
             (prefs_get_boolean(PREF_ROSTER_OFFLINE)))) {
         theme_item_t presence_colour = theme_main_presence_attrs(presence);
 
-        wattron(layout->subwin, theme_attrs(presence_colour));
         GString *msg = g_string_new("   ");
         g_string_append(msg, name);
-        win_printline_nowrap(layout->subwin, msg->str);
+        _rosterwin_add_row(rows, presence_colour, msg->str);
         g_string_free(msg, TRUE);
-        wattroff(layout->subwin, theme_attrs(presence_colour));
 
         if (prefs_get_boolean(PREF_ROSTER_RESOURCE)) {
             GList *resources = p_contact_get_available_resources(contact);
@@ -67,12 +103,10 @@ _rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
                 const char *resource_presence = string_from_resource_presence(resource->presence);
                 theme_item_t resource_presence_colour = theme_main_presence_attrs(resource_presence);
 
-                wattron(layout->subwin, theme_attrs(resource_presence_colour));
                 GString *msg = g_string_new("     ");
                 g_string_append(msg, resource->name);
-                win_printline_nowrap(layout->subwin, msg->str);
+                _rosterwin_add_row(rows, resource_presence_colour, msg->str);
                 g_string_free(msg, TRUE);
-                wattroff(layout->subwin, theme_attrs(resource_presence_colour));
 
                 curr_resource = g_list_next(curr_resource);
             }
@@ -82,116 +116,167 @@ _rosterwin_contact(ProfLayoutSplit *layout, PContact contact)
 }
 
 static void
-_rosterwin_contacts_by_presence(ProfLayoutSplit *layout, const char * const presence, char *title)
+_rosterwin_contact_list(GPtrArray *rows, GSList *contacts)
+{
+    GSList *curr_contact = contacts;
+    while (curr_contact) {
+        PContact contact = curr_contact->data;
+        _rosterwin_contact(rows, contact);
+        curr_contact = g_slist_next(curr_contact);
+    }
+}
+
+static void
+_rosterwin_contacts_by_presence(GPtrArray *rows, const char * const presence, char *title)
 {
     GSList *contacts = roster_get_contacts_by_presence(presence);
 
     // if this group has contacts, or if we want to show empty groups
     if (contacts || prefs_get_boolean(PREF_ROSTER_EMPTY)) {
-        wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-        win_printline_nowrap(layout->subwin, title);
-        wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
+        _rosterwin_add_row(rows, THEME_ROSTER_HEADER, title);
     }
 
-    if (contacts) {
-        GSList *curr_contact = contacts;
-        while (curr_contact) {
-            PContact contact = curr_contact->data;
-            _rosterwin_contact(layout, contact);
-            curr_contact = g_slist_next(curr_contact);
-        }
-    }
+    _rosterwin_contact_list(rows, contacts);
     g_slist_free(contacts);
 }
 
 static void
-_rosterwin_contacts_by_group(ProfLayoutSplit *layout, char *group)
+_rosterwin_contacts_by_group(GPtrArray *rows, char *group)
 {
-    wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
     GString *title = g_string_new(" -");
     g_string_append(title, group);
-    win_printline_nowrap(layout->subwin, title->str);
+    _rosterwin_add_row(rows, THEME_ROSTER_HEADER, title->str);
     g_string_free(title, TRUE);
-    wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
 
     GSList *contacts = roster_get_group(group);
-    if (contacts) {
-        GSList *curr_contact = contacts;
-        while (curr_contact) {
-            PContact contact = curr_contact->data;
-            _rosterwin_contact(layout, contact);
-            curr_contact = g_slist_next(curr_contact);
-        }
-    }
+    _rosterwin_contact_list(rows, contacts);
     g_slist_free(contacts);
 }
 
 static void
-_rosterwin_contacts_by_no_group(ProfLayoutSplit *layout)
+_rosterwin_contacts_by_no_group(GPtrArray *rows)
 {
     GSList *contacts = roster_get_nogroup();
     if (contacts) {
-        wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-        win_printline_nowrap(layout->subwin, " -no group");
-        wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-
-        GSList *curr_contact = contacts;
-        while (curr_contact) {
-            PContact contact = curr_contact->data;
-            _rosterwin_contact(layout, contact);
-            curr_contact = g_slist_next(curr_contact);
-        }
+        _rosterwin_add_row(rows, THEME_ROSTER_HEADER, " -no group");
+        _rosterwin_contact_list(rows, contacts);
     }
     g_slist_free(contacts);
 }
 
+static GPtrArray*
+_rosterwin_build_rows(void)
+{
+    GPtrArray *rows = g_ptr_array_new_with_free_func((GDestroyNotify)_rosterwin_row_free);
+
+    const char *by = prefs_get_string_const(PREF_ROSTER_BY);
+    if (g_strcmp0(by, "presence") == 0) {
+        _rosterwin_contacts_by_presence(rows, "chat", " -Available for chat");
+        _rosterwin_contacts_by_presence(rows, "online", " -Online");
+        _rosterwin_contacts_by_presence(rows, "away", " -Away");
+        _rosterwin_contacts_by_presence(rows, "xa", " -Extended Away");
+        _rosterwin_contacts_by_presence(rows, "dnd", " -Do not disturb");
+        if (prefs_get_boolean(PREF_ROSTER_OFFLINE)) {
+            _rosterwin_contacts_by_presence(rows, "offline", " -Offline");
+        }
+    } else if (g_strcmp0(by, "group") == 0) {
+        GSList *groups = roster_get_groups();
+        GSList *curr_group = groups;
+        while (curr_group) {
+            _rosterwin_contacts_by_group(rows, curr_group->data);
+            curr_group = g_slist_next(curr_group);
+        }
+        g_slist_free_full(groups, free);
+        _rosterwin_contacts_by_no_group(rows);
+    } else {
+        GSList *contacts = roster_get_contacts();
+        if (contacts) {
+            _rosterwin_add_row(rows, THEME_ROSTER_HEADER, " -Roster");
+            _rosterwin_contact_list(rows, contacts);
+        }
+        g_slist_free(contacts);
+    }
+
+    return rows;
+}
+
+static void
+_rosterwin_paint_row(WINDOW *subwin, int y, RosterRow *row)
+{
+    wmove(subwin, y, 0);
+    wclrtoeol(subwin);
+    if (row) {
+        wattron(subwin, row->attrs);
+        win_printline_nowrap(subwin, row->text);
+        wattroff(subwin, row->attrs);
+    }
+}
+
 void
 rosterwin_roster(void)
 {
+    roster_dirty = TRUE;
+}
+
+void
+rosterwin_redraw(void)
+{
+    if (painted_rows) {
+        g_ptr_array_free(painted_rows, TRUE);
+        painted_rows = NULL;
+    }
+    roster_dirty = TRUE;
+}
+
+void
+rosterwin_update(void)
+{
+    if (!roster_dirty) {
+        return;
+    }
+
     ProfWin *console = wins_get_console();
-    if (console) {
-        ProfLayoutSplit *layout = (ProfLayoutSplit*)console->layout;
-        assert(layout->memcheck == LAYOUT_SPLIT_MEMCHECK);
-
-       char *by = prefs_get_string(PREF_ROSTER_BY);
-        if (g_strcmp0(by, "presence") == 0) {
-            werase(layout->subwin);
-            _rosterwin_contacts_by_presence(layout, "chat", " -Available for chat");
-            _rosterwin_contacts_by_presence(layout, "online", " -Online");
-            _rosterwin_contacts_by_presence(layout, "away", " -Away");
-            _rosterwin_contacts_by_presence(layout, "xa", " -Extended Away");
-            _rosterwin_contacts_by_presence(layout, "dnd", " -Do not disturb");
-            if (prefs_get_boolean(PREF_ROSTER_OFFLINE)) {
-                _rosterwin_contacts_by_presence(layout, "offline", " -Offline");
-            }
-        } else if (g_strcmp0(by, "group") == 0) {
-            werase(layout->subwin);
-            GSList *groups = roster_get_groups();
-            GSList *curr_group = groups;
-            while (curr_group) {
-                _rosterwin_contacts_by_group(layout, curr_group->data);
-                curr_group = g_slist_next(curr_group);
-            }
-            g_slist_free_full(groups, free);
-            _rosterwin_contacts_by_no_group(layout);
-        } else {
-            GSList *contacts = roster_get_contacts();
-            if (contacts) {
-                werase(layout->subwin);
-
-                wattron(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-                win_printline_nowrap(layout->subwin, " -Roster");
-                wattroff(layout->subwin, theme_attrs(THEME_ROSTER_HEADER));
-
-                GSList *curr_contact = contacts;
-                while (curr_contact) {
-                    PContact contact = curr_contact->data;
-                    _rosterwin_contact(layout, contact);
-                    curr_contact = g_slist_next(curr_contact);
-                }
-            }
-            g_slist_free(contacts);
+    if (console == NULL) {
+        return;
+    }
+
+    ProfLayoutSplit *layout = (ProfLayoutSplit*)console->layout;
+    assert(layout->memcheck == LAYOUT_SPLIT_MEMCHECK);
+    if (layout->subwin == NULL) {
+        return;
+    }
+
+    // panel width changed, nothing painted can be reused
+    int cols = getmaxx(layout->subwin);
+    if (painted_rows && cols != painted_cols) {
+        rosterwin_redraw();
+    }
+
+    GPtrArray *rows = _rosterwin_build_rows();
+    if (painted_rows == NULL) {
+        werase(layout->subwin);
+    }
+
+    // repaint only the rows that differ from the last frame
+    guint i;
+    for (i = 0; i < rows->len; i++) {
+        RosterRow *row = g_ptr_array_index(rows, i);
+        if (painted_rows && i < painted_rows->len &&
+                _rosterwin_row_equal(row, g_ptr_array_index(painted_rows, i))) {
+            continue;
         }
-        free(by);
+        _rosterwin_paint_row(layout->subwin, i, row);
     }
+
+    // clear rows left over from a longer roster
+    if (painted_rows) {
+        for (i = rows->len; i < painted_rows->len; i++) {
+            _rosterwin_paint_row(layout->subwin, i, NULL);
+        }
+        g_ptr_array_free(painted_rows, TRUE);
+    }
+
+    painted_rows = rows;
+    painted_cols = cols;
+    roster_dirty = FALSE;
 }
@@ -128,7 +128,7 @@ status_bar_resize(void)
     wattroff(status_bar, bracket_attrs);
 
     if (message) {
-        char *time_pref = prefs_get_string(PREF_TIME_STATUSBAR);
+        const char *time_pref = prefs_get_string_const(PREF_TIME_STATUSBAR);
 
         gchar *date_fmt = NULL;
         if (g_strcmp0(time_pref, "off") == 0) {
@@ -146,7 +146,6 @@ status_bar_resize(void)
         } else {
             mvwprintw(status_bar, 0, 1, message);
         }
-        prefs_free_string(time_pref);
     }
     if (last_time) {
         g_date_time_unref(last_time);
@@ -313,7 +312,7 @@ status_bar_print_message(const char * const msg)
     }
     message = strdup(msg);
 
-    char *time_pref = prefs_get_string(PREF_TIME_STATUSBAR);
+    const char *time_pref = prefs_get_string_const(PREF_TIME_STATUSBAR);
     gchar *date_fmt = NULL;
     if (g_strcmp0(time_pref, "off") == 0) {
         date_fmt = g_strdup("");
@@ -329,7 +328,6 @@ status_bar_print_message(const char * const msg)
     } else {
         mvwprintw(status_bar, 0, 1, message);
     }
-    prefs_free_string(time_pref);
 
     int cols = getmaxx(stdscr);
     int bracket_attrs = theme_attrs(THEME_STATUS_BRACKET);
@@ -455,7 +453,7 @@ _status_bar_draw(void)
 
     int bracket_attrs = theme_attrs(THEME_STATUS_BRACKET);
 
-    char *time_pref = prefs_get_string(PREF_TIME_STATUSBAR);
+    const char *time_pref = prefs_get_string_const(PREF_TIME_STATUSBAR);
     if (g_strcmp0(time_pref, "off") != 0) {
         gchar *date_fmt = g_date_time_format(last_time, time_pref);
         assert(date_fmt != NULL);
@@ -469,7 +467,6 @@ _status_bar_draw(void)
         wattroff(status_bar, bracket_attrs);
         g_free(date_fmt);
     }
-    prefs_free_string(time_pref);
 
     _update_win_statuses();
     wnoutrefresh(status_bar);
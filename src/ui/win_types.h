@@ -38,6 +38,7 @@
 #include "config.h"
 
 #include <wchar.h>
+#include <time.h>
 #include <glib.h>
 #ifdef HAVE_NCURSESW_NCURSES_H
 #include <ncursesw/ncurses.h>
@@ -67,6 +68,8 @@ typedef struct prof_layout_t {
     ProfBuff buffer;
     int y_pos;
     int paged;
+    // last time the window was shown, writes while hidden do not count
+    time_t last_active;
 } ProfLayout;
 
 typedef struct prof_layout_simple_t {
@@ -62,6 +62,7 @@
 static void _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *time,
     int flags, theme_item_t theme_item, const char * const from, const char * const message, DeliveryReceipt *receipt);
 static void _win_print_wrapped(WINDOW *win, const char * const message, size_t indent, int pad_indent);
+static void _win_resume(ProfWin *window);
 
 int
 win_roster_cols(void)
@@ -91,6 +92,7 @@ _win_create_simple_layout(void)
     layout->base.buffer = buffer_create();
     layout->base.y_pos = 0;
     layout->base.paged = 0;
+    layout->base.last_active = time(NULL);
     scrollok(layout->base.win, TRUE);
 
     return &layout->base;
@@ -108,6 +110,7 @@ _win_create_split_layout(void)
     layout->base.buffer = buffer_create();
     layout->base.y_pos = 0;
     layout->base.paged = 0;
+    layout->base.last_active = time(NULL);
     scrollok(layout->base.win, TRUE);
     layout->subwin = NULL;
     layout->sub_y_pos = 0;
@@ -175,6 +178,7 @@ win_create_muc(const char * const roomjid)
     layout->base.buffer = buffer_create();
     layout->base.y_pos = 0;
     layout->base.paged = 0;
+    layout->base.last_active = time(NULL);
     scrollok(layout->base.win, TRUE);
     new_win->window.layout = (ProfLayout*)layout;
 
@@ -295,7 +299,7 @@ win_hide_subwin(ProfWin *window)
         int cols = getmaxx(stdscr);
         wresize(layout->base.win, PAD_SIZE, cols);
         win_redraw(window);
-    } else {
+    } else if (!win_is_hibernated(window)) {
         int cols = getmaxx(stdscr);
         wresize(window->layout->win, PAD_SIZE, cols);
         win_redraw(window);
@@ -337,7 +341,9 @@ win_free(ProfWin* window)
         delwin(layout->base.win);
     } else {
         buffer_free(window->layout->buffer);
-        delwin(window->layout->win);
+        if (window->layout->win) {
+            delwin(window->layout->win);
+        }
     }
     free(window->layout);
 
@@ -370,6 +376,7 @@ win_free(ProfWin* window)
 void
 win_page_up(ProfWin *window)
 {
+    _win_resume(window);
     int rows = getmaxy(stdscr);
     int y = getcury(window->layout->win);
     int page_space = rows - 4;
@@ -393,6 +400,7 @@ win_page_up(ProfWin *window)
 void
 win_page_down(ProfWin *window)
 {
+    _win_resume(window);
     int rows = getmaxy(stdscr);
     int y = getcury(window->layout->win);
     int page_space = rows - 4;
@@ -464,6 +472,7 @@ win_sub_page_up(ProfWin *window)
 void
 win_clear(ProfWin *window)
 {
+    _win_resume(window);
     werase(window->layout->win);
     win_update_virtual(window);
 }
@@ -471,6 +480,11 @@ win_clear(ProfWin *window)
 void
 win_resize(ProfWin *window)
 {
+    // sized to the screen when resumed
+    if (win_is_hibernated(window)) {
+        return;
+    }
+
     int subwin_cols = 0;
     int cols = getmaxx(stdscr);
 
@@ -485,7 +499,7 @@ win_resize(ProfWin *window)
             wresize(layout->base.win, PAD_SIZE, cols - subwin_cols);
             wresize(layout->subwin, PAD_SIZE, subwin_cols);
             if (window->type == WIN_CONSOLE) {
-                rosterwin_roster();
+                rosterwin_redraw();
             } else if (window->type == WIN_MUC) {
                 ProfMucWin *mucwin = (ProfMucWin *)window;
                 assert(mucwin->memcheck == PROFMUCWIN_MEMCHECK);
@@ -504,6 +518,9 @@ win_resize(ProfWin *window)
 void
 win_update_virtual(ProfWin *window)
 {
+    _win_resume(window);
+    window->layout->last_active = time(NULL);
+
     int rows, cols;
     getmaxyx(stdscr, rows, cols);
     int subwin_cols = 0;
@@ -560,6 +577,7 @@ win_refresh_with_subwin(ProfWin *window)
 void
 win_move_to_end(ProfWin *window)
 {
+    _win_resume(window);
     window->layout->paged = 0;
 
     int rows = getmaxy(stdscr);
@@ -701,7 +719,7 @@ win_show_occupant_info(ProfWin *window, const char * const room, Occupant *occup
         if (caps->os || caps->os_version) {
             win_newline(window);
         }
-        caps_destroy(caps);
+        caps_unref(caps);
     }
 
     win_print(window, '-', 0, NULL, 0, 0, "", "");
@@ -819,7 +837,17 @@ win_show_info(ProfWin *window, PContact contact)
             if (caps->os || caps->os_version) {
                 win_newline(window);
             }
-            caps_destroy(caps);
+            if (caps->feature_bits & (FEATURE_CHATSTATES | FEATURE_RECEIPTS)) {
+                win_print(window, '-', 0, NULL, NO_EOL, 0, "", "    Supports:");
+                if (caps->feature_bits & FEATURE_CHATSTATES) {
+                    win_print(window, '-', 0, NULL, NO_DATE | NO_EOL, 0, "", " chat states");
+                }
+                if (caps->feature_bits & FEATURE_RECEIPTS) {
+                    win_print(window, '-', 0, NULL, NO_DATE | NO_EOL, 0, "", " receipts");
+                }
+                win_newline(window);
+            }
+            caps_unref(caps);
         }
 
         curr = g_list_next(curr);
@@ -853,9 +881,7 @@ win_show_status_string(ProfWin *window, const char * const from,
 
     if (last_activity) {
         gchar *date_fmt = NULL;
-        char *time_pref = prefs_get_string(PREF_TIME_LASTACTIVITY);
-        date_fmt = g_date_time_format(last_activity, time_pref);
-        prefs_free_string(time_pref);
+        date_fmt = g_date_time_format(last_activity, prefs_get_string_const(PREF_TIME_LASTACTIVITY));
         assert(date_fmt != NULL);
 
         win_vprint(window, '-', 0, NULL, NO_DATE | NO_EOL, presence_colour, "", ", last activity: %s", date_fmt);
@@ -918,7 +944,9 @@ win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *time
     }
 
     buffer_push(window->layout->buffer, show_char, pad_indent, timestamp, flags, theme_item, from, message, NULL);
-    _win_print(window, show_char, pad_indent, timestamp, flags, theme_item, from, message, NULL);
+    if (!win_is_hibernated(window)) {
+        _win_print(window, show_char, pad_indent, timestamp, flags, theme_item, from, message, NULL);
+    }
     // TODO: cross-reference.. this should be replaced by a real event-based system
     ui_input_nonblocking(TRUE);
     g_date_time_unref(timestamp);
@@ -941,7 +969,9 @@ win_print_with_receipt(ProfWin *window, const char show_char, int pad_indent, GT
     receipt->received = FALSE;
 
     buffer_push(window->layout->buffer, show_char, pad_indent, time, flags, theme_item, from, message, receipt);
-    _win_print(window, show_char, pad_indent, time, flags, theme_item, from, message, receipt);
+    if (!win_is_hibernated(window)) {
+        _win_print(window, show_char, pad_indent, time, flags, theme_item, from, message, receipt);
+    }
     // TODO: cross-reference.. this should be replaced by a real event-based system
     ui_input_nonblocking(TRUE);
     g_date_time_unref(time);
@@ -951,7 +981,7 @@ void
 win_mark_received(ProfWin *window, const char * const id)
 {
     gboolean received = buffer_mark_received(window->layout->buffer, id);
-    if (received) {
+    if (received && !win_is_hibernated(window)) {
         win_redraw(window);
     }
 }
@@ -982,25 +1012,25 @@ _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *tim
     int colour = theme_attrs(THEME_ME);
     size_t indent = 0;
 
-    char *time_pref = NULL;
+    const char *time_pref = NULL;
     switch (window->type) {
         case WIN_CHAT:
-            time_pref = prefs_get_string(PREF_TIME_CHAT);
+            time_pref = prefs_get_string_const(PREF_TIME_CHAT);
             break;
         case WIN_MUC:
-            time_pref = prefs_get_string(PREF_TIME_MUC);
+            time_pref = prefs_get_string_const(PREF_TIME_MUC);
             break;
         case WIN_MUC_CONFIG:
-            time_pref = prefs_get_string(PREF_TIME_MUCCONFIG);
+            time_pref = prefs_get_string_const(PREF_TIME_MUCCONFIG);
             break;
         case WIN_PRIVATE:
-            time_pref = prefs_get_string(PREF_TIME_PRIVATE);
+            time_pref = prefs_get_string_const(PREF_TIME_PRIVATE);
             break;
         case WIN_XML:
-            time_pref = prefs_get_string(PREF_TIME_XMLCONSOLE);
+            time_pref = prefs_get_string_const(PREF_TIME_XMLCONSOLE);
             break;
         default:
-            time_pref = prefs_get_string(PREF_TIME_CONSOLE);
+            time_pref = prefs_get_string_const(PREF_TIME_CONSOLE);
             break;
     }
 
@@ -1010,7 +1040,6 @@ _win_print(ProfWin *window, const char show_char, int pad_indent, GDateTime *tim
     } else {
         date_fmt = g_date_time_format(time, time_pref);
     }
-    prefs_free_string(time_pref);
     assert(date_fmt != NULL);
 
     if(strlen(date_fmt) != 0){
@@ -1211,6 +1240,11 @@ _win_print_wrapped(WINDOW *win, const char * const message, size_t indent, int p
 void
 win_redraw(ProfWin *window)
 {
+    // redrawn when resumed
+    if (win_is_hibernated(window)) {
+        return;
+    }
+
     int i, size;
     werase(window->layout->win);
     size = buffer_size(window->layout->buffer);
@@ -1221,6 +1255,43 @@ win_redraw(ProfWin *window)
     }
 }
 
+void
+win_hibernate(ProfWin *window)
+{
+    // only simple layouts, split layouts share their subwin with the occupants and roster panels
+    if (window->layout->type != LAYOUT_SIMPLE || win_is_hibernated(window)) {
+        return;
+    }
+
+    delwin(window->layout->win);
+    window->layout->win = NULL;
+    buffer_pack(window->layout->buffer);
+}
+
+gboolean
+win_is_hibernated(ProfWin *window)
+{
+    return window->layout->win == NULL;
+}
+
+gsize
+win_mem_size(ProfWin *window)
+{
+    gsize result = buffer_mem_size(window->layout->buffer);
+
+    if (!win_is_hibernated(window)) {
+        result += (gsize)getmaxy(window->layout->win) * getmaxx(window->layout->win) * sizeof(chtype);
+    }
+    if (window->layout->type == LAYOUT_SPLIT) {
+        ProfLayoutSplit *layout = (ProfLayoutSplit*)window->layout;
+        if (layout->subwin) {
+            result += (gsize)getmaxy(layout->subwin) * getmaxx(layout->subwin) * sizeof(chtype);
+        }
+    }
+
+    return result;
+}
+
 gboolean
 win_has_active_subwin(ProfWin *window)
 {
@@ -1262,3 +1333,27 @@ win_printline_nowrap(WINDOW *win, char *msg)
 
     wmove(win, cury+1, 0);
 }
+
+// rebuild the pad of a hibernated window from its buffer
+static void
+_win_resume(ProfWin *window)
+{
+    if (!win_is_hibernated(window)) {
+        return;
+    }
+
+    int cols = getmaxx(stdscr);
+    window->layout->win = newpad(PAD_SIZE, cols);
+    wbkgd(window->layout->win, theme_attrs(THEME_TEXT));
+    scrollok(window->layout->win, TRUE);
+    buffer_unpack(window->layout->buffer);
+    win_redraw(window);
+
+    window->layout->paged = 0;
+    int rows = getmaxy(stdscr);
+    int y = getcury(window->layout->win);
+    window->layout->y_pos = y - (rows - 4);
+    if (window->layout->y_pos < 0) {
+        window->layout->y_pos = 0;
+    }
+}
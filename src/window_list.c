@@ -37,6 +37,7 @@
 #include <string.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include <glib.h>
 
@@ -51,14 +52,41 @@
 static GHashTable *windows;
 static int current;
 
+// lookup indexes keyed on the jid owned by each window
+static GHashTable *chat_wins;
+static GHashTable *muc_wins;
+static GHashTable *muc_conf_wins;
+static GHashTable *private_wins;
+static ProfXMLWin *xmlconsole;
+
+// bitmap of used window numbers, indexed by position (window 0 is position 10)
+static guint32 *used_nums;
+static guint used_nums_len;
+
+static int total_unread;
+static time_t last_hibernate_check;
+
+static void _wins_index_add(ProfWin *window);
+static void _wins_index_remove(ProfWin *window);
+static void _wins_num_set_used(int num, gboolean used);
+static int _wins_next_available_num(void);
+static void _wins_insert(ProfWin *window);
+
 void
 wins_init(void)
 {
     windows = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
         (GDestroyNotify)win_free);
+    chat_wins = g_hash_table_new(g_str_hash, g_str_equal);
+    muc_wins = g_hash_table_new(g_str_hash, g_str_equal);
+    muc_conf_wins = g_hash_table_new(g_str_hash, g_str_equal);
+    private_wins = g_hash_table_new(g_str_hash, g_str_equal);
+    xmlconsole = NULL;
+    total_unread = 0;
 
     ProfWin *console = win_create_console();
     g_hash_table_insert(windows, GINT_TO_POINTER(1), console);
+    _wins_num_set_used(1, TRUE);
 
     current = 1;
 }
@@ -72,89 +100,41 @@ wins_get_console(void)
 ProfChatWin *
 wins_get_chat(const char * const barejid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_CHAT) {
-            ProfChatWin *chatwin = (ProfChatWin*)window;
-            if (g_strcmp0(chatwin->barejid, barejid) == 0) {
-                g_list_free(values);
-                return chatwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (barejid == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(chat_wins, barejid);
 }
 
 ProfMucConfWin *
 wins_get_muc_conf(const char * const roomjid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_MUC_CONFIG) {
-            ProfMucConfWin *confwin = (ProfMucConfWin*)window;
-            if (g_strcmp0(confwin->roomjid, roomjid) == 0) {
-                g_list_free(values);
-                return confwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (roomjid == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(muc_conf_wins, roomjid);
 }
 
 ProfMucWin *
 wins_get_muc(const char * const roomjid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_MUC) {
-            ProfMucWin *mucwin = (ProfMucWin*)window;
-            if (g_strcmp0(mucwin->roomjid, roomjid) == 0) {
-                g_list_free(values);
-                return mucwin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (roomjid == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(muc_wins, roomjid);
 }
 
 ProfPrivateWin *
 wins_get_private(const char * const fulljid)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_PRIVATE) {
-            ProfPrivateWin *privatewin = (ProfPrivateWin*)window;
-            if (g_strcmp0(privatewin->fulljid, fulljid) == 0) {
-                g_list_free(values);
-                return privatewin;
-            }
-        }
-        curr = g_list_next(curr);
+    if (fulljid == NULL) {
+        return NULL;
     }
 
-    g_list_free(values);
-    return NULL;
+    return g_hash_table_lookup(private_wins, fulljid);
 }
 
 ProfWin *
@@ -179,6 +159,7 @@ wins_set_current_by_num(int i)
     ProfWin *window = g_hash_table_lookup(windows, GINT_TO_POINTER(i));
     if (window) {
         current = i;
+        total_unread -= win_unread(window);
         if (window->type == WIN_CHAT) {
             ProfChatWin *chatwin = (ProfChatWin*) window;
             assert(chatwin->memcheck == PROFCHATWIN_MEMCHECK);
@@ -304,6 +285,13 @@ wins_close_by_num(int i)
             win_update_virtual(window);
         }
 
+        ProfWin *window = g_hash_table_lookup(windows, GINT_TO_POINTER(i));
+        if (window) {
+            total_unread -= win_unread(window);
+            _wins_index_remove(window);
+            _wins_num_set_used(i, FALSE);
+        }
+
         g_hash_table_remove(windows, GINT_TO_POINTER(i));
         status_bar_inactive(i);
     }
@@ -324,72 +312,69 @@ wins_is_current(ProfWin *window)
 ProfWin *
 wins_new_xmlconsole(void)
 {
-    GList *keys = g_hash_table_get_keys(windows);
-    int result = get_next_available_win_num(keys);
-    g_list_free(keys);
     ProfWin *newwin = win_create_xmlconsole();
-    g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_insert(newwin);
     return newwin;
 }
 
 ProfWin *
 wins_new_chat(const char * const barejid)
 {
-    GList *keys = g_hash_table_get_keys(windows);
-    int result = get_next_available_win_num(keys);
-    g_list_free(keys);
     ProfWin *newwin = win_create_chat(barejid);
-    g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_insert(newwin);
     return newwin;
 }
 
 ProfWin *
 wins_new_muc(const char * const roomjid)
 {
-    GList *keys = g_hash_table_get_keys(windows);
-    int result = get_next_available_win_num(keys);
-    g_list_free(keys);
     ProfWin *newwin = win_create_muc(roomjid);
-    g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_insert(newwin);
     return newwin;
 }
 
 ProfWin *
 wins_new_muc_config(const char * const roomjid, DataForm *form)
 {
-    GList *keys = g_hash_table_get_keys(windows);
-    int result = get_next_available_win_num(keys);
-    g_list_free(keys);
     ProfWin *newwin = win_create_muc_config(roomjid, form);
-    g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_insert(newwin);
     return newwin;
 }
 
 ProfWin *
 wins_new_private(const char * const fulljid)
 {
-    GList *keys = g_hash_table_get_keys(windows);
-    int result = get_next_available_win_num(keys);
-    g_list_free(keys);
     ProfWin *newwin = win_create_private(fulljid);
-    g_hash_table_insert(windows, GINT_TO_POINTER(result), newwin);
+    _wins_insert(newwin);
     return newwin;
 }
 
+void
+wins_add_unread(ProfWin *window)
+{
+    if (window->type == WIN_CHAT) {
+        ProfChatWin *chatwin = (ProfChatWin*) window;
+        assert(chatwin->memcheck == PROFCHATWIN_MEMCHECK);
+        chatwin->unread++;
+    } else if (window->type == WIN_MUC) {
+        ProfMucWin *mucwin = (ProfMucWin*) window;
+        assert(mucwin->memcheck == PROFMUCWIN_MEMCHECK);
+        mucwin->unread++;
+    } else if (window->type == WIN_PRIVATE) {
+        ProfPrivateWin *privatewin = (ProfPrivateWin*) window;
+        assert(privatewin->memcheck == PROFPRIVATEWIN_MEMCHECK);
+        privatewin->unread++;
+    } else {
+        return;
+    }
+
+    total_unread++;
+}
+
 int
 wins_get_total_unread(void)
 {
-    int result = 0;
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        result += win_unread(window);
-        curr = g_list_next(curr);
-    }
-    g_list_free(values);
-    return result;
+    return total_unread;
 }
 
 void
@@ -429,22 +414,11 @@ wins_show_subwin(ProfWin *window)
 ProfXMLWin *
 wins_get_xmlconsole(void)
 {
-    GList *values = g_hash_table_get_values(windows);
-    GList *curr = values;
-
-    while (curr) {
-        ProfWin *window = curr->data;
-        if (window->type == WIN_XML) {
-            ProfXMLWin *xmlwin = (ProfXMLWin*)window;
-            assert(xmlwin->memcheck == PROFXMLWIN_MEMCHECK);
-            g_list_free(values);
-            return xmlwin;
-        }
-        curr = g_list_next(curr);
+    if (xmlconsole) {
+        assert(xmlconsole->memcheck == PROFXMLWIN_MEMCHECK);
     }
 
-    g_list_free(values);
-    return NULL;
+    return xmlconsole;
 }
 
 GSList *
@@ -522,6 +496,8 @@ wins_swap(int source_win, int target_win)
         if (!target) {
             g_hash_table_steal(windows, GINT_TO_POINTER(source_win));
             g_hash_table_insert(windows, GINT_TO_POINTER(target_win), source);
+            _wins_num_set_used(source_win, FALSE);
+            _wins_num_set_used(target_win, TRUE);
             status_bar_inactive(source_win);
             if (win_unread(source) > 0) {
                 status_bar_new(target_win);
@@ -572,8 +548,8 @@ wins_tidy(void)
     GList *last = g_list_last(keys);
     int last_num = GPOINTER_TO_INT(last->data);
 
-    // find first free num TODO - Will sort again
-    int next_available = get_next_available_win_num(keys);
+    // find first free num
+    int next_available = _wins_next_available_num();
 
     // found gap (next available before last window)
     if (cmp_win_num(GINT_TO_POINTER(next_available), GINT_TO_POINTER(last_num)) < 0) {
@@ -608,7 +584,17 @@ wins_tidy(void)
             curr = g_list_next(curr);
         }
 
+        g_hash_table_steal_all(windows);
+        g_hash_table_destroy(windows);
         windows = new_windows;
+
+        // windows now occupy consecutive numbers
+        memset(used_nums, 0, used_nums_len * sizeof(guint32));
+        int i;
+        for (i = 1; i < num; i++) {
+            _wins_num_set_used(i == 10 ? 0 : i, TRUE);
+        }
+
         current = 1;
         ProfWin *console = wins_get_console();
         ui_ev_focus_win(console);
@@ -620,10 +606,43 @@ wins_tidy(void)
     }
 }
 
+void
+wins_hibernate_idle(int minutes)
+{
+    if (minutes <= 0) {
+        return;
+    }
+
+    // idle times are in minutes, no need to look more often
+    time_t now = time(NULL);
+    if (difftime(now, last_hibernate_check) < 60) {
+        return;
+    }
+    last_hibernate_check = now;
+
+    GList *values = g_hash_table_get_values(windows);
+    GList *curr = values;
+    while (curr) {
+        ProfWin *window = curr->data;
+        if ((window->type == WIN_CHAT || window->type == WIN_PRIVATE) &&
+                !wins_is_current(window) &&
+                !win_is_hibernated(window) &&
+                difftime(now, window->layout->last_active) >= minutes * 60) {
+            win_hibernate(window);
+        }
+        curr = g_list_next(curr);
+    }
+    g_list_free(values);
+}
+
 GSList *
 wins_create_summary(void)
 {
     GSList *result = NULL;
+    int resident_count = 0;
+    int hibernated_count = 0;
+    gsize resident_size = 0;
+    gsize hibernated_size = 0;
 
     GList *keys = g_hash_table_get_keys(windows);
     keys = g_list_sort(keys, cmp_win_num);
@@ -633,6 +652,14 @@ wins_create_summary(void)
         ProfWin *window = g_hash_table_lookup(windows, curr->data);
         int ui_index = GPOINTER_TO_INT(curr->data);
 
+        if (win_is_hibernated(window)) {
+            hibernated_count++;
+            hibernated_size += win_mem_size(window);
+        } else {
+            resident_count++;
+            resident_size += win_mem_size(window);
+        }
+
         GString *chat_string;
         GString *priv_string;
         GString *muc_string;
@@ -666,6 +693,9 @@ wins_create_summary(void)
                     g_string_append(chat_string, chat_unread->str);
                     g_string_free(chat_unread, TRUE);
                 }
+                if (win_is_hibernated(window)) {
+                    g_string_append(chat_string, ", hibernated");
+                }
 
                 result = g_slist_append(result, strdup(chat_string->str));
                 g_string_free(chat_string, TRUE);
@@ -683,6 +713,9 @@ wins_create_summary(void)
                     g_string_append(priv_string, priv_unread->str);
                     g_string_free(priv_unread, TRUE);
                 }
+                if (win_is_hibernated(window)) {
+                    g_string_append(priv_string, ", hibernated");
+                }
 
                 result = g_slist_append(result, strdup(priv_string->str));
                 g_string_free(priv_string, TRUE);
@@ -731,11 +764,142 @@ wins_create_summary(void)
     }
 
     g_list_free(keys);
+
+    GString *memory_string = g_string_new("");
+    g_string_printf(memory_string, "Memory: %d resident (%" G_GSIZE_FORMAT " KB), %d hibernated (%" G_GSIZE_FORMAT " KB)",
+        resident_count, resident_size / 1024, hibernated_count, hibernated_size / 1024);
+    result = g_slist_append(result, strdup(memory_string->str));
+    g_string_free(memory_string, TRUE);
+
     return result;
 }
 
 void
 wins_destroy(void)
 {
+    g_hash_table_destroy(chat_wins);
+    g_hash_table_destroy(muc_wins);
+    g_hash_table_destroy(muc_conf_wins);
+    g_hash_table_destroy(private_wins);
+    xmlconsole = NULL;
     g_hash_table_destroy(windows);
+    g_free(used_nums);
+    used_nums = NULL;
+    used_nums_len = 0;
+    total_unread = 0;
+}
+
+static void
+_wins_insert(ProfWin *window)
+{
+    int num = _wins_next_available_num();
+    g_hash_table_insert(windows, GINT_TO_POINTER(num), window);
+    _wins_num_set_used(num, TRUE);
+    _wins_index_add(window);
+}
+
+static void
+_wins_index_add(ProfWin *window)
+{
+    switch (window->type)
+    {
+        case WIN_CHAT:
+        {
+            ProfChatWin *chatwin = (ProfChatWin*)window;
+            g_hash_table_insert(chat_wins, chatwin->barejid, chatwin);
+            break;
+        }
+        case WIN_MUC:
+        {
+            ProfMucWin *mucwin = (ProfMucWin*)window;
+            g_hash_table_insert(muc_wins, mucwin->roomjid, mucwin);
+            break;
+        }
+        case WIN_MUC_CONFIG:
+        {
+            ProfMucConfWin *confwin = (ProfMucConfWin*)window;
+            g_hash_table_insert(muc_conf_wins, confwin->roomjid, confwin);
+            break;
+        }
+        case WIN_PRIVATE:
+        {
+            ProfPrivateWin *privatewin = (ProfPrivateWin*)window;
+            g_hash_table_insert(private_wins, privatewin->fulljid, privatewin);
+            break;
+        }
+        case WIN_XML:
+            xmlconsole = (ProfXMLWin*)window;
+            break;
+        default:
+            break;
+    }
+}
+
+static void
+_wins_index_remove(ProfWin *window)
+{
+    switch (window->type)
+    {
+        case WIN_CHAT:
+            g_hash_table_remove(chat_wins, ((ProfChatWin*)window)->barejid);
+            break;
+        case WIN_MUC:
+            g_hash_table_remove(muc_wins, ((ProfMucWin*)window)->roomjid);
+            break;
+        case WIN_MUC_CONFIG:
+            g_hash_table_remove(muc_conf_wins, ((ProfMucConfWin*)window)->roomjid);
+            break;
+        case WIN_PRIVATE:
+            g_hash_table_remove(private_wins, ((ProfPrivateWin*)window)->fulljid);
+            break;
+        case WIN_XML:
+            if ((ProfXMLWin*)window == xmlconsole) {
+                xmlconsole = NULL;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void
+_wins_num_set_used(int num, gboolean used)
+{
+    guint pos = num == 0 ? 10 : num;
+    guint word = pos / 32;
+
+    if (word >= used_nums_len) {
+        guint new_len = word + 1;
+        used_nums = g_renew(guint32, used_nums, new_len);
+        memset(used_nums + used_nums_len, 0, (new_len - used_nums_len) * sizeof(guint32));
+        used_nums_len = new_len;
+    }
+
+    if (used) {
+        used_nums[word] |= (guint32)1 << (pos % 32);
+    } else {
+        used_nums[word] &= ~((guint32)1 << (pos % 32));
+    }
+}
+
+static int
+_wins_next_available_num(void)
+{
+    guint pos = used_nums_len * 32;
+    guint word;
+
+    for (word = 0; word < used_nums_len; word++) {
+        guint32 free_bits = ~used_nums[word];
+
+        // position 0 is never used and position 1 is the console
+        if (word == 0) {
+            free_bits &= ~(guint32)3;
+        }
+        if (free_bits) {
+            pos = word * 32 + g_bit_nth_lsf(free_bits, -1);
+            break;
+        }
+    }
+
+    return pos == 10 ? 0 : pos;
 }
@@ -65,12 +65,14 @@ int wins_get_current_num(void);
 void wins_close_current(void);
 void wins_close_by_num(int i);
 gboolean wins_is_current(ProfWin *window);
+void wins_add_unread(ProfWin *window);
 int wins_get_total_unread(void);
 void wins_resize_all(void);
 GSList * wins_get_chat_recipients(void);
 GSList * wins_get_prune_wins(void);
 void wins_lost_connection(void);
 gboolean wins_tidy(void);
+void wins_hibernate_idle(int minutes);
 GSList * wins_create_summary(void);
 void wins_destroy(void);
 GList * wins_get_nums(void);
@@ -92,7 +92,7 @@ bookmark_request(void)
 
     iq = stanza_create_bookmarks_storage_request(ctx);
     xmpp_stanza_set_id(iq, id);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -278,8 +278,10 @@ _bookmark_handle_result(xmpp_conn_t * const conn,
     if (bookmark_ac == NULL) {
         bookmark_ac = autocomplete_new();
     }
-    my_jid = jid_create(jabber_get_fulljid());
+    my_jid = jid_ref(jabber_get_jid());
 
+    // autojoin presences go out together
+    jabber_cork();
     ptr = xmpp_stanza_get_children(ptr);
     while (ptr) {
         name = xmpp_stanza_get_name(ptr);
@@ -353,6 +355,7 @@ _bookmark_handle_result(xmpp_conn_t * const conn,
 
         ptr = xmpp_stanza_get_next(ptr);
     }
+    jabber_uncork();
 
     jid_destroy(my_jid);
 
@@ -402,7 +405,6 @@ _match_bookmark_by_jid(gconstpointer a, gconstpointer b)
 static void
 _send_bookmarks(void)
 {
-    xmpp_conn_t *conn = connection_get_conn();
     xmpp_ctx_t *ctx = connection_get_ctx();
 
     xmpp_stanza_t *iq = xmpp_stanza_new(ctx);
@@ -474,6 +476,6 @@ _send_bookmarks(void)
     xmpp_stanza_release(storage);
     xmpp_stanza_release(query);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
@@ -53,6 +53,7 @@
 
 #include "common.h"
 #include "log.h"
+#include "config/persist.h"
 #include "xmpp/xmpp.h"
 #include "xmpp/stanza.h"
 #include "xmpp/form.h"
@@ -61,16 +62,52 @@
 static gchar *cache_loc;
 static GKeyFile *cache;
 
+// interned capabilities by verification string, each holds one reference
+static GHashTable *ver_to_caps;
 static GHashTable *jid_to_ver;
 static GHashTable *jid_to_caps;
 
+// disco#info request in flight for a verification string, later JIDs
+// advertising the same string wait for the single response
+typedef struct caps_request_t {
+    char *node;
+    char *jid;
+    GSList *waiters;
+    gint64 sent;
+} CapsRequest;
+
+static GHashTable *ver_to_request;
+
 static char *my_sha1;
 
+static struct {
+    const char *ns;
+    caps_feature_t feature;
+} feature_map[] = {
+    { STANZA_NS_CHATSTATES,     FEATURE_CHATSTATES },
+    { STANZA_NS_RECEIPTS,       FEATURE_RECEIPTS },
+    { STANZA_NS_CARBONS,        FEATURE_CARBONS },
+    { STANZA_NS_PING,           FEATURE_PING },
+    { STANZA_NS_LASTACTIVITY,   FEATURE_LASTACTIVITY },
+    { STANZA_NS_VERSION,        FEATURE_VERSION },
+    { STANZA_NS_MUC,            FEATURE_MUC },
+    { STANZA_NS_CONFERENCE,     FEATURE_CONFERENCE },
+    { STANZA_NS_CAPS,           FEATURE_CAPS },
+    { XMPP_NS_DISCO_INFO,       FEATURE_DISCO_INFO },
+    { XMPP_NS_DISCO_ITEMS,      FEATURE_DISCO_ITEMS },
+    { STANZA_NS_DATA,           FEATURE_DATA },
+};
+
 static gchar* _get_cache_file(void);
 static void _save_cache(void);
+static void _write_cache(void);
 static Capabilities * _caps_by_ver(const char * const ver);
 static Capabilities * _caps_by_jid(const char * const jid);
-Capabilities * _caps_copy(Capabilities *caps);
+static void _caps_free(Capabilities *caps);
+static guint _caps_feature_bits(GSList *features);
+static void _caps_request_send(const char * const ver, CapsRequest *request);
+static void _caps_request_retry(const char * const ver, CapsRequest *request);
+static void _caps_request_free(CapsRequest *request);
 
 void
 caps_init(void)
@@ -86,8 +123,10 @@ caps_init(void)
     g_key_file_load_from_file(cache, cache_loc, G_KEY_FILE_KEEP_COMMENTS,
         NULL);
 
+    ver_to_caps = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)caps_unref);
     jid_to_ver = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
-    jid_to_caps = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)caps_destroy);
+    jid_to_caps = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)caps_unref);
+    ver_to_request = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)_caps_request_free);
 
     my_sha1 = NULL;
 }
@@ -132,6 +171,10 @@ caps_add_by_ver(const char * const ver, Capabilities *caps)
 
         _save_cache();
     }
+
+    if (!g_hash_table_contains(ver_to_caps, ver)) {
+        g_hash_table_insert(ver_to_caps, strdup(ver), caps_ref(caps));
+    }
 }
 
 void
@@ -146,17 +189,174 @@ caps_map_jid_to_ver(const char * const jid, const char * const ver)
     g_hash_table_insert(jid_to_ver, strdup(jid), strdup(ver));
 }
 
+void
+caps_remove_jid(const char * const jid)
+{
+    g_hash_table_remove(jid_to_ver, jid);
+    g_hash_table_remove(jid_to_caps, jid);
+
+    GHashTableIter iter;
+    gpointer value;
+    g_hash_table_iter_init(&iter, ver_to_request);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        CapsRequest *request = value;
+        GSList *found = g_slist_find_custom(request->waiters, jid, (GCompareFunc)g_strcmp0);
+        if (found) {
+            free(found->data);
+            request->waiters = g_slist_delete_link(request->waiters, found);
+        }
+    }
+}
+
+void
+caps_clear_jids(void)
+{
+    g_hash_table_remove_all(jid_to_ver);
+    g_hash_table_remove_all(jid_to_caps);
+    g_hash_table_remove_all(ver_to_request);
+}
+
+void
+caps_request(const char * const jid, const char * const node, const char * const ver)
+{
+    CapsRequest *request = g_hash_table_lookup(ver_to_request, ver);
+    if (request) {
+        if (g_strcmp0(request->jid, jid) != 0 &&
+                !g_slist_find_custom(request->waiters, jid, (GCompareFunc)g_strcmp0)) {
+            log_debug("Capabilities request in progress for %s, %s waiting.", ver, jid);
+            request->waiters = g_slist_append(request->waiters, strdup(jid));
+        }
+        return;
+    }
+
+    request = malloc(sizeof(CapsRequest));
+    request->node = strdup(node);
+    request->jid = strdup(jid);
+    request->waiters = NULL;
+    g_hash_table_insert(ver_to_request, strdup(ver), request);
+
+    _caps_request_send(ver, request);
+}
+
+void
+caps_request_complete(const char * const ver)
+{
+    CapsRequest *request = g_hash_table_lookup(ver_to_request, ver);
+    if (!request) {
+        return;
+    }
+
+    caps_map_jid_to_ver(request->jid, ver);
+    GSList *curr = request->waiters;
+    while (curr) {
+        caps_map_jid_to_ver(curr->data, ver);
+        curr = g_slist_next(curr);
+    }
+
+    g_hash_table_remove(ver_to_request, ver);
+}
+
+void
+caps_request_failed(const char * const jid)
+{
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, ver_to_request);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        CapsRequest *request = value;
+        if (g_strcmp0(request->jid, jid) == 0) {
+            _caps_request_retry(key, request);
+            return;
+        }
+    }
+}
+
+void
+caps_request_check_timeouts(void)
+{
+    gint64 now = g_get_monotonic_time();
+    GSList *expired = NULL;
+
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, ver_to_request);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        CapsRequest *request = value;
+        if ((now - request->sent) >= (CAPS_REQUEST_TIMEOUT * 1000)) {
+            expired = g_slist_append(expired, strdup(key));
+        }
+    }
+
+    // retry outside the iteration, a retry may remove the request
+    GSList *curr = expired;
+    while (curr) {
+        CapsRequest *request = g_hash_table_lookup(ver_to_request, curr->data);
+        if (request) {
+            log_info("Capabilities request for %s to %s timed out.", curr->data, request->jid);
+            _caps_request_retry(curr->data, request);
+        }
+        curr = g_slist_next(curr);
+    }
+    g_slist_free_full(expired, free);
+}
+
+static void
+_caps_request_send(const char * const ver, CapsRequest *request)
+{
+    char *id = create_unique_id("caps");
+    iq_send_caps_request(request->jid, id, request->node, ver);
+    free(id);
+    request->sent = g_get_monotonic_time();
+}
+
+static void
+_caps_request_retry(const char * const ver, CapsRequest *request)
+{
+    if (!request->waiters) {
+        log_info("No more JIDs to request capabilities %s from.", ver);
+        g_hash_table_remove(ver_to_request, ver);
+        return;
+    }
+
+    free(request->jid);
+    request->jid = request->waiters->data;
+    request->waiters = g_slist_delete_link(request->waiters, request->waiters);
+
+    log_info("Retrying capabilities request for %s with %s.", ver, request->jid);
+    _caps_request_send(ver, request);
+}
+
+static void
+_caps_request_free(CapsRequest *request)
+{
+    if (request) {
+        free(request->node);
+        free(request->jid);
+        g_slist_free_full(request->waiters, free);
+        free(request);
+    }
+}
+
 gboolean
 caps_contains(const char * const ver)
 {
-    return (g_key_file_has_group(cache, ver));
+    return (g_hash_table_contains(ver_to_caps, ver) || g_key_file_has_group(cache, ver));
 }
 
 static Capabilities *
 _caps_by_ver(const char * const ver)
 {
+    Capabilities *interned = g_hash_table_lookup(ver_to_caps, ver);
+    if (interned) {
+        return interned;
+    }
+
+    // first lookup of this verification string, build from the cache file
     if (g_key_file_has_group(cache, ver)) {
         Capabilities *new_caps = malloc(sizeof(struct capabilities_t));
+        new_caps->refcount = 1;
 
         char *category = g_key_file_get_string(cache, ver, "category", NULL);
         if (category) {
@@ -220,6 +420,9 @@ _caps_by_ver(const char * const ver)
         } else {
             new_caps->features = NULL;
         }
+        new_caps->feature_bits = _caps_feature_bits(new_caps->features);
+
+        g_hash_table_insert(ver_to_caps, strdup(ver), new_caps);
         return new_caps;
     } else {
         return NULL;
@@ -240,13 +443,13 @@ caps_lookup(const char * const jid)
         Capabilities *caps = _caps_by_ver(ver);
         if (caps) {
             log_debug("Capabilities lookup %s, found by verification string %s.", jid, ver);
-            return caps;
+            return caps_ref(caps);
         }
     } else {
         Capabilities *caps = _caps_by_jid(jid);
         if (caps) {
             log_debug("Capabilities lookup %s, found by JID.", jid);
-            return _caps_copy(caps);
+            return caps_ref(caps);
         }
     }
 
@@ -254,30 +457,41 @@ caps_lookup(const char * const jid)
     return NULL;
 }
 
-Capabilities *
-_caps_copy(Capabilities *caps)
+gboolean
+caps_jid_has_feature(const char * const jid, caps_feature_t feature)
 {
-    if (!caps) {
-        return NULL;
+    Capabilities *caps = NULL;
+    char *ver = g_hash_table_lookup(jid_to_ver, jid);
+    if (ver) {
+        caps = _caps_by_ver(ver);
     } else {
-        Capabilities *result = (Capabilities *)malloc(sizeof(Capabilities));
-        result->category = caps->category ? strdup(caps->category) : NULL;
-        result->type = caps->type ? strdup(caps->type) : NULL;
-        result->name = caps->name ? strdup(caps->name) : NULL;
-        result->software = caps->software ? strdup(caps->software) : NULL;
-        result->software_version = caps->software_version ? strdup(caps->software_version) : NULL;
-        result->os = caps->os ? strdup(caps->os) : NULL;
-        result->os_version = caps->os_version ? strdup(caps->os_version) : NULL;
+        caps = _caps_by_jid(jid);
+    }
 
-        result->features = NULL;
-        GSList *curr = caps->features;
-        while (curr) {
-            result->features = g_slist_append(result->features, strdup(curr->data));
-            curr = g_slist_next(curr);
-        }
+    if (caps) {
+        return ((caps->feature_bits & feature) != 0);
+    } else {
+        return FALSE;
+    }
+}
 
-        return result;
+static guint
+_caps_feature_bits(GSList *features)
+{
+    guint result = 0;
+    GSList *curr = features;
+    while (curr) {
+        int i;
+        for (i = 0; i < ARRAY_SIZE(feature_map); i++) {
+            if (g_strcmp0(curr->data, feature_map[i].ns) == 0) {
+                result |= feature_map[i].feature;
+                break;
+            }
+        }
+        curr = g_slist_next(curr);
     }
+
+    return result;
 }
 
 char *
@@ -495,6 +709,7 @@ caps_create(xmpp_stanza_t *query)
     }
 
     Capabilities *new_caps = malloc(sizeof(struct capabilities_t));
+    new_caps->refcount = 1;
 
     if (category) {
         new_caps->category = strdup(category);
@@ -536,6 +751,7 @@ caps_create(xmpp_stanza_t *query)
     } else {
         new_caps->features = NULL;
     }
+    new_caps->feature_bits = _caps_feature_bits(new_caps->features);
 
     return new_caps;
 }
@@ -650,14 +866,35 @@ caps_create_query_response_stanza(xmpp_ctx_t * const ctx)
 void
 caps_close(void)
 {
+    persist_flush(_write_cache);
     g_key_file_free(cache);
     cache = NULL;
     g_hash_table_destroy(jid_to_ver);
     g_hash_table_destroy(jid_to_caps);
+    g_hash_table_destroy(ver_to_caps);
+    g_hash_table_destroy(ver_to_request);
+}
+
+Capabilities *
+caps_ref(Capabilities *caps)
+{
+    caps->refcount++;
+    return caps;
 }
 
 void
-caps_destroy(Capabilities *caps)
+caps_unref(Capabilities *caps)
+{
+    if (caps) {
+        caps->refcount--;
+        if (caps->refcount == 0) {
+            _caps_free(caps);
+        }
+    }
+}
+
+static void
+_caps_free(Capabilities *caps)
 {
     if (caps) {
         free(caps->category);
@@ -690,9 +927,11 @@ _get_cache_file(void)
 static void
 _save_cache(void)
 {
-    gsize g_data_size;
-    gchar *g_cache_data = g_key_file_to_data(cache, &g_data_size, NULL);
-    g_file_set_contents(cache_loc, g_cache_data, g_data_size, NULL);
-    g_chmod(cache_loc, S_IRUSR | S_IWUSR);
-    g_free(g_cache_data);
+    persist_schedule(_write_cache);
+}
+
+static void
+_write_cache(void)
+{
+    persist_write_keyfile(cache, cache_loc);
 }
@@ -46,11 +46,21 @@
 
 #include "xmpp/xmpp.h"
 
+// milliseconds to wait for a disco#info response before asking another JID
+#define CAPS_REQUEST_TIMEOUT 10000
+
 void caps_init(void);
 
 void caps_add_by_ver(const char * const ver, Capabilities *caps);
 void caps_add_by_jid(const char * const jid, Capabilities *caps);
 void caps_map_jid_to_ver(const char * const jid, const char * const ver);
+void caps_remove_jid(const char * const jid);
+void caps_clear_jids(void);
+
+void caps_request(const char * const jid, const char * const node, const char * const ver);
+void caps_request_complete(const char * const ver);
+void caps_request_failed(const char * const jid);
+void caps_request_check_timeouts(void);
 gboolean caps_contains(const char * const ver);
 
 char* caps_create_sha1_str(xmpp_stanza_t * const query);
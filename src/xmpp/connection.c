@@ -60,6 +60,7 @@
 #include "xmpp/message.h"
 #include "xmpp/presence.h"
 #include "xmpp/roster.h"
+#include "xmpp/sm.h"
 #include "xmpp/stanza.h"
 #include "xmpp/xmpp.h"
 
@@ -72,6 +73,11 @@ static struct _jabber_conn_t {
     int priority;
     int tls_disabled;
     char *domain;
+    Jid *jid;
+    int cork_depth;
+    GString *corked;
+    GArray *corked_sizes;
+    gboolean rosterver;
 } jabber_conn;
 
 static GHashTable *available_resources;
@@ -105,6 +111,8 @@ static jabber_conn_status_t _jabber_connect(const char * const fulljid,
     const char * const passwd, const char * const altdomain, int port);
 
 static void _jabber_reconnect(void);
+static void _connection_flush(void);
+static void _connection_log_sent(const char * const text, gsize text_size);
 
 static void _connection_handler(xmpp_conn_t * const conn,
     const xmpp_conn_event_t status, const int error,
@@ -124,6 +132,10 @@ jabber_init(const int disable_tls)
     jabber_conn.ctx = NULL;
     jabber_conn.tls_disabled = disable_tls;
     jabber_conn.domain = NULL;
+    jabber_conn.jid = NULL;
+    jabber_conn.cork_depth = 0;
+    jabber_conn.corked = g_string_new(NULL);
+    jabber_conn.corked_sizes = g_array_new(FALSE, FALSE, sizeof(gsize));
     presence_sub_requests_init();
     caps_init();
     available_resources = g_hash_table_new_full(g_str_hash, g_str_equal, free,
@@ -201,6 +213,7 @@ jabber_disconnect(void)
     if (jabber_conn.conn_status == JABBER_CONNECTED) {
         log_info("Closing connection");
         accounts_set_last_activity(jabber_get_account_name());
+        _connection_flush();
         jabber_conn.conn_status = JABBER_DISCONNECTING;
         xmpp_disconnect(jabber_conn.conn);
 
@@ -223,17 +236,84 @@ jabber_disconnect(void)
     jabber_conn.conn_status = JABBER_STARTED;
     FREE_SET_NULL(jabber_conn.presence_message);
     FREE_SET_NULL(jabber_conn.domain);
+    jid_destroy(jabber_conn.jid);
+    jabber_conn.jid = NULL;
+    jabber_conn.cork_depth = 0;
+    g_string_truncate(jabber_conn.corked, 0);
+    g_array_set_size(jabber_conn.corked_sizes, 0);
+    sm_reset();
 }
 
 void
 jabber_shutdown(void)
 {
+    roster_cache_close();
     _connection_free_saved_account();
     _connection_free_saved_details();
     _connection_free_session_data();
     xmpp_shutdown();
     free(jabber_conn.log);
     jabber_conn.log = NULL;
+    if (jabber_conn.corked) {
+        g_string_free(jabber_conn.corked, TRUE);
+        jabber_conn.corked = NULL;
+    }
+    if (jabber_conn.corked_sizes) {
+        g_array_free(jabber_conn.corked_sizes, TRUE);
+        jabber_conn.corked_sizes = NULL;
+    }
+}
+
+// hold outgoing stanzas until the matching jabber_uncork, calls may nest
+void
+jabber_cork(void)
+{
+    jabber_conn.cork_depth++;
+}
+
+void
+jabber_uncork(void)
+{
+    if (jabber_conn.cork_depth == 0) {
+        return;
+    }
+
+    jabber_conn.cork_depth--;
+    if (jabber_conn.cork_depth == 0) {
+        _connection_flush();
+    }
+}
+
+void
+connection_send_stanza(xmpp_stanza_t * const stanza)
+{
+    if (jabber_conn.cork_depth == 0 && !sm_is_active()) {
+        xmpp_send(jabber_conn.conn, stanza);
+        return;
+    }
+
+    // serialise now, the caller may change or release the stanza
+    char *text = NULL;
+    size_t text_size = 0;
+    if (xmpp_stanza_to_text(stanza, &text, &text_size) == XMPP_EOK) {
+        connection_send_text(text, text_size);
+        xmpp_free(jabber_conn.ctx, text);
+    }
+}
+
+// send a serialised stanza
+void
+connection_send_text(const char * const text, size_t text_size)
+{
+    sm_stanza_sent(text);
+
+    if (jabber_conn.cork_depth == 0) {
+        _connection_log_sent(text, text_size);
+        xmpp_send_raw(jabber_conn.conn, text, text_size);
+    } else {
+        g_string_append_len(jabber_conn.corked, text, text_size);
+        g_array_append_val(jabber_conn.corked_sizes, text_size);
+    }
 }
 
 void
@@ -262,6 +342,38 @@ jabber_process_events(int millis)
     }
 }
 
+// write corked stanzas as a single send
+static void
+_connection_flush(void)
+{
+    if (jabber_conn.corked->len == 0) {
+        return;
+    }
+
+    if (jabber_conn.conn && jabber_conn.conn_status == JABBER_CONNECTED) {
+        // one SENT line per stanza, as xmpp_send would have logged them
+        gsize offset = 0;
+        guint i;
+        for (i = 0; i < jabber_conn.corked_sizes->len; i++) {
+            gsize size = g_array_index(jabber_conn.corked_sizes, gsize, i);
+            _connection_log_sent(jabber_conn.corked->str + offset, size);
+            offset += size;
+        }
+        xmpp_send_raw(jabber_conn.conn, jabber_conn.corked->str, jabber_conn.corked->len);
+    }
+    g_string_truncate(jabber_conn.corked, 0);
+    g_array_set_size(jabber_conn.corked_sizes, 0);
+}
+
+// xmpp_send_raw does not log, write the line xmpp_send would
+static void
+_connection_log_sent(const char * const text, gsize text_size)
+{
+    char *msg = g_strdup_printf("SENT: %.*s", (int)text_size, text);
+    _xmpp_file_logger(NULL, XMPP_LEVEL_DEBUG, "conn", msg);
+    g_free(msg);
+}
+
 GList *
 jabber_get_available_resources(void)
 {
@@ -286,6 +398,20 @@ connection_get_ctx(void)
     return jabber_conn.ctx;
 }
 
+// whether the server advertised roster versioning in its stream features
+gboolean
+connection_supports_rosterver(void)
+{
+    return jabber_conn.rosterver;
+}
+
+// our own jid, parsed once per connection
+Jid *
+jabber_get_jid(void)
+{
+    return jabber_conn.jid;
+}
+
 const char *
 jabber_get_fulljid(void)
 {
@@ -357,6 +483,7 @@ void
 _connection_free_session_data(void)
 {
     g_hash_table_remove_all(available_resources);
+    caps_clear_jids();
     chat_sessions_clear();
     presence_clear_sub_requests();
 }
@@ -393,6 +520,7 @@ _jabber_connect(const char * const fulljid, const char * const passwd,
     jid_destroy(jid);
 
     log_info("Connecting as %s", fulljid);
+    jabber_conn.rosterver = FALSE;
     if (jabber_conn.log) {
         free(jabber_conn.log);
     }
@@ -487,9 +615,10 @@ _connection_handler(xmpp_conn_t * const conn,
             _connection_free_saved_details();
         }
 
-        Jid *my_jid = jid_create(jabber_get_fulljid());
-        jabber_conn.domain = strdup(my_jid->domainpart);
-        jid_destroy(my_jid);
+        jid_destroy(jabber_conn.jid);
+        jabber_conn.jid = jid_create(jabber_get_fulljid());
+        FREE_SET_NULL(jabber_conn.domain);
+        jabber_conn.domain = strdup(jabber_conn.jid->domainpart);
 
         chat_sessions_init();
 
@@ -497,6 +626,12 @@ _connection_handler(xmpp_conn_t * const conn,
         message_add_handlers();
         presence_add_handlers();
         iq_add_handlers();
+        sm_add_handlers();
+
+        if (prefs_get_boolean(PREF_SM)) {
+            sm_enable();
+        }
+        sm_resend_lost();
 
         roster_request();
         bookmark_request();
@@ -526,10 +661,12 @@ _connection_handler(xmpp_conn_t * const conn,
                 reconnect_timer = g_timer_new();
                 // free resources but leave saved_user untouched
                 _connection_free_session_data();
+                sm_connection_lost();
             } else {
                 _connection_free_saved_account();
                 _connection_free_saved_details();
                 _connection_free_session_data();
+                sm_reset();
             }
 
         // login attempt failed
@@ -541,6 +678,7 @@ _connection_handler(xmpp_conn_t * const conn,
                 _connection_free_saved_account();
                 _connection_free_saved_details();
                 _connection_free_session_data();
+                sm_reset();
             } else {
                 log_debug("Connection handler: Restarting reconnect timer");
                 if (prefs_get_reconnect() != 0) {
@@ -598,6 +736,12 @@ _xmpp_file_logger(void * const userdata, const xmpp_log_level_t level,
     log_msg(prof_level, area, msg);
     if ((g_strcmp0(area, "xmpp") == 0) || (g_strcmp0(area, "conn")) == 0) {
         sv_ev_xmpp_stanza(msg);
+
+        // libstrophe handles stream features itself, this log line is the
+        // only place they can be seen, the last features before login win
+        if (g_str_has_prefix(msg, "RECV: <stream:features")) {
+            jabber_conn.rosterver = (strstr(msg, STANZA_NS_ROSTERVER) != NULL);
+        }
     }
 }
 
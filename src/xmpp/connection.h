@@ -52,5 +52,8 @@ void connection_set_priority(int priority);
 void connection_set_presence_message(const char * const message);
 void connection_add_available_resource(Resource *resource);
 void connection_remove_available_resource(const char * const resource);
+void connection_send_stanza(xmpp_stanza_t * const stanza);
+void connection_send_text(const char * const text, size_t text_size);
+gboolean connection_supports_rosterver(void);
 
 #endif
@@ -93,6 +93,7 @@ static int _enable_carbons_handler(xmpp_conn_t * const conn, xmpp_stanza_t * con
 static int _disable_carbons_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
 static int _manual_pong_handler(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza, void * const userdata);
 static int _ping_timed_handler(xmpp_conn_t * const conn, void * const userdata);
+static int _caps_request_timed_handler(xmpp_conn_t * const conn, void * const userdata);
 static int _caps_response_handler(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza, void * const userdata);
 static int _caps_response_handler_for_jid(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza, void * const userdata);
 static int _caps_response_handler_legacy(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza, void * const userdata);
@@ -120,6 +121,8 @@ iq_add_handlers(void)
         int millis = prefs_get_autoping() * 1000;
         xmpp_timed_handler_add(conn, _ping_timed_handler, millis, ctx);
     }
+
+    xmpp_timed_handler_add(conn, _caps_request_timed_handler, CAPS_REQUEST_TIMEOUT, NULL);
 }
 
 void
@@ -142,10 +145,9 @@ iq_set_autoping(const int seconds)
 void
 iq_room_list_request(gchar *conferencejid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *iq = stanza_create_disco_items_iq(ctx, "confreq", conferencejid);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -159,7 +161,7 @@ iq_enable_carbons()
 
     xmpp_id_handler_add(conn, _enable_carbons_handler, id, NULL);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -173,7 +175,7 @@ iq_disable_carbons()
 
     xmpp_id_handler_add(conn, _disable_carbons_handler, id, NULL);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -189,7 +191,7 @@ iq_disco_info_request(gchar *jid)
 
     free(id);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -205,7 +207,7 @@ iq_last_activity_request(gchar *jid)
 
     free(id);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -225,7 +227,7 @@ iq_room_info_request(const char * const room, gboolean display_result)
 
     free(id);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -254,7 +256,7 @@ iq_send_caps_request_for_jid(const char * const to, const char * const id,
 
     xmpp_id_handler_add(conn, _caps_response_handler_for_jid, id, strdup(to));
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -281,7 +283,7 @@ iq_send_caps_request(const char * const to, const char * const id,
 
     xmpp_id_handler_add(conn, _caps_response_handler, id, NULL);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -308,17 +310,16 @@ iq_send_caps_request_legacy(const char * const to, const char * const id,
     xmpp_id_handler_add(conn, _caps_response_handler_legacy, id, node_str->str);
     g_string_free(node_str, FALSE);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
 void
 iq_disco_items_request(gchar *jid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *iq = stanza_create_disco_items_iq(ctx, "discoitemsreq", jid);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -332,17 +333,16 @@ iq_send_software_version(const char * const fulljid)
     char *id = xmpp_stanza_get_id(iq);
     xmpp_id_handler_add(conn, _version_result_handler, id, strdup(fulljid));
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
 void
 iq_confirm_instant_room(const char * const room_jid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *iq = stanza_create_instant_room_request_iq(ctx, room_jid);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -356,7 +356,7 @@ iq_destroy_room(const char * const room_jid)
     char *id = xmpp_stanza_get_id(iq);
     xmpp_id_handler_add(conn, _destroy_room_result_handler, id, NULL);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -370,7 +370,7 @@ iq_request_room_config_form(const char * const room_jid)
     char *id = xmpp_stanza_get_id(iq);
     xmpp_id_handler_add(conn, _room_config_handler, id, NULL);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -384,17 +384,16 @@ iq_submit_room_config(const char * const room, DataForm *form)
     char *id = xmpp_stanza_get_id(iq);
     xmpp_id_handler_add(conn, _room_config_submit_handler, id, NULL);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
 void
 iq_room_config_cancel(const char * const room_jid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *iq = stanza_create_room_config_cancel_iq(ctx, room_jid);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -408,7 +407,7 @@ iq_room_affiliation_list(const char * const room, char *affiliation)
     char *id = xmpp_stanza_get_id(iq);
     xmpp_id_handler_add(conn, _room_affiliation_list_result_handler, id, strdup(affiliation));
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -422,7 +421,7 @@ iq_room_kick_occupant(const char * const room, const char * const nick, const ch
     char *id = xmpp_stanza_get_id(iq);
     xmpp_id_handler_add(conn, _room_kick_result_handler, id, strdup(nick));
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -447,7 +446,7 @@ iq_room_affiliation_set(const char * const room, const char * const jid, char *a
 
     xmpp_id_handler_add(conn, _room_affiliation_set_result_handler, id, affiliation_set);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -467,7 +466,7 @@ iq_room_role_set(const char * const room, const char * const nick, char *role,
 
     xmpp_id_handler_add(conn, _room_role_set_result_handler, id, role_set);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -481,7 +480,7 @@ iq_room_role_list(const char * const room, char *role)
     char *id = xmpp_stanza_get_id(iq);
     xmpp_id_handler_add(conn, _room_role_list_result_handler, id, strdup(role));
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -496,7 +495,7 @@ iq_send_ping(const char * const target)
     GDateTime *now = g_date_time_new_now_local();
     xmpp_id_handler_add(conn, _manual_pong_handler, id, now);
 
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -590,17 +589,20 @@ _caps_response_handler(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza,
         char *error_message = stanza_get_error_message(stanza);
         log_warning("Error received for capabilities response from %s: ", from, error_message);
         free(error_message);
+        caps_request_failed(from);
         return 0;
     }
 
     if (query == NULL) {
         log_warning("No query element found.");
+        caps_request_failed(from);
         return 0;
     }
 
     char *node = xmpp_stanza_get_attribute(query, STANZA_ATTR_NODE);
     if (node == NULL) {
         log_warning("No node attribute found");
+        caps_request_failed(from);
         return 0;
     }
 
@@ -613,6 +615,7 @@ _caps_response_handler(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza,
         log_warning("Generated sha-1 does not match given:");
         log_warning("Generated : %s", generated_sha1);
         log_warning("Given     : %s", given_sha1);
+        caps_request_failed(from);
     } else {
         log_info("Valid SHA-1 hash found: %s", given_sha1);
 
@@ -622,10 +625,11 @@ _caps_response_handler(xmpp_conn_t *const conn, xmpp_stanza_t * const stanza,
             log_info("Capabilities not cached: %s, storing", given_sha1);
             Capabilities *capabilities = caps_create(query);
             caps_add_by_ver(given_sha1, capabilities);
-            caps_destroy(capabilities);
+            caps_unref(capabilities);
         }
 
         caps_map_jid_to_ver(from, given_sha1);
+        caps_request_complete(given_sha1);
     }
 
     g_free(generated_sha1);
@@ -752,7 +756,7 @@ _caps_response_handler_legacy(xmpp_conn_t *const conn, xmpp_stanza_t * const sta
             log_info("Capabilities not cached: %s, storing", node);
             Capabilities *capabilities = caps_create(query);
             caps_add_by_ver(node, capabilities);
-            caps_destroy(capabilities);
+            caps_unref(capabilities);
         }
 
         caps_map_jid_to_ver(from, node);
@@ -850,13 +854,23 @@ _ping_timed_handler(xmpp_conn_t * const conn, void * const userdata)
         // add pong handler
         xmpp_id_handler_add(conn, _pong_handler, id, ctx);
 
-        xmpp_send(conn, iq);
+        connection_send_stanza(iq);
         xmpp_stanza_release(iq);
     }
 
     return 1;
 }
 
+static int
+_caps_request_timed_handler(xmpp_conn_t * const conn, void * const userdata)
+{
+    if (jabber_get_connection_status() == JABBER_CONNECTED) {
+        caps_request_check_timeouts();
+    }
+
+    return 1;
+}
+
 static int
 _version_result_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
     void * const userdata)
@@ -981,7 +995,7 @@ _ping_get_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
         xmpp_stanza_set_attribute(pong, STANZA_ATTR_ID, id);
     }
 
-    xmpp_send(conn, pong);
+    connection_send_stanza(pong);
     xmpp_stanza_release(pong);
 
     return 1;
@@ -1041,7 +1055,7 @@ _version_get_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
         xmpp_stanza_add_child(query, version);
         xmpp_stanza_add_child(response, query);
 
-        xmpp_send(conn, response);
+        connection_send_stanza(response);
 
         g_string_free(version_str, TRUE);
         xmpp_stanza_release(name_txt);
@@ -1079,7 +1093,7 @@ _disco_items_get_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
         xmpp_stanza_set_name(query, STANZA_NAME_QUERY);
         xmpp_stanza_set_ns(query, XMPP_NS_DISCO_ITEMS);
         xmpp_stanza_add_child(response, query);
-        xmpp_send(conn, response);
+        connection_send_stanza(response);
 
         xmpp_stanza_release(response);
     }
@@ -1112,7 +1126,7 @@ _last_activity_get_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanz
 
         xmpp_stanza_add_child(response, query);
 
-        xmpp_send(conn, response);
+        connection_send_stanza(response);
 
         xmpp_stanza_release(query);
         xmpp_stanza_release(response);
@@ -1150,7 +1164,7 @@ _disco_info_get_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
             xmpp_stanza_set_attribute(query, STANZA_ATTR_NODE, node_str);
         }
         xmpp_stanza_add_child(response, query);
-        xmpp_send(conn, response);
+        connection_send_stanza(response);
 
         xmpp_stanza_release(query);
         xmpp_stanza_release(response);
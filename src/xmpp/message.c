@@ -59,15 +59,15 @@
 #include "xmpp/xmpp.h"
 #include "pgp/gpg.h"
 
-#define HANDLE(ns, type, func) xmpp_handler_add(conn, func, ns, STANZA_NAME_MESSAGE, type, ctx)
-
-static int _groupchat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
-static int _chat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
-static int _muc_user_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
-static int _conference_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
-static int _captcha_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
-static int _message_error_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
-static int _receipt_received_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _message_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static void _handle_error(xmpp_stanza_t * const stanza, XMPPMessageFields *fields);
+static void _handle_groupchat(xmpp_stanza_t * const stanza, XMPPMessageFields *fields);
+static void _handle_chat(xmpp_stanza_t * const stanza, XMPPMessageFields *fields);
+static void _handle_muc_user(XMPPMessageFields *fields);
+static void _handle_conference(XMPPMessageFields *fields);
+static void _handle_captcha(XMPPMessageFields *fields);
+static void _handle_receipt_received(XMPPMessageFields *fields);
+static gboolean _handle_carbons(xmpp_stanza_t * const carbons);
 
 void
 message_add_handlers(void)
@@ -75,13 +75,38 @@ message_add_handlers(void)
     xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
 
-    HANDLE(NULL,                 STANZA_TYPE_ERROR,      _message_error_handler);
-    HANDLE(NULL,                 STANZA_TYPE_GROUPCHAT,  _groupchat_handler);
-    HANDLE(NULL,                 NULL,                   _chat_handler);
-    HANDLE(STANZA_NS_MUC_USER,   NULL,                   _muc_user_handler);
-    HANDLE(STANZA_NS_CONFERENCE, NULL,                   _conference_handler);
-    HANDLE(STANZA_NS_CAPTCHA,    NULL,                   _captcha_handler);
-    HANDLE(STANZA_NS_RECEIPTS,   NULL,                   _receipt_received_handler);
+    xmpp_handler_add(conn, _message_handler, NULL, STANZA_NAME_MESSAGE, NULL, ctx);
+}
+
+static int
+_message_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    XMPPMessageFields fields;
+    stanza_parse_message_fields(stanza, &fields);
+
+    if (g_strcmp0(fields.type, STANZA_TYPE_ERROR) == 0) {
+        _handle_error(stanza, &fields);
+    } else if (g_strcmp0(fields.type, STANZA_TYPE_GROUPCHAT) == 0) {
+        _handle_groupchat(stanza, &fields);
+    } else if (fields.type == NULL || g_strcmp0(fields.type, STANZA_TYPE_CHAT) == 0) {
+        _handle_chat(stanza, &fields);
+    }
+
+    // extensions are handled whatever the message type
+    if (fields.muc_user) {
+        _handle_muc_user(&fields);
+    }
+    if (fields.conference) {
+        _handle_conference(&fields);
+    }
+    if (fields.captcha) {
+        _handle_captcha(&fields);
+    }
+    if (fields.receipts) {
+        _handle_receipt_received(&fields);
+    }
+
+    return 1;
 }
 
 static char*
@@ -106,8 +131,18 @@ _session_state(const char * const barejid)
     ChatSession *session = chat_session_get(barejid);
     char *state = NULL;
     if (session) {
-        if (prefs_get_boolean(PREF_STATES) && session->send_states) {
-            state = STANZA_NAME_ACTIVE;
+        if (prefs_get_boolean(PREF_STATES)) {
+            if (session->send_states) {
+                state = STANZA_NAME_ACTIVE;
+            } else {
+                GString *fulljid = g_string_new(session->barejid);
+                g_string_append(fulljid, "/");
+                g_string_append(fulljid, session->resource);
+                if (caps_jid_has_feature(fulljid->str, FEATURE_CHATSTATES)) {
+                    state = STANZA_NAME_ACTIVE;
+                }
+                g_string_free(fulljid, TRUE);
+            }
         }
     } else {
         if (prefs_get_boolean(PREF_STATES)) {
@@ -121,7 +156,6 @@ _session_state(const char * const barejid)
 char *
 message_send_chat(const char * const barejid, const char * const msg)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
 
     char *state = _session_state(barejid);
@@ -139,7 +173,7 @@ message_send_chat(const char * const barejid, const char * const msg)
         stanza_attach_receipt_request(ctx, message);
     }
 
-    xmpp_send(conn, message);
+    connection_send_stanza(message);
     xmpp_stanza_release(message);
 
     return id;
@@ -148,7 +182,6 @@ message_send_chat(const char * const barejid, const char * const msg)
 char *
 message_send_chat_pgp(const char * const barejid, const char * const msg)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
 
     char *state = _session_state(barejid);
@@ -197,7 +230,7 @@ message_send_chat_pgp(const char * const barejid, const char * const msg)
         stanza_attach_receipt_request(ctx, message);
     }
 
-    xmpp_send(conn, message);
+    connection_send_stanza(message);
     xmpp_stanza_release(message);
 
     return id;
@@ -206,7 +239,6 @@ message_send_chat_pgp(const char * const barejid, const char * const msg)
 char *
 message_send_chat_otr(const char * const barejid, const char * const msg)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
 
     char *state = _session_state(barejid);
@@ -228,7 +260,7 @@ message_send_chat_otr(const char * const barejid, const char * const msg)
         stanza_attach_receipt_request(ctx, message);
     }
 
-    xmpp_send(conn, message);
+    connection_send_stanza(message);
     xmpp_stanza_release(message);
 
     return id;
@@ -237,37 +269,34 @@ message_send_chat_otr(const char * const barejid, const char * const msg)
 void
 message_send_private(const char * const fulljid, const char * const msg)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     char *id = create_unique_id("prv");
     xmpp_stanza_t *message = stanza_create_message(ctx, id, fulljid, STANZA_TYPE_CHAT, msg);
     free(id);
 
-    xmpp_send(conn, message);
+    connection_send_stanza(message);
     xmpp_stanza_release(message);
 }
 
 void
 message_send_groupchat(const char * const roomjid, const char * const msg)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     char *id = create_unique_id("muc");
     xmpp_stanza_t *message = stanza_create_message(ctx, id, roomjid, STANZA_TYPE_GROUPCHAT, msg);
     free(id);
 
-    xmpp_send(conn, message);
+    connection_send_stanza(message);
     xmpp_stanza_release(message);
 }
 
 void
 message_send_groupchat_subject(const char * const roomjid, const char * const subject)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *message = stanza_create_room_subject_message(ctx, roomjid, subject);
 
-    xmpp_send(conn, message);
+    connection_send_stanza(message);
     xmpp_stanza_release(message);
 }
 
@@ -275,7 +304,6 @@ void
 message_send_invite(const char * const roomjid, const char * const contact,
     const char * const reason)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *stanza;
 
@@ -290,18 +318,17 @@ message_send_invite(const char * const roomjid, const char * const contact,
         stanza = stanza_create_mediated_invite(ctx, roomjid, contact, reason);
     }
 
-    xmpp_send(conn, stanza);
+    connection_send_stanza(stanza);
     xmpp_stanza_release(stanza);
 }
 
 void
 message_send_composing(const char * const jid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
 
     xmpp_stanza_t *stanza = stanza_create_chat_state(ctx, jid, STANZA_NAME_COMPOSING);
-    xmpp_send(conn, stanza);
+    connection_send_stanza(stanza);
     xmpp_stanza_release(stanza);
 
 }
@@ -309,43 +336,39 @@ message_send_composing(const char * const jid)
 void
 message_send_paused(const char * const jid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *stanza = stanza_create_chat_state(ctx, jid, STANZA_NAME_PAUSED);
-    xmpp_send(conn, stanza);
+    connection_send_stanza(stanza);
     xmpp_stanza_release(stanza);
 }
 
 void
 message_send_inactive(const char * const jid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *stanza = stanza_create_chat_state(ctx, jid, STANZA_NAME_INACTIVE);
 
-    xmpp_send(conn, stanza);
+    connection_send_stanza(stanza);
     xmpp_stanza_release(stanza);
 }
 
 void
 message_send_gone(const char * const jid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *stanza = stanza_create_chat_state(ctx, jid, STANZA_NAME_GONE);
-    xmpp_send(conn, stanza);
+    connection_send_stanza(stanza);
     xmpp_stanza_release(stanza);
 }
 
-static int
-_message_error_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+static void
+_handle_error(xmpp_stanza_t * const stanza, XMPPMessageFields *fields)
 {
     char *id = xmpp_stanza_get_id(stanza);
-    char *jid = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
-    xmpp_stanza_t *error_stanza = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_ERROR);
+    char *jid = fields->from;
     char *type = NULL;
-    if (error_stanza) {
-        type = xmpp_stanza_get_attribute(error_stanza, STANZA_ATTR_TYPE);
+    if (fields->error) {
+        type = xmpp_stanza_get_attribute(fields->error, STANZA_ATTR_TYPE);
     }
 
     // stanza_get_error never returns NULL
@@ -383,37 +406,35 @@ _message_error_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, v
     }
 
     free(err_msg);
-
-    return 1;
 }
 
-static int
-_muc_user_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+static void
+_handle_muc_user(XMPPMessageFields *fields)
 {
     xmpp_ctx_t *ctx = connection_get_ctx();
-    xmpp_stanza_t *xns_muc_user = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_MUC_USER);
-    char *room = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    xmpp_stanza_t *xns_muc_user = fields->muc_user;
+    char *room = fields->from;
 
     if (!room) {
         log_warning("Message received with no from attribute, ignoring");
-        return 1;
+        return;
     }
 
     // XEP-0045
     xmpp_stanza_t *invite = xmpp_stanza_get_child_by_name(xns_muc_user, STANZA_NAME_INVITE);
     if (!invite) {
-        return 1;
+        return;
     }
 
     char *invitor_jid = xmpp_stanza_get_attribute(invite, STANZA_ATTR_FROM);
     if (!invitor_jid) {
         log_warning("Chat room invite received with no from attribute");
-        return 1;
+        return;
     }
 
     Jid *jidp = jid_create(invitor_jid);
     if (!jidp) {
-        return 1;
+        return;
     }
     char *invitor = jidp->barejid;
 
@@ -437,31 +458,29 @@ _muc_user_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void *
     if (password) {
         xmpp_free(ctx, password);
     }
-
-    return 1;
 }
 
-static int
-_conference_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+static void
+_handle_conference(XMPPMessageFields *fields)
 {
-    xmpp_stanza_t *xns_conference = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_CONFERENCE);
+    xmpp_stanza_t *xns_conference = fields->conference;
 
-    char *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    char *from = fields->from;
     if (!from) {
         log_warning("Message received with no from attribute, ignoring");
-        return 1;
+        return;
     }
 
     Jid *jidp = jid_create(from);
     if (!jidp) {
-        return 1;
+        return;
     }
 
     // XEP-0249
     char *room = xmpp_stanza_get_attribute(xns_conference, STANZA_ATTR_JID);
     if (!room) {
         jid_destroy(jidp);
-        return 1;
+        return;
     }
 
     char *reason = xmpp_stanza_get_attribute(xns_conference, STANZA_ATTR_REASON);
@@ -469,103 +488,95 @@ _conference_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void
 
     sv_ev_room_invite(INVITE_DIRECT, jidp->barejid, room, reason, password);
     jid_destroy(jidp);
-
-    return 1;
 }
 
-static int
-_captcha_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+static void
+_handle_captcha(XMPPMessageFields *fields)
 {
     xmpp_ctx_t *ctx = connection_get_ctx();
-    char *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    char *from = fields->from;
 
     if (!from) {
         log_warning("Message received with no from attribute, ignoring");
-        return 1;
+        return;
     }
 
     // XEP-0158
-    xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
-    if (!body) {
-        return 1;
+    if (!fields->body) {
+        return;
     }
 
-    char *message = xmpp_stanza_get_text(body);
+    char *message = xmpp_stanza_get_text(fields->body);
     if (!message) {
-        return 1;
+        return;
     }
 
     sv_ev_room_broadcast(from, message);
     xmpp_free(ctx, message);
-
-    return 1;
 }
 
-static int
-_groupchat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+static void
+_handle_groupchat(xmpp_stanza_t * const stanza, XMPPMessageFields *fields)
 {
     xmpp_ctx_t *ctx = connection_get_ctx();
     char *message = NULL;
-    char *room_jid = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    char *room_jid = fields->from;
     Jid *jid = jid_create(room_jid);
 
     // handle room subject
-    xmpp_stanza_t *subject = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_SUBJECT);
-    if (subject) {
-        message = xmpp_stanza_get_text(subject);
+    if (fields->subject) {
+        message = xmpp_stanza_get_text(fields->subject);
         sv_ev_room_subject(jid->barejid, jid->resourcepart, message);
         xmpp_free(ctx, message);
 
         jid_destroy(jid);
-        return 1;
+        return;
     }
 
     // handle room broadcasts
+    xmpp_stanza_t *body = fields->body;
     if (!jid->resourcepart) {
-        xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
         if (!body) {
             jid_destroy(jid);
-            return 1;
+            return;
         }
 
         message = xmpp_stanza_get_text(body);
         if (!message) {
             jid_destroy(jid);
-            return 1;
+            return;
         }
 
         sv_ev_room_broadcast(room_jid, message);
         xmpp_free(ctx, message);
 
         jid_destroy(jid);
-        return 1;
+        return;
     }
 
     if (!jid_is_valid_room_form(jid)) {
         log_error("Invalid room JID: %s", jid->str);
         jid_destroy(jid);
-        return 1;
+        return;
     }
 
     // room not active in profanity
     if (!muc_active(jid->barejid)) {
         log_error("Message received for inactive chat room: %s", jid->str);
         jid_destroy(jid);
-        return 1;
+        return;
     }
 
-    xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
-
     // check for and deal with message
     if (!body) {
         jid_destroy(jid);
-        return 1;
+        return;
     }
 
     message = xmpp_stanza_get_text(body);
     if (!message) {
         jid_destroy(jid);
-        return 1;
+        return;
     }
 
     // determine if the notifications happened whilst offline
@@ -579,14 +590,11 @@ _groupchat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void
 
     xmpp_free(ctx, message);
     jid_destroy(jid);
-
-    return 1;
 }
 
 void
 _message_send_receipt(const char * const fulljid, const char * const message_id)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *message = xmpp_stanza_new(ctx);
     xmpp_stanza_set_name(message, STANZA_NAME_MESSAGE);
@@ -603,38 +611,36 @@ _message_send_receipt(const char * const fulljid, const char * const message_id)
     xmpp_stanza_add_child(message, receipt);
     xmpp_stanza_release(receipt);
 
-    xmpp_send(conn, message);
+    connection_send_stanza(message);
     xmpp_stanza_release(message);
 }
 
-static int
-_receipt_received_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+static void
+_handle_receipt_received(XMPPMessageFields *fields)
 {
-    xmpp_stanza_t *receipt = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_RECEIPTS);
+    xmpp_stanza_t *receipt = fields->receipts;
     char *name = xmpp_stanza_get_name(receipt);
     if (g_strcmp0(name, "received") != 0) {
-        return 1;
+        return;
     }
 
     char *id = xmpp_stanza_get_attribute(receipt, STANZA_ATTR_ID);
     if (!id) {
-        return 1;
+        return;
     }
 
-    char *fulljid = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    char *fulljid = fields->from;
     if (!fulljid) {
-        return 1;
+        return;
     }
 
     Jid *jidp = jid_create(fulljid);
     sv_ev_message_receipt(jidp->barejid, id);
     jid_destroy(jidp);
-
-    return 1;
 }
 
 void
-_receipt_request_handler(xmpp_stanza_t * const stanza)
+_receipt_request_handler(xmpp_stanza_t * const stanza, XMPPMessageFields *fields)
 {
     if (!prefs_get_boolean(PREF_RECEIPTS_SEND)) {
         return;
@@ -645,7 +651,7 @@ _receipt_request_handler(xmpp_stanza_t * const stanza)
         return;
     }
 
-    xmpp_stanza_t *receipts = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_RECEIPTS);
+    xmpp_stanza_t *receipts = fields->receipts;
     if (!receipts) {
         return;
     }
@@ -655,16 +661,14 @@ _receipt_request_handler(xmpp_stanza_t * const stanza)
         return;
     }
 
-    gchar *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
-    Jid *jid = jid_create(from);
+    Jid *jid = jid_create(fields->from);
     _message_send_receipt(jid->fulljid, id);
     jid_destroy(jid);
 }
 
 void
-_private_chat_handler(xmpp_stanza_t * const stanza, const char * const fulljid)
+_private_chat_handler(xmpp_stanza_t * const stanza, xmpp_stanza_t * const body, const char * const fulljid)
 {
-    xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
     if (!body) {
         return;
     }
@@ -687,9 +691,8 @@ _private_chat_handler(xmpp_stanza_t * const stanza, const char * const fulljid)
 }
 
 static gboolean
-_handle_carbons(xmpp_stanza_t * const stanza)
+_handle_carbons(xmpp_stanza_t * const carbons)
 {
-    xmpp_stanza_t *carbons = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_CARBONS);
     if (!carbons) {
         return FALSE;
     }
@@ -709,7 +712,7 @@ _handle_carbons(xmpp_stanza_t * const stanza)
 
         Jid *jid_from = jid_create(from);
         Jid *jid_to = jid_create(to);
-        Jid *my_jid = jid_create(jabber_get_fulljid());
+        Jid *my_jid = jid_ref(jabber_get_jid());
 
         // check for and deal with message
         xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(message, STANZA_NAME_BODY);
@@ -738,45 +741,35 @@ _handle_carbons(xmpp_stanza_t * const stanza)
     return FALSE;
 }
 
-static int
-_chat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+static void
+_handle_chat(xmpp_stanza_t * const stanza, XMPPMessageFields *fields)
 {
-    // ignore if type not chat or absent
-    char *type = xmpp_stanza_get_type(stanza);
-    if (!(g_strcmp0(type, "chat") == 0 || type == NULL)) {
-        return 1;
-    }
-
     // check if carbon message
-    gboolean res = _handle_carbons(stanza);
+    gboolean res = _handle_carbons(fields->carbons);
     if (res) {
-        return 1;
+        return;
     }
 
     // ignore handled namespaces
-    xmpp_stanza_t *conf = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_CONFERENCE);
-    xmpp_stanza_t *captcha = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_CAPTCHA);
-    if (conf || captcha) {
-        return 1;
+    if (fields->conference || fields->captcha) {
+        return;
     }
 
     // some clients send the mucuser namespace with private messages
     // if the namespace exists, and the stanza contains a body element, assume its a private message
     // otherwise exit the handler
-    xmpp_stanza_t *mucuser = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_MUC_USER);
-    xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
-    if (mucuser && body == NULL) {
-        return 1;
+    xmpp_stanza_t *body = fields->body;
+    if (fields->muc_user && body == NULL) {
+        return;
     }
 
-    gchar *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
-    Jid *jid = jid_create(from);
+    Jid *jid = jid_create(fields->from);
 
     // private message from chat room use full jid (room/nick)
     if (muc_active(jid->barejid)) {
-        _private_chat_handler(stanza, jid->fulljid);
+        _private_chat_handler(stanza, body, jid->fulljid);
         jid_destroy(jid);
-        return 1;
+        return;
     }
 
     // standard chat message, use jid without resource
@@ -786,14 +779,13 @@ _chat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * con
         char *message = xmpp_stanza_get_text(body);
         if (message) {
             char *enc_message = NULL;
-            xmpp_stanza_t *x = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_ENCRYPTED);
-            if (x) {
-                enc_message = xmpp_stanza_get_text(x);
+            if (fields->encrypted) {
+                enc_message = xmpp_stanza_get_text(fields->encrypted);
             }
             sv_ev_incoming_message(jid->barejid, jid->resourcepart, message, enc_message, timestamp);
             xmpp_free(ctx, enc_message);
 
-            _receipt_request_handler(stanza);
+            _receipt_request_handler(stanza, fields);
 
             xmpp_free(ctx, message);
         }
@@ -801,19 +793,15 @@ _chat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * con
 
     // handle chat sessions and states
     if (!timestamp && jid->resourcepart) {
-        gboolean gone = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_GONE) != NULL;
-        gboolean typing = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_COMPOSING) != NULL;
-        gboolean paused = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_PAUSED) != NULL;
-        gboolean inactive = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_INACTIVE) != NULL;
-        if (gone) {
+        if (fields->gone) {
             sv_ev_gone(jid->barejid, jid->resourcepart);
-        } else if (typing) {
+        } else if (fields->composing) {
             sv_ev_typing(jid->barejid, jid->resourcepart);
-        } else if (paused) {
+        } else if (fields->paused) {
             sv_ev_paused(jid->barejid, jid->resourcepart);
-        } else if (inactive) {
+        } else if (fields->inactive) {
             sv_ev_inactive(jid->barejid, jid->resourcepart);
-        } else if (stanza_contains_chat_state(stanza)) {
+        } else if (fields->active) {
             sv_ev_activity(jid->barejid, jid->resourcepart, TRUE);
         } else {
             sv_ev_activity(jid->barejid, jid->resourcepart, FALSE);
@@ -822,5 +810,4 @@ _chat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * con
 
     if (timestamp) g_date_time_unref(timestamp);
     jid_destroy(jid);
-    return 1;
 }
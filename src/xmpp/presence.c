@@ -53,6 +53,7 @@
 #include "log.h"
 #include "muc.h"
 #include "profanity.h"
+#include "roster_list.h"
 #include "ui/ui.h"
 #include "event/server_events.h"
 #include "xmpp/capabilities.h"
@@ -75,13 +76,14 @@ static int _unsubscribed_handler(xmpp_conn_t * const conn,
     xmpp_stanza_t * const stanza, void * const userdata);
 static int _available_handler(xmpp_conn_t * const conn,
     xmpp_stanza_t * const stanza, void * const userdata);
+static void _handle_available(XMPPPresenceFields *presence);
 static int _muc_user_handler(xmpp_conn_t * const conn,
     xmpp_stanza_t * const stanza, void * const userdata);
 static int _presence_error_handler(xmpp_conn_t * const conn,
     xmpp_stanza_t * const stanza, void * const userdata);
 
 void _send_caps_request(char *node, char *caps_key, char *id, char *from);
-static void _send_room_presence(xmpp_conn_t *conn, xmpp_stanza_t *presence);
+static void _send_room_presence(xmpp_stanza_t *presence);
 
 void
 presence_sub_requests_init(void)
@@ -110,7 +112,6 @@ presence_subscription(const char * const jid, const jabber_subscr_t action)
     assert(jid != NULL);
 
     xmpp_ctx_t * const ctx = connection_get_ctx();
-    xmpp_conn_t * const conn = connection_get_conn();
     const char *type = NULL;
 
     Jid *jidp = jid_create(jid);
@@ -142,7 +143,7 @@ presence_subscription(const char * const jid, const jabber_subscr_t action)
     xmpp_stanza_set_name(presence, STANZA_NAME_PRESENCE);
     xmpp_stanza_set_type(presence, type);
     xmpp_stanza_set_attribute(presence, STANZA_ATTR_TO, jidp->barejid);
-    xmpp_send(conn, presence);
+    connection_send_stanza(presence);
     xmpp_stanza_release(presence);
 
     jid_destroy(jidp);
@@ -216,7 +217,6 @@ presence_send(const resource_presence_t presence_type, const char * const msg, c
     }
 
     xmpp_ctx_t * const ctx = connection_get_ctx();
-    xmpp_conn_t * const conn = connection_get_conn();
     const int pri = accounts_get_priority_for_presence_type(jabber_get_account_name(), presence_type);
     const char *show = stanza_get_presence_string_from_type(presence_type);
 
@@ -245,8 +245,10 @@ presence_send(const resource_presence_t presence_type, const char * const msg, c
     stanza_attach_priority(ctx, presence, pri);
     stanza_attach_last_activity(ctx, presence, idle);
     stanza_attach_caps(ctx, presence);
-    xmpp_send(conn, presence);
-    _send_room_presence(conn, presence);
+    jabber_cork();
+    connection_send_stanza(presence);
+    _send_room_presence(presence);
+    jabber_uncork();
     xmpp_stanza_release(presence);
 
     // set last presence for account
@@ -261,7 +263,7 @@ presence_send(const resource_presence_t presence_type, const char * const msg, c
 }
 
 static void
-_send_room_presence(xmpp_conn_t *conn, xmpp_stanza_t *presence)
+_send_room_presence(xmpp_stanza_t *presence)
 {
     GList *rooms_p = muc_rooms();
     GList *rooms = rooms_p;
@@ -275,7 +277,7 @@ _send_room_presence(xmpp_conn_t *conn, xmpp_stanza_t *presence)
 
             xmpp_stanza_set_attribute(presence, STANZA_ATTR_TO, full_room_jid);
             log_debug("Sending presence to room: %s", full_room_jid);
-            xmpp_send(conn, presence);
+            connection_send_stanza(presence);
             free(full_room_jid);
         }
 
@@ -294,7 +296,6 @@ presence_join_room(char *room, char *nick, char * passwd)
 
     log_debug("Sending room join presence to: %s", jid->fulljid);
     xmpp_ctx_t *ctx = connection_get_ctx();
-    xmpp_conn_t *conn = connection_get_conn();
     resource_presence_t presence_type =
         accounts_get_last_presence(jabber_get_account_name());
     const char *show = stanza_get_presence_string_from_type(presence_type);
@@ -302,13 +303,14 @@ presence_join_room(char *room, char *nick, char * passwd)
     int pri = accounts_get_priority_for_presence_type(jabber_get_account_name(),
         presence_type);
 
-    xmpp_stanza_t *presence = stanza_create_room_join_presence(ctx, jid->fulljid, passwd);
+    GDateTime *since = muc_last_seen(room);
+    xmpp_stanza_t *presence = stanza_create_room_join_presence(ctx, jid->fulljid, passwd, since);
     stanza_attach_show(ctx, presence, show);
     stanza_attach_status(ctx, presence, status);
     stanza_attach_priority(ctx, presence, pri);
     stanza_attach_caps(ctx, presence);
 
-    xmpp_send(conn, presence);
+    connection_send_stanza(presence);
     xmpp_stanza_release(presence);
 
     jid_destroy(jid);
@@ -322,7 +324,6 @@ presence_change_room_nick(const char * const room, const char * const nick)
 
     log_debug("Sending room nickname change to: %s, nick: %s", room, nick);
     xmpp_ctx_t *ctx = connection_get_ctx();
-    xmpp_conn_t *conn = connection_get_conn();
     resource_presence_t presence_type =
         accounts_get_last_presence(jabber_get_account_name());
     const char *show = stanza_get_presence_string_from_type(presence_type);
@@ -338,7 +339,7 @@ presence_change_room_nick(const char * const room, const char * const nick)
     stanza_attach_priority(ctx, presence, pri);
     stanza_attach_caps(ctx, presence);
 
-    xmpp_send(conn, presence);
+    connection_send_stanza(presence);
     xmpp_stanza_release(presence);
 
     free(full_room_jid);
@@ -351,13 +352,12 @@ presence_leave_chat_room(const char * const room_jid)
 
     log_debug("Sending room leave presence to: %s", room_jid);
     xmpp_ctx_t *ctx = connection_get_ctx();
-    xmpp_conn_t *conn = connection_get_conn();
     char *nick = muc_nick(room_jid);
 
     if (nick) {
         xmpp_stanza_t *presence = stanza_create_room_leave_presence(ctx, room_jid,
             nick);
-        xmpp_send(conn, presence);
+        connection_send_stanza(presence);
         xmpp_stanza_release(presence);
     }
 }
@@ -508,6 +508,8 @@ _unavailable_handler(xmpp_conn_t * const conn,
 
     char *status_str = stanza_get_status(stanza, NULL);
 
+    caps_remove_jid(from);
+
     if (strcmp(my_jid->barejid, from_jid->barejid) !=0) {
         if (from_jid->resourcepart) {
             sv_ev_contact_offline(from_jid->barejid, from_jid->resourcepart, status_str);
@@ -540,10 +542,8 @@ _handle_caps(char *jid, XMPPCaps *caps)
                 log_info("Capabilities cache hit: %s, for %s.", caps->ver, jid);
                 caps_map_jid_to_ver(jid, caps->ver);
             } else {
-                log_info("Capabilities cache miss: %s, for %s, sending service discovery request", caps->ver, jid);
-                char *id = create_unique_id("caps");
-                iq_send_caps_request(jid, id, caps->node, caps->ver);
-                free(id);
+                log_info("Capabilities cache miss: %s, for %s, requesting service discovery", caps->ver, jid);
+                caps_request(jid, caps->node, caps->ver);
             }
         }
 
@@ -571,91 +571,110 @@ _available_handler(xmpp_conn_t * const conn,
 {
     ui_input_nonblocking(TRUE);
 
-    // handler still fires if error
-    if (g_strcmp0(xmpp_stanza_get_type(stanza), STANZA_TYPE_ERROR) == 0) {
-        return 1;
-    }
+    XMPPPresenceFields presence;
+    stanza_parse_presence_fields(stanza, &presence);
+    _handle_available(&presence);
+    stanza_free_presence_fields(&presence);
 
-    // handler still fires if other types
-    if ((g_strcmp0(xmpp_stanza_get_type(stanza), STANZA_TYPE_UNAVAILABLE) == 0) ||
-            (g_strcmp0(xmpp_stanza_get_type(stanza), STANZA_TYPE_SUBSCRIBE) == 0) ||
-            (g_strcmp0(xmpp_stanza_get_type(stanza), STANZA_TYPE_SUBSCRIBED) == 0) ||
-            (g_strcmp0(xmpp_stanza_get_type(stanza), STANZA_TYPE_UNSUBSCRIBED) == 0)) {
-        return 1;
+    return 1;
+}
+
+static void
+_handle_available(XMPPPresenceFields *presence)
+{
+    // handler still fires if error or other types
+    if (presence->type && ((strcmp(presence->type, STANZA_TYPE_ERROR) == 0) ||
+            (strcmp(presence->type, STANZA_TYPE_UNAVAILABLE) == 0) ||
+            (strcmp(presence->type, STANZA_TYPE_SUBSCRIBE) == 0) ||
+            (strcmp(presence->type, STANZA_TYPE_SUBSCRIBED) == 0) ||
+            (strcmp(presence->type, STANZA_TYPE_UNSUBSCRIBED) == 0))) {
+        return;
     }
 
     // handler still fires for muc presence
-    if (stanza_is_muc_presence(stanza)) {
-        return 1;
+    if (presence->muc_user) {
+        return;
     }
 
-    int err = 0;
-    XMPPPresence *xmpp_presence = stanza_parse_presence(stanza, &err);
-
-    if (!xmpp_presence) {
-        char *from = NULL;
-        switch(err) {
-            case STANZA_PARSE_ERROR_NO_FROM:
-                log_warning("Available presence handler fired with no from attribute.");
-                break;
-            case STANZA_PARSE_ERROR_INVALID_FROM:
-                from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
-                log_warning("Available presence handler fired with invalid from attribute: %s", from);
-                break;
-            default:
-                log_warning("Available presence handler fired, could not parse stanza.");
-                break;
-        }
-        return 1;
-    } else {
-        char *jid = jid_fulljid_or_barejid(xmpp_presence->jid);
-        log_debug("Presence available handler fired for: %s", jid);
+    if (!presence->from) {
+        log_warning("Available presence handler fired with no from attribute.");
+        return;
     }
 
-    const char *my_jid_str = xmpp_conn_get_jid(conn);
-    Jid *my_jid = jid_create(my_jid_str);
+    Jid *from_jid = jid_create(presence->from);
+    if (!from_jid) {
+        log_warning("Available presence handler fired with invalid from attribute: %s", presence->from);
+        return;
+    }
+
+    char *jid = jid_fulljid_or_barejid(from_jid);
+    log_debug("Presence available handler fired for: %s", jid);
 
-    XMPPCaps *caps = stanza_parse_caps(stanza);
-    if ((g_strcmp0(my_jid->fulljid, xmpp_presence->jid->fulljid) != 0) && caps) {
+    Jid *my_jid = jabber_get_jid();
+
+    if (presence->has_caps && (g_strcmp0(my_jid->fulljid, from_jid->fulljid) != 0)) {
         log_info("Presence contains capabilities.");
-        char *jid = jid_fulljid_or_barejid(xmpp_presence->jid);
-        _handle_caps(jid, caps);
+        _handle_caps(jid, &presence->caps);
     }
-    stanza_free_caps(caps);
 
-    Resource *resource = stanza_resource_from_presence(xmpp_presence);
+    // hack for servers that do not send full jid
+    const char *resource_name = from_jid->resourcepart ? from_jid->resourcepart : "__prof_default";
+    resource_presence_t resource_presence = resource_presence_from_string(presence->show);
 
-    if (g_strcmp0(xmpp_presence->jid->barejid, my_jid->barejid) == 0) {
+    if (g_strcmp0(from_jid->barejid, my_jid->barejid) == 0) {
+        Resource *resource = resource_new(resource_name, resource_presence, presence->status, presence->priority);
         connection_add_available_resource(resource);
-    } else {
-        char *pgpsig = NULL;
-        xmpp_stanza_t *x = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_SIGNED);
-        if (x) {
-            pgpsig = xmpp_stanza_get_text(x);
+        jid_destroy(from_jid);
+        return;
+    }
+
+    // repeated presence, nothing to update
+    if (presence->idle_seconds == 0 && presence->signature == NULL) {
+        PContact contact = roster_get_contact(from_jid->barejid);
+        Resource *current = contact ? p_contact_get_resource(contact, resource_name) : NULL;
+        if (current && p_contact_last_activity(contact) == NULL &&
+                current->presence == resource_presence &&
+                current->priority == presence->priority &&
+                g_strcmp0(current->status, presence->status) == 0) {
+            jid_destroy(from_jid);
+            return;
         }
-        sv_ev_contact_online(xmpp_presence->jid->barejid, resource, xmpp_presence->last_activity, pgpsig);
-        xmpp_ctx_t *ctx = connection_get_ctx();
-        xmpp_free(ctx, pgpsig);
     }
 
-    jid_destroy(my_jid);
-    stanza_free_presence(xmpp_presence);
+    GDateTime *last_activity = NULL;
+    if (presence->idle_seconds > 0) {
+        GDateTime *now = g_date_time_new_now_local();
+        last_activity = g_date_time_add_seconds(now, 0 - presence->idle_seconds);
+        g_date_time_unref(now);
+    }
 
-    return 1;
+    char *pgpsig = NULL;
+    if (presence->signature) {
+        pgpsig = xmpp_stanza_get_text(presence->signature);
+    }
+
+    Resource *resource = resource_new(resource_name, resource_presence, presence->status, presence->priority);
+    sv_ev_contact_online(from_jid->barejid, resource, last_activity, pgpsig);
+
+    xmpp_ctx_t *ctx = connection_get_ctx();
+    xmpp_free(ctx, pgpsig);
+    if (last_activity) {
+        g_date_time_unref(last_activity);
+    }
+    jid_destroy(from_jid);
 }
 
 void
 _send_caps_request(char *node, char *caps_key, char *id, char *from)
 {
     xmpp_ctx_t *ctx = connection_get_ctx();
-    xmpp_conn_t *conn = connection_get_conn();
 
     if (node) {
         log_debug("Node string: %s.", node);
         if (!caps_contains(caps_key)) {
             log_debug("Capabilities not cached for '%s', sending discovery IQ.", from);
             xmpp_stanza_t *iq = stanza_create_disco_info_iq(ctx, id, from, node);
-            xmpp_send(conn, iq);
+            connection_send_stanza(iq);
             xmpp_stanza_release(iq);
         } else {
             log_debug("Capabilities already cached, for %s", caps_key);
@@ -763,6 +782,7 @@ _muc_user_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void *
         log_debug("Room presence received from %s", from_jid->fulljid);
 
         if (g_strcmp0(type, STANZA_TYPE_UNAVAILABLE) == 0) {
+            caps_remove_jid(from);
 
             // handle nickname change
             char *new_nick = stanza_get_new_nick(stanza);
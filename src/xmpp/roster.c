@@ -39,6 +39,7 @@
 #include <string.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #ifdef HAVE_LIBMESODE
 #include <mesode.h>
@@ -47,8 +48,10 @@
 #include <strophe.h>
 #endif
 
+#include "common.h"
 #include "log.h"
 #include "profanity.h"
+#include "config/persist.h"
 #include "ui/ui.h"
 #include "event/server_events.h"
 #include "event/client_events.h"
@@ -62,6 +65,16 @@
 #define HANDLE(type, func) xmpp_handler_add(conn, func, XMPP_NS_ROSTER, \
 STANZA_NAME_IQ, type, ctx)
 
+// keyfile group holding the cached roster version
+#define ROSTER_CACHE_META "profanity:roster"
+
+// last roster received for the connected account, and its version
+static GKeyFile *roster_cache;
+static gchar *roster_cache_loc;
+
+// whether the roster request awaiting a result carried a cached version
+static gboolean roster_request_ver;
+
 // callback data for group commands
 typedef struct _group_data {
     char *name;
@@ -84,6 +97,16 @@ _group_remove_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
 
 // helper functions
 GSList * _get_groups_from_item(xmpp_stanza_t *item);
+static void _roster_login_presence(void);
+static void _roster_cache_load(const char * const account);
+static gboolean _roster_cache_restore(void);
+static char * _roster_cache_ver(void);
+static void _roster_cache_set_ver(const char * const ver);
+static void _roster_cache_set_item(const char * const barejid, const char * const name,
+    GSList *groups, const char * const subscription, gboolean pending_out);
+static void _roster_cache_remove_item(const char * const barejid);
+static void _roster_cache_clear(void);
+static void _roster_cache_write(void);
 
 void
 roster_add_handlers(void)
@@ -92,7 +115,6 @@ roster_add_handlers(void)
     xmpp_ctx_t * const ctx = connection_get_ctx();
 
     HANDLE(STANZA_TYPE_SET,    _roster_set_handler);
-    HANDLE(STANZA_TYPE_RESULT, _roster_result_handler);
 }
 
 void
@@ -100,42 +122,68 @@ roster_request(void)
 {
     xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
-    xmpp_stanza_t *iq = stanza_create_roster_iq(ctx);
-    xmpp_send(conn, iq);
+
+    // ver must only be sent when the server supports roster versioning,
+    // the cached roster is applied now and announced with the result
+    _roster_cache_load(jabber_get_account_name());
+    char *ver = NULL;
+    if (connection_supports_rosterver()) {
+        if (_roster_cache_restore()) {
+            ver = _roster_cache_ver();
+        }
+        if (ver == NULL) {
+            ver = strdup("");
+        }
+    }
+
+    roster_request_ver = (ver && strlen(ver) > 0);
+    xmpp_id_handler_add(conn, _roster_result_handler, "roster", ctx);
+    xmpp_stanza_t *iq = stanza_create_roster_iq(ctx, ver);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
+    free(ver);
+}
+
+void
+roster_cache_close(void)
+{
+    if (roster_cache) {
+        persist_flush(_roster_cache_write);
+        g_key_file_free(roster_cache);
+        roster_cache = NULL;
+    }
+    g_free(roster_cache_loc);
+    roster_cache_loc = NULL;
 }
 
 void
 roster_send_add_new(const char * const barejid, const char * const name)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     char *id = create_unique_id("roster");
     xmpp_stanza_t *iq = stanza_create_roster_set(ctx, id, barejid, name, NULL);
     free(id);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
 void
 roster_send_remove(const char * const barejid)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     xmpp_stanza_t *iq = stanza_create_roster_remove_set(ctx, barejid);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
 void
 roster_send_name_change(const char * const barejid, const char * const new_name, GSList *groups)
 {
-    xmpp_conn_t * const conn = connection_get_conn();
     xmpp_ctx_t * const ctx = connection_get_ctx();
     char *id = create_unique_id("roster");
     xmpp_stanza_t *iq = stanza_create_roster_set(ctx, id, barejid, new_name, groups);
     free(id);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
 }
 
@@ -165,7 +213,7 @@ roster_send_add_to_group(const char * const group, PContact contact)
     xmpp_id_handler_add(conn, _group_add_handler, unique_id, data);
     xmpp_stanza_t *iq = stanza_create_roster_set(ctx, unique_id, p_contact_barejid(contact),
         p_contact_name(contact), new_groups);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
     free(unique_id);
 }
@@ -212,7 +260,7 @@ roster_send_remove_from_group(const char * const group, PContact contact)
     xmpp_id_handler_add(conn, _group_remove_handler, unique_id, data);
     xmpp_stanza_t *iq = stanza_create_roster_set(ctx, unique_id, p_contact_barejid(contact),
         p_contact_name(contact), new_groups);
-    xmpp_send(conn, iq);
+    connection_send_stanza(iq);
     xmpp_stanza_release(iq);
     free(unique_id);
 }
@@ -245,7 +293,7 @@ _roster_set_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
     }
 
     // if from attribute exists and it is not current users barejid, ignore push
-    Jid *my_jid = jid_create(jabber_get_fulljid());
+    Jid *my_jid = jid_ref(jabber_get_jid());
     const char *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
     if (from && (strcmp(from, my_jid->barejid) != 0)) {
         jid_destroy(my_jid);
@@ -272,6 +320,7 @@ _roster_set_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
         }
         roster_remove(name, barejid_lower);
         ui_roster_remove(barejid_lower);
+        _roster_cache_remove_item(barejid_lower);
 
     // otherwise update local roster
     } else {
@@ -283,6 +332,7 @@ _roster_set_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
         }
 
         GSList *groups = _get_groups_from_item(item);
+        _roster_cache_set_item(barejid_lower, name, groups, sub, pending_out);
 
         // update the local roster
         PContact contact = roster_get_contact(barejid_lower);
@@ -298,22 +348,57 @@ _roster_set_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza,
 
     g_free(barejid_lower);
 
+    // roster push carries the new roster version
+    const char *ver = xmpp_stanza_get_attribute(query, STANZA_ATTR_VER);
+    if (ver) {
+        _roster_cache_set_ver(ver);
+    }
+
     return 1;
 }
 
 static int
 _roster_result_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
 {
-    const char *id = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_ID);
+    const char *type = xmpp_stanza_get_type(stanza);
+    if (g_strcmp0(type, STANZA_TYPE_ERROR) == 0) {
+        _roster_cache_clear();
+
+        // the cached version may be what the server rejected, retry once without it
+        if (roster_request_ver) {
+            log_error("Roster request failed, requesting full roster");
+            roster_clear();
+            roster_request_ver = FALSE;
+            xmpp_id_handler_add(conn, _roster_result_handler, "roster", connection_get_ctx());
+            xmpp_stanza_t *iq = stanza_create_roster_iq(connection_get_ctx(), NULL);
+            connection_send_stanza(iq);
+            xmpp_stanza_release(iq);
+            return 0;
+        }
 
-    if (g_strcmp0(id, "roster") != 0) {
-        return 1;
+        log_error("Roster request failed");
+        sv_ev_roster_received();
+        _roster_login_presence();
+        return 0;
     }
 
-    // handle initial roster response
+    // no query, the cached roster is current and pushes will follow
     xmpp_stanza_t *query = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_QUERY);
-    xmpp_stanza_t *item = xmpp_stanza_get_children(query);
+    if (query == NULL) {
+        log_debug("Roster unchanged since last session, using cached roster");
+        sv_ev_roster_received();
+        _roster_login_presence();
+        return 0;
+    }
 
+    // full roster, replaces anything restored from the cache, only
+    // rosters the server versions are cached
+    roster_clear();
+    _roster_cache_clear();
+    const char *ver = xmpp_stanza_get_attribute(query, STANZA_ATTR_VER);
+
+    xmpp_stanza_t *item = xmpp_stanza_get_children(query);
+    roster_add_bulk_begin();
     while (item) {
         const char *barejid = xmpp_stanza_get_attribute(item, STANZA_ATTR_JID);
         gchar *barejid_lower = g_utf8_strdown(barejid, -1);
@@ -330,6 +415,9 @@ _roster_result_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, v
         }
 
         GSList *groups = _get_groups_from_item(item);
+        if (ver) {
+            _roster_cache_set_item(barejid_lower, name, groups, sub, pending_out);
+        }
 
         gboolean added = roster_add(barejid_lower, name, groups, sub, pending_out);
         if (!added) {
@@ -339,9 +427,21 @@ _roster_result_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, v
         g_free(barejid_lower);
         item = xmpp_stanza_get_next(item);
     }
+    roster_add_bulk_end();
+
+    if (ver) {
+        _roster_cache_set_ver(ver);
+    }
 
     sv_ev_roster_received();
+    _roster_login_presence();
 
+    return 0;
+}
+
+static void
+_roster_login_presence(void)
+{
     char *account = jabber_get_account_name();
     resource_presence_t conn_presence = accounts_get_login_presence(account);
 
@@ -366,8 +466,6 @@ _roster_result_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, v
     } else {
         cl_ev_presence_send(conn_presence, NULL, 0);
     }
-
-    return 1;
 }
 
 GSList *
@@ -388,3 +486,147 @@ _get_groups_from_item(xmpp_stanza_t *item)
 
     return groups;
 }
+
+static void
+_roster_cache_load(const char * const account)
+{
+    roster_cache_close();
+    if (account == NULL) {
+        return;
+    }
+
+    gchar *xdg_data = xdg_get_data_home();
+    char *filename = str_replace(account, "/", "_");
+    GString *cache_file = g_string_new(xdg_data);
+    g_string_append(cache_file, "/profanity/rosters/");
+    g_string_append(cache_file, filename);
+    roster_cache_loc = g_strdup(cache_file->str);
+    free(filename);
+    g_free(xdg_data);
+    g_string_free(cache_file, TRUE);
+
+    roster_cache = g_key_file_new();
+    g_key_file_load_from_file(roster_cache, roster_cache_loc, G_KEY_FILE_NONE, NULL);
+}
+
+static gboolean
+_roster_cache_restore(void)
+{
+    if (roster_cache == NULL || !g_key_file_has_key(roster_cache, ROSTER_CACHE_META, "ver", NULL)) {
+        return FALSE;
+    }
+
+    gsize len = 0;
+    gchar **barejids = g_key_file_get_groups(roster_cache, &len);
+
+    roster_add_bulk_begin();
+    gsize i;
+    for (i = 0; i < len; i++) {
+        if (g_strcmp0(barejids[i], ROSTER_CACHE_META) == 0) {
+            continue;
+        }
+
+        gchar *name = g_key_file_get_string(roster_cache, barejids[i], "name", NULL);
+        gchar *sub = g_key_file_get_string(roster_cache, barejids[i], "subscription", NULL);
+        gboolean pending_out = g_key_file_get_boolean(roster_cache, barejids[i], "pending_out", NULL);
+
+        GSList *groups = NULL;
+        gsize groups_len = 0;
+        gchar **group_list = g_key_file_get_string_list(roster_cache, barejids[i], "groups", &groups_len, NULL);
+        gsize j;
+        for (j = 0; j < groups_len; j++) {
+            groups = g_slist_append(groups, strdup(group_list[j]));
+        }
+        g_strfreev(group_list);
+
+        roster_add(barejids[i], name, groups, sub, pending_out);
+
+        g_free(name);
+        g_free(sub);
+    }
+    roster_add_bulk_end();
+    g_strfreev(barejids);
+
+    return TRUE;
+}
+
+static char *
+_roster_cache_ver(void)
+{
+    if (roster_cache == NULL) {
+        return NULL;
+    }
+
+    return g_key_file_get_string(roster_cache, ROSTER_CACHE_META, "ver", NULL);
+}
+
+static void
+_roster_cache_set_ver(const char * const ver)
+{
+    if (roster_cache == NULL) {
+        return;
+    }
+
+    g_key_file_set_string(roster_cache, ROSTER_CACHE_META, "ver", ver);
+    persist_schedule(_roster_cache_write);
+}
+
+static void
+_roster_cache_set_item(const char * const barejid, const char * const name,
+    GSList *groups, const char * const subscription, gboolean pending_out)
+{
+    if (roster_cache == NULL) {
+        return;
+    }
+
+    g_key_file_remove_group(roster_cache, barejid, NULL);
+    if (name) {
+        g_key_file_set_string(roster_cache, barejid, "name", name);
+    }
+    if (subscription) {
+        g_key_file_set_string(roster_cache, barejid, "subscription", subscription);
+    }
+    g_key_file_set_boolean(roster_cache, barejid, "pending_out", pending_out);
+
+    if (groups) {
+        gsize len = g_slist_length(groups);
+        const gchar *group_list[len];
+        gsize i = 0;
+        GSList *curr = groups;
+        while (curr) {
+            group_list[i++] = curr->data;
+            curr = g_slist_next(curr);
+        }
+        g_key_file_set_string_list(roster_cache, barejid, "groups", group_list, len);
+    }
+}
+
+static void
+_roster_cache_remove_item(const char * const barejid)
+{
+    if (roster_cache) {
+        g_key_file_remove_group(roster_cache, barejid, NULL);
+    }
+}
+
+static void
+_roster_cache_clear(void)
+{
+    if (roster_cache) {
+        g_key_file_free(roster_cache);
+        roster_cache = g_key_file_new();
+    }
+
+    // the next write happens when a new version is set
+    if (roster_cache_loc) {
+        g_remove(roster_cache_loc);
+    }
+}
+
+static void
+_roster_cache_write(void)
+{
+    if (roster_cache && roster_cache_loc) {
+        persist_write_keyfile(roster_cache, roster_cache_loc);
+    }
+}
@@ -37,5 +37,6 @@
 
 void roster_add_handlers(void);
 void roster_request(void);
+void roster_cache_close(void);
 
 #endif
@@ -0,0 +1,318 @@
+/*
+ * sm.c
+ *
+ * Copyright (C) 2015 James Booth <boothj5@gmail.com>
+ *
+ * This file is part of Profanity.
+ *
+ * Profanity is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Profanity is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Profanity.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give permission to
+ * link the code of portions of this program with the OpenSSL library under
+ * certain conditions as described in each individual source file, and
+ * distribute linked combinations including the two.
+ *
+ * You must obey the GNU General Public License in all respects for all of the
+ * code used other than OpenSSL. If you modify file(s) with this exception, you
+ * may extend this exception to your version of the file(s), but you are not
+ * obligated to do so. If you do not wish to do so, delete this exception
+ * statement from your version. If you delete this exception statement from all
+ * source files in the program, then also delete it here.
+ *
+ */
+
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#ifdef HAVE_LIBMESODE
+#include <mesode.h>
+#endif
+#ifdef HAVE_LIBSTROPHE
+#include <strophe.h>
+#endif
+
+#include "log.h"
+#include "config/preferences.h"
+#include "ui/ui.h"
+#include "xmpp/connection.h"
+#include "xmpp/sm.h"
+#include "xmpp/stanza.h"
+#include "xmpp/xmpp.h"
+
+// XEP-0198 stream management
+
+// request an acknowledgement once this many stanzas are unacknowledged
+#define SM_REQUEST_AFTER 5
+
+// and at this interval while any remain unacknowledged
+#define SM_REQUEST_INTERVAL_MS 30000
+
+static struct {
+    gboolean active;        // enable sent and not refused
+    gboolean enabled;       // server confirmed with <enabled/>
+    gboolean ack_pending;   // <r/> sent, waiting for <a/>
+    guint32 handled;        // stanzas received since enabled
+    guint32 acked;          // our stanzas the server has acknowledged
+    GQueue unacked;         // stanzas sent since enable and not acknowledged, oldest first
+    GQueue lost;            // messages unacknowledged when the connection was lost
+} sm = { FALSE, FALSE, FALSE, 0, 0, G_QUEUE_INIT, G_QUEUE_INIT };
+
+static int _sm_enabled_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _sm_failed_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _sm_request_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _sm_answer_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _sm_inbound_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _sm_timed_handler(xmpp_conn_t * const conn, void * const userdata);
+
+static void _sm_request_ack(void);
+static void _sm_clear(GQueue *queue);
+
+void
+sm_add_handlers(void)
+{
+    xmpp_conn_t * const conn = connection_get_conn();
+    xmpp_ctx_t * const ctx = connection_get_ctx();
+
+    xmpp_handler_add(conn, _sm_enabled_handler, STANZA_NS_SM, STANZA_NAME_ENABLED, NULL, ctx);
+    xmpp_handler_add(conn, _sm_failed_handler, STANZA_NS_SM, STANZA_NAME_FAILED, NULL, ctx);
+    xmpp_handler_add(conn, _sm_request_handler, STANZA_NS_SM, STANZA_NAME_ACK_REQUEST, NULL, ctx);
+    xmpp_handler_add(conn, _sm_answer_handler, STANZA_NS_SM, STANZA_NAME_ACK_ANSWER, NULL, ctx);
+    xmpp_handler_add(conn, _sm_inbound_handler, NULL, NULL, NULL, ctx);
+    xmpp_timed_handler_add(conn, _sm_timed_handler, SM_REQUEST_INTERVAL_MS, ctx);
+}
+
+void
+sm_enable(void)
+{
+    if (sm.active) {
+        return;
+    }
+
+    sm.active = TRUE;
+    sm.enabled = FALSE;
+    sm.ack_pending = FALSE;
+    sm.handled = 0;
+    sm.acked = 0;
+    _sm_clear(&sm.unacked);
+
+    xmpp_conn_t * const conn = connection_get_conn();
+    xmpp_ctx_t * const ctx = connection_get_ctx();
+    xmpp_stanza_t *enable = stanza_create_sm_enable(ctx);
+    xmpp_send(conn, enable);
+    xmpp_stanza_release(enable);
+}
+
+gboolean
+sm_is_active(void)
+{
+    return sm.active;
+}
+
+// called with each serialised stanza written to the stream
+void
+sm_stanza_sent(const char * const text)
+{
+    if (!sm.active) {
+        return;
+    }
+
+    g_queue_push_tail(&sm.unacked, strdup(text));
+    if (sm.enabled && !sm.ack_pending && g_queue_get_length(&sm.unacked) >= SM_REQUEST_AFTER) {
+        _sm_request_ack();
+    }
+}
+
+// resend messages the previous stream never acknowledged
+void
+sm_resend_lost(void)
+{
+    if (g_queue_is_empty(&sm.lost)) {
+        return;
+    }
+
+    log_info("Resending %u unacknowledged messages", g_queue_get_length(&sm.lost));
+    jabber_cork();
+    char *text = NULL;
+    while ((text = g_queue_pop_head(&sm.lost)) != NULL) {
+        connection_send_text(text, strlen(text));
+        free(text);
+    }
+    jabber_uncork();
+}
+
+// keep unacknowledged messages for the next connection, other stanzas are
+// tied to the lost session
+void
+sm_connection_lost(void)
+{
+    // a server without stream management may answer <enable/> with a stream
+    // error, enabling again on every reconnect would never get online
+    if (sm.active && !sm.enabled) {
+        log_warning("Connection lost before stream management was enabled, disabling stream management.");
+        prefs_set_boolean(PREF_SM, FALSE);
+        cons_show_error("Server did not enable stream management, stream management disabled.");
+    }
+
+    char *text = NULL;
+    while ((text = g_queue_pop_head(&sm.unacked)) != NULL) {
+        if (g_str_has_prefix(text, "<" STANZA_NAME_MESSAGE)) {
+            g_queue_push_tail(&sm.lost, text);
+        } else {
+            free(text);
+        }
+    }
+
+    sm.active = FALSE;
+    sm.enabled = FALSE;
+    sm.ack_pending = FALSE;
+}
+
+void
+sm_reset(void)
+{
+    _sm_clear(&sm.unacked);
+    _sm_clear(&sm.lost);
+    sm.active = FALSE;
+    sm.enabled = FALSE;
+    sm.ack_pending = FALSE;
+}
+
+static void
+_sm_request_ack(void)
+{
+    xmpp_conn_t * const conn = connection_get_conn();
+    xmpp_ctx_t * const ctx = connection_get_ctx();
+    xmpp_stanza_t *request = stanza_create_sm_request(ctx);
+    xmpp_send(conn, request);
+    xmpp_stanza_release(request);
+    sm.ack_pending = TRUE;
+}
+
+static void
+_sm_clear(GQueue *queue)
+{
+    char *text = NULL;
+    while ((text = g_queue_pop_head(queue)) != NULL) {
+        free(text);
+    }
+}
+
+static int
+_sm_enabled_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    if (!sm.active) {
+        return 1;
+    }
+
+    log_info("Stream management enabled");
+    sm.enabled = TRUE;
+    sm.handled = 0;
+    if (g_queue_get_length(&sm.unacked) >= SM_REQUEST_AFTER) {
+        _sm_request_ack();
+    }
+
+    return 1;
+}
+
+static int
+_sm_failed_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    log_warning("Server refused stream management");
+    _sm_clear(&sm.unacked);
+    sm.active = FALSE;
+    sm.enabled = FALSE;
+    sm.ack_pending = FALSE;
+
+    return 1;
+}
+
+static int
+_sm_request_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    if (!sm.active) {
+        return 1;
+    }
+
+    xmpp_ctx_t * const ctx = connection_get_ctx();
+    xmpp_stanza_t *answer = stanza_create_sm_answer(ctx, sm.handled);
+    xmpp_send(conn, answer);
+    xmpp_stanza_release(answer);
+
+    return 1;
+}
+
+static int
+_sm_answer_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    if (!sm.active) {
+        return 1;
+    }
+
+    char *h_str = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_H);
+    if (!h_str) {
+        log_warning("Stream management answer received with no h attribute");
+        return 1;
+    }
+
+    // counts wrap at 2^32, so the difference is what was newly acknowledged
+    guint32 h = strtoul(h_str, NULL, 10);
+    guint32 newly_acked = h - sm.acked;
+    guint unacked = g_queue_get_length(&sm.unacked);
+    if (newly_acked > unacked) {
+        log_warning("Server acknowledged %u stanzas, only %u were sent", newly_acked, unacked);
+        newly_acked = unacked;
+    }
+
+    guint32 i;
+    for (i = 0; i < newly_acked; i++) {
+        free(g_queue_pop_head(&sm.unacked));
+    }
+    sm.acked = h;
+    sm.ack_pending = FALSE;
+
+    return 1;
+}
+
+static int
+_sm_inbound_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    // the server counts from <enabled/>, not from when we sent <enable/>
+    if (!sm.enabled) {
+        return 1;
+    }
+
+    char *name = xmpp_stanza_get_name(stanza);
+    if ((g_strcmp0(name, STANZA_NAME_MESSAGE) == 0) ||
+            (g_strcmp0(name, STANZA_NAME_PRESENCE) == 0) ||
+            (g_strcmp0(name, STANZA_NAME_IQ) == 0)) {
+        sm.handled++;
+    }
+
+    return 1;
+}
+
+static int
+_sm_timed_handler(xmpp_conn_t * const conn, void * const userdata)
+{
+    if (sm.enabled && !g_queue_is_empty(&sm.unacked)) {
+        _sm_request_ack();
+    }
+
+    return 1;
+}
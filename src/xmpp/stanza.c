@@ -55,6 +55,8 @@
 
 #include "muc.h"
 
+static char* _stanza_text(xmpp_stanza_t * const stanza, gboolean *copied);
+
 #if 0
 xmpp_stanza_t *
 stanza_create_bookmarks_pubsub_request(xmpp_ctx_t *ctx)
@@ -246,6 +248,40 @@ stanza_disable_carbons(xmpp_ctx_t *ctx){
     return iq;
 }
 
+xmpp_stanza_t *
+stanza_create_sm_enable(xmpp_ctx_t *ctx)
+{
+    xmpp_stanza_t *enable = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(enable, STANZA_NAME_ENABLE);
+    xmpp_stanza_set_ns(enable, STANZA_NS_SM);
+
+    return enable;
+}
+
+xmpp_stanza_t *
+stanza_create_sm_request(xmpp_ctx_t *ctx)
+{
+    xmpp_stanza_t *request = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(request, STANZA_NAME_ACK_REQUEST);
+    xmpp_stanza_set_ns(request, STANZA_NS_SM);
+
+    return request;
+}
+
+xmpp_stanza_t *
+stanza_create_sm_answer(xmpp_ctx_t *ctx, guint32 handled)
+{
+    xmpp_stanza_t *answer = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(answer, STANZA_NAME_ACK_ANSWER);
+    xmpp_stanza_set_ns(answer, STANZA_NS_SM);
+
+    char h[11];
+    g_snprintf(h, sizeof(h), "%u", handled);
+    xmpp_stanza_set_attribute(answer, STANZA_ATTR_H, h);
+
+    return answer;
+}
+
 xmpp_stanza_t *
 stanza_create_chat_state(xmpp_ctx_t *ctx, const char * const fulljid, const char * const state)
 {
@@ -523,7 +559,7 @@ stanza_create_mediated_invite(xmpp_ctx_t *ctx, const char * const room,
 
 xmpp_stanza_t *
 stanza_create_room_join_presence(xmpp_ctx_t * const ctx,
-    const char * const full_room_jid, const char * const passwd)
+    const char * const full_room_jid, const char * const passwd, GDateTime *since)
 {
     xmpp_stanza_t *presence = xmpp_stanza_new(ctx);
     xmpp_stanza_set_name(presence, STANZA_NAME_PRESENCE);
@@ -548,6 +584,22 @@ stanza_create_room_join_presence(xmpp_ctx_t * const ctx,
         xmpp_stanza_release(pass);
     }
 
+    // only request history from the last message seen, the stamp is
+    // inclusive and truncated to seconds so that message may be repeated
+    if (since) {
+        GDateTime *utc = g_date_time_to_utc(since);
+        gchar *stamp = g_date_time_format(utc, "%Y-%m-%dT%H:%M:%SZ");
+
+        xmpp_stanza_t *history = xmpp_stanza_new(ctx);
+        xmpp_stanza_set_name(history, STANZA_NAME_HISTORY);
+        xmpp_stanza_set_attribute(history, STANZA_ATTR_SINCE, stamp);
+        xmpp_stanza_add_child(x, history);
+        xmpp_stanza_release(history);
+
+        g_free(stamp);
+        g_date_time_unref(utc);
+    }
+
     xmpp_stanza_add_child(presence, x);
     xmpp_stanza_release(x);
 
@@ -905,7 +957,7 @@ stanza_create_software_version_iq(xmpp_ctx_t *ctx, const char * const fulljid)
 }
 
 xmpp_stanza_t *
-stanza_create_roster_iq(xmpp_ctx_t *ctx)
+stanza_create_roster_iq(xmpp_ctx_t *ctx, const char * const ver)
 {
     xmpp_stanza_t *iq = xmpp_stanza_new(ctx);
     xmpp_stanza_set_name(iq, STANZA_NAME_IQ);
@@ -915,6 +967,9 @@ stanza_create_roster_iq(xmpp_ctx_t *ctx)
     xmpp_stanza_t *query = xmpp_stanza_new(ctx);
     xmpp_stanza_set_name(query, STANZA_NAME_QUERY);
     xmpp_stanza_set_ns(query, XMPP_NS_ROSTER);
+    if (ver) {
+        xmpp_stanza_set_attribute(query, STANZA_ATTR_VER, ver);
+    }
 
     xmpp_stanza_add_child(iq, query);
     xmpp_stanza_release(query);
@@ -1709,21 +1764,6 @@ stanza_get_presence_string_from_type(resource_presence_t presence_type)
     }
 }
 
-Resource*
-stanza_resource_from_presence(XMPPPresence *presence)
-{
-    // create Resource
-    Resource *resource = NULL;
-    resource_presence_t resource_presence = resource_presence_from_string(presence->show);
-    if (presence->jid->resourcepart == NULL) { // hack for servers that do not send full jid
-        resource = resource_new("__prof_default", resource_presence, presence->status, presence->priority);
-    } else {
-        resource = resource_new(presence->jid->resourcepart, resource_presence, presence->status, presence->priority);
-    }
-
-    return resource;
-}
-
 void
 stanza_free_caps(XMPPCaps *caps)
 {
@@ -1742,64 +1782,155 @@ stanza_free_caps(XMPPCaps *caps)
 }
 
 void
-stanza_free_presence(XMPPPresence *presence)
+stanza_free_presence_fields(XMPPPresenceFields *fields)
 {
-    if (presence) {
-        if (presence->jid) {
-            jid_destroy(presence->jid);
-        }
-        if (presence->last_activity) {
-            g_date_time_unref(presence->last_activity);
+    xmpp_ctx_t *ctx = connection_get_ctx();
+    if (fields->show_copied) {
+        xmpp_free(ctx, fields->show);
+    }
+    if (fields->status_copied) {
+        xmpp_free(ctx, fields->status);
+    }
+}
+
+void
+stanza_parse_presence_fields(xmpp_stanza_t * const stanza, XMPPPresenceFields *fields)
+{
+    memset(fields, 0, sizeof(XMPPPresenceFields));
+    fields->from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    fields->type = xmpp_stanza_get_type(stanza);
+
+    gboolean has_show = FALSE;
+    gboolean has_status = FALSE;
+    gboolean has_priority = FALSE;
+    gboolean has_query = FALSE;
+    gboolean has_c = FALSE;
+
+    // first child of each name wins, as with xmpp_stanza_get_child_by_name
+    xmpp_stanza_t *child = xmpp_stanza_get_children(stanza);
+    while (child) {
+        char *name = xmpp_stanza_get_name(child);
+        char *ns = name ? xmpp_stanza_get_ns(child) : NULL;
+
+        if (name == NULL) {
+            // text node
+        } else if (!has_show && strcmp(name, STANZA_NAME_SHOW) == 0) {
+            has_show = TRUE;
+            fields->show = _stanza_text(child, &fields->show_copied);
+        } else if (!has_status && strcmp(name, STANZA_NAME_STATUS) == 0) {
+            has_status = TRUE;
+            fields->status = _stanza_text(child, &fields->status_copied);
+        } else if (!has_priority && strcmp(name, STANZA_NAME_PRIORITY) == 0) {
+            has_priority = TRUE;
+            gboolean priority_copied = FALSE;
+            char *priority_str = _stanza_text(child, &priority_copied);
+            if (priority_str) {
+                fields->priority = atoi(priority_str);
+            }
+            if (priority_copied) {
+                xmpp_free(connection_get_ctx(), priority_str);
+            }
+        } else if (!has_query && strcmp(name, STANZA_NAME_QUERY) == 0) {
+            has_query = TRUE;
+            if (g_strcmp0(ns, STANZA_NS_LASTACTIVITY) == 0) {
+                char *seconds_str = xmpp_stanza_get_attribute(child, STANZA_ATTR_SECONDS);
+                if (seconds_str && atoi(seconds_str) > 0) {
+                    fields->idle_seconds = atoi(seconds_str);
+                }
+            }
+        } else if (!has_c && strcmp(name, STANZA_NAME_C) == 0) {
+            has_c = TRUE;
+            if (g_strcmp0(ns, STANZA_NS_CAPS) == 0) {
+                fields->has_caps = TRUE;
+                fields->caps.hash = xmpp_stanza_get_attribute(child, STANZA_ATTR_HASH);
+                fields->caps.node = xmpp_stanza_get_attribute(child, STANZA_ATTR_NODE);
+                fields->caps.ver = xmpp_stanza_get_attribute(child, STANZA_ATTR_VER);
+            }
         }
-        if (presence->show) {
-            free(presence->show);
+
+        if (ns && !fields->muc_user && strcmp(ns, STANZA_NS_MUC_USER) == 0) {
+            fields->muc_user = TRUE;
         }
-        if (presence->status) {
-            free(presence->status);
+        if (ns && !fields->signature && strcmp(ns, STANZA_NS_SIGNED) == 0) {
+            fields->signature = child;
         }
-        FREE_SET_NULL(presence);
+
+        child = xmpp_stanza_get_next(child);
     }
 }
 
-XMPPPresence *
-stanza_parse_presence(xmpp_stanza_t *stanza, int *err)
-{
-    char *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
-    if (!from) {
-        *err = STANZA_PARSE_ERROR_NO_FROM;
-        return NULL;
-    }
+void
+stanza_parse_message_fields(xmpp_stanza_t * const stanza, XMPPMessageFields *fields)
+{
+    memset(fields, 0, sizeof(XMPPMessageFields));
+    fields->from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    fields->type = xmpp_stanza_get_type(stanza);
+
+    // first match wins, as with xmpp_stanza_get_child_by_name and _by_ns
+    xmpp_stanza_t *child = xmpp_stanza_get_children(stanza);
+    while (child) {
+        char *name = xmpp_stanza_get_name(child);
+        if (name == NULL) {
+            // text node
+            child = xmpp_stanza_get_next(child);
+            continue;
+        }
 
-    Jid *from_jid = jid_create(from);
-    if (!from_jid) {
-        *err = STANZA_PARSE_ERROR_INVALID_FROM;
-        return NULL;
-    }
+        if (!fields->body && strcmp(name, STANZA_NAME_BODY) == 0) {
+            fields->body = child;
+        } else if (!fields->subject && strcmp(name, STANZA_NAME_SUBJECT) == 0) {
+            fields->subject = child;
+        } else if (!fields->error && strcmp(name, STANZA_NAME_ERROR) == 0) {
+            fields->error = child;
+        } else if (strcmp(name, STANZA_NAME_ACTIVE) == 0) {
+            fields->active = TRUE;
+        } else if (strcmp(name, STANZA_NAME_COMPOSING) == 0) {
+            fields->composing = TRUE;
+        } else if (strcmp(name, STANZA_NAME_PAUSED) == 0) {
+            fields->paused = TRUE;
+        } else if (strcmp(name, STANZA_NAME_INACTIVE) == 0) {
+            fields->inactive = TRUE;
+        } else if (strcmp(name, STANZA_NAME_GONE) == 0) {
+            fields->gone = TRUE;
+        }
 
-    XMPPPresence *result = (XMPPPresence *)malloc(sizeof(XMPPPresence));
-    result->jid = from_jid;
+        char *ns = xmpp_stanza_get_ns(child);
+        if (ns == NULL) {
+            // no namespace
+        } else if (!fields->muc_user && strcmp(ns, STANZA_NS_MUC_USER) == 0) {
+            fields->muc_user = child;
+        } else if (!fields->conference && strcmp(ns, STANZA_NS_CONFERENCE) == 0) {
+            fields->conference = child;
+        } else if (!fields->captcha && strcmp(ns, STANZA_NS_CAPTCHA) == 0) {
+            fields->captcha = child;
+        } else if (!fields->receipts && strcmp(ns, STANZA_NS_RECEIPTS) == 0) {
+            fields->receipts = child;
+        } else if (!fields->carbons && strcmp(ns, STANZA_NS_CARBONS) == 0) {
+            fields->carbons = child;
+        } else if (!fields->encrypted && strcmp(ns, STANZA_NS_ENCRYPTED) == 0) {
+            fields->encrypted = child;
+        }
 
-    result->show = stanza_get_show(stanza, "online");
-    result->status = stanza_get_status(stanza, NULL);
+        child = xmpp_stanza_get_next(child);
+    }
+}
 
-    int idle_seconds = stanza_get_idle_time(stanza);
-    if (idle_seconds > 0) {
-        GDateTime *now = g_date_time_new_now_local();
-        result->last_activity = g_date_time_add_seconds(now, 0 - idle_seconds);
-        g_date_time_unref(now);
-    } else {
-        result->last_activity = NULL;
+// text content without copying when held in a single text node, otherwise
+// a copy joining all text nodes which the caller frees with xmpp_free
+static char*
+_stanza_text(xmpp_stanza_t * const stanza, gboolean *copied)
+{
+    *copied = FALSE;
+    xmpp_stanza_t *text = xmpp_stanza_get_children(stanza);
+    if (text == NULL) {
+        return NULL;
     }
 
-    result->priority = 0;
-    xmpp_stanza_t *priority_stanza = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_PRIORITY);
-    if (priority_stanza) {
-        char *priority_str = xmpp_stanza_get_text(priority_stanza);
-        if (priority_str) {
-            result->priority = atoi(priority_str);
-        }
-        free(priority_str);
+    if (xmpp_stanza_is_text(text) && xmpp_stanza_get_next(text) == NULL) {
+        return xmpp_stanza_get_text_ptr(text);
     }
 
-    return result;
+    char *joined = xmpp_stanza_get_text(stanza);
+    *copied = joined != NULL;
+    return joined;
 }
@@ -87,6 +87,11 @@
 #define STANZA_NAME_ACTOR "actor"
 #define STANZA_NAME_ENABLE "enable"
 #define STANZA_NAME_DISABLE "disable"
+#define STANZA_NAME_HISTORY "history"
+#define STANZA_NAME_ENABLED "enabled"
+#define STANZA_NAME_FAILED "failed"
+#define STANZA_NAME_ACK_REQUEST "r"
+#define STANZA_NAME_ACK_ANSWER "a"
 
 // error conditions
 #define STANZA_NAME_BAD_REQUEST "bad-request"
@@ -144,6 +149,8 @@
 #define STANZA_ATTR_REASON "reason"
 #define STANZA_ATTR_AUTOJOIN "autojoin"
 #define STANZA_ATTR_PASSWORD "password"
+#define STANZA_ATTR_SINCE "since"
+#define STANZA_ATTR_H "h"
 
 #define STANZA_TEXT_AWAY "away"
 #define STANZA_TEXT_DND "dnd"
@@ -171,6 +178,8 @@
 #define STANZA_NS_RECEIPTS "urn:xmpp:receipts"
 #define STANZA_NS_SIGNED "jabber:x:signed"
 #define STANZA_NS_ENCRYPTED "jabber:x:encrypted"
+#define STANZA_NS_SM "urn:xmpp:sm:3"
+#define STANZA_NS_ROSTERVER "urn:xmpp:features:rosterver"
 
 #define STANZA_DATAFORM_SOFTWARE "urn:xmpp:dataforms:softwareinfo"
 
@@ -180,18 +189,42 @@ typedef struct caps_stanza_t {
     char *ver;
 } XMPPCaps;
 
-typedef struct presence_stanza_t {
-    Jid *jid;
+// presence fields read in one pass, pointing into the stanza unless
+// show or status were split over several text nodes and had to be copied
+typedef struct presence_fields_t {
+    char *from;
+    char *type;
     char *show;
+    gboolean show_copied;
     char *status;
+    gboolean status_copied;
     int priority;
-    GDateTime *last_activity;
-} XMPPPresence;
-
-typedef enum {
-    STANZA_PARSE_ERROR_NO_FROM,
-    STANZA_PARSE_ERROR_INVALID_FROM
-} stanza_parse_error_t;
+    int idle_seconds;
+    gboolean has_caps;
+    XMPPCaps caps;
+    gboolean muc_user;
+    xmpp_stanza_t *signature;
+} XMPPPresenceFields;
+
+// message children found in one pass, pointing into the stanza
+typedef struct message_fields_t {
+    char *from;
+    char *type;
+    xmpp_stanza_t *body;
+    xmpp_stanza_t *subject;
+    xmpp_stanza_t *error;
+    xmpp_stanza_t *muc_user;
+    xmpp_stanza_t *conference;
+    xmpp_stanza_t *captcha;
+    xmpp_stanza_t *receipts;
+    xmpp_stanza_t *carbons;
+    xmpp_stanza_t *encrypted;
+    gboolean active;
+    gboolean composing;
+    gboolean paused;
+    gboolean inactive;
+    gboolean gone;
+} XMPPMessageFields;
 
 xmpp_stanza_t* stanza_create_bookmarks_storage_request(xmpp_ctx_t *ctx);
 
@@ -199,6 +232,10 @@ xmpp_stanza_t * stanza_enable_carbons(xmpp_ctx_t *ctx);
 
 xmpp_stanza_t * stanza_disable_carbons(xmpp_ctx_t *ctx);
 
+xmpp_stanza_t * stanza_create_sm_enable(xmpp_ctx_t *ctx);
+xmpp_stanza_t * stanza_create_sm_request(xmpp_ctx_t *ctx);
+xmpp_stanza_t * stanza_create_sm_answer(xmpp_ctx_t *ctx, guint32 handled);
+
 xmpp_stanza_t* stanza_create_chat_state(xmpp_ctx_t *ctx,
     const char * const fulljid, const char * const state);
 
@@ -212,7 +249,7 @@ xmpp_stanza_t* stanza_create_message(xmpp_ctx_t *ctx, char *id,
     const char * const recipient, const char * const type, const char * const message);
 
 xmpp_stanza_t* stanza_create_room_join_presence(xmpp_ctx_t * const ctx,
-    const char * const full_room_jid, const char * const passwd);
+    const char * const full_room_jid, const char * const passwd, GDateTime *since);
 
 xmpp_stanza_t* stanza_create_room_newnick_presence(xmpp_ctx_t *ctx,
     const char * const full_room_jid);
@@ -222,7 +259,7 @@ xmpp_stanza_t* stanza_create_room_leave_presence(xmpp_ctx_t *ctx,
 
 xmpp_stanza_t* stanza_create_presence(xmpp_ctx_t * const ctx);
 
-xmpp_stanza_t* stanza_create_roster_iq(xmpp_ctx_t *ctx);
+xmpp_stanza_t* stanza_create_roster_iq(xmpp_ctx_t *ctx, const char * const ver);
 xmpp_stanza_t* stanza_create_ping_iq(xmpp_ctx_t *ctx, const char * const target);
 xmpp_stanza_t* stanza_create_disco_info_iq(xmpp_ctx_t *ctx, const char * const id,
     const char * const to, const char * const node);
@@ -307,9 +344,9 @@ char* stanza_get_muc_destroy_reason(xmpp_stanza_t *stanza);
 char* stanza_get_actor(xmpp_stanza_t *stanza);
 char* stanza_get_reason(xmpp_stanza_t *stanza);
 
-Resource* stanza_resource_from_presence(XMPPPresence *presence);
-XMPPPresence* stanza_parse_presence(xmpp_stanza_t *stanza, int *err);
-void stanza_free_presence(XMPPPresence *presence);
+void stanza_parse_presence_fields(xmpp_stanza_t * const stanza, XMPPPresenceFields *fields);
+void stanza_free_presence_fields(XMPPPresenceFields *fields);
+void stanza_parse_message_fields(xmpp_stanza_t * const stanza, XMPPMessageFields *fields);
 
 XMPPCaps* stanza_parse_caps(xmpp_stanza_t * const stanza);
 void stanza_free_caps(XMPPCaps *caps);
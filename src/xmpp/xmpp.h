@@ -72,6 +72,23 @@ typedef enum {
     INVITE_MEDIATED
 } jabber_invite_t;
 
+// namespaces understood by profanity, each maps to a bit in
+// Capabilities->feature_bits, see capabilities.c
+typedef enum {
+    FEATURE_CHATSTATES      = 1 << 0,
+    FEATURE_RECEIPTS        = 1 << 1,
+    FEATURE_CARBONS         = 1 << 2,
+    FEATURE_PING            = 1 << 3,
+    FEATURE_LASTACTIVITY    = 1 << 4,
+    FEATURE_VERSION         = 1 << 5,
+    FEATURE_MUC             = 1 << 6,
+    FEATURE_CONFERENCE      = 1 << 7,
+    FEATURE_CAPS            = 1 << 8,
+    FEATURE_DISCO_INFO      = 1 << 9,
+    FEATURE_DISCO_ITEMS     = 1 << 10,
+    FEATURE_DATA            = 1 << 11
+} caps_feature_t;
+
 typedef struct capabilities_t {
     char *category;
     char *type;
@@ -81,6 +98,8 @@ typedef struct capabilities_t {
     char *os;
     char *os_version;
     GSList *features;
+    guint feature_bits;
+    int refcount;
 } Capabilities;
 
 typedef struct disco_item_t {
@@ -144,7 +163,10 @@ jabber_conn_status_t jabber_connect_with_account(const ProfAccount * const accou
 void jabber_disconnect(void);
 void jabber_shutdown(void);
 void jabber_process_events(int millis);
+void jabber_cork(void);
+void jabber_uncork(void);
 const char * jabber_get_fulljid(void);
+Jid * jabber_get_jid(void);
 const char * jabber_get_domain(void);
 jabber_conn_status_t jabber_get_connection_status(void);
 char * jabber_get_presence_message(void);
@@ -209,10 +231,15 @@ void iq_room_role_set(const char * const room, const char * const nick, char *ro
     const char * const reason);
 void iq_room_role_list(const char * const room, char *role);
 
+// stream management functions
+void sm_enable(void);
+
 // caps functions
 Capabilities* caps_lookup(const char * const jid);
+gboolean caps_jid_has_feature(const char * const jid, caps_feature_t feature);
 void caps_close(void);
-void caps_destroy(Capabilities *caps);
+Capabilities* caps_ref(Capabilities *caps);
+void caps_unref(Capabilities *caps);
 
 gboolean bookmark_add(const char *jid, const char *nick, const char *password, const char *autojoin_str);
 gboolean bookmark_update(const char *jid, const char *nick, const char *password, const char *autojoin_str);
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+
+#include "tools/autocomplete.h"
+#include "benchmarks.h"
+
+#define BENCH_AC_ENTRIES 10000
+#define BENCH_FUZZY_ENTRIES 20000
+#define BENCH_NICK_ENTRIES 2000
+
+static const char * const nick_parts[] = {
+    "an", "ber", "cal", "dra", "el", "fin", "gor", "hal", "is", "jo",
+    "kel", "lin", "mar", "nor", "ol", "pet", "ros", "sam", "tom", "ver"
+};
+
+static char *
+_fuzzy_entry(int i)
+{
+    return g_strdup_printf("user%05d.%s@server%02d.org", i,
+        (i % 3 == 0) ? "smith" : (i % 3 == 1) ? "jones" : "taylor", i % 50);
+}
+
+static char *
+_nick(int i)
+{
+    return g_strdup_printf("%s%s%s%d", nick_parts[i % 20], nick_parts[(i / 20) % 20],
+        nick_parts[(i / 400) % 20], i % 7);
+}
+
+static char *
+_entry(int i)
+{
+    return g_strdup_printf("contact%05d@server%02d.org", i * 7919 % BENCH_AC_ENTRIES, i % 50);
+}
+
+void
+bench_autocomplete(void)
+{
+    Autocomplete ac = autocomplete_new();
+    int i;
+
+    gint64 start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_AC_ENTRIES; i++) {
+        char *entry = _entry(i);
+        autocomplete_add(ac, entry);
+        g_free(entry);
+    }
+    gint64 end = g_get_monotonic_time();
+    bench_report("add 10k", start, end, BENCH_AC_ENTRIES);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_AC_ENTRIES; i++) {
+        char *entry = _entry(i);
+        autocomplete_contains(ac, entry);
+        g_free(entry);
+    }
+    end = g_get_monotonic_time();
+    bench_report("contains 10k", start, end, BENCH_AC_ENTRIES);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_AC_ENTRIES; i++) {
+        char *found = autocomplete_complete(ac, "contact09", FALSE);
+        free(found);
+    }
+    end = g_get_monotonic_time();
+    autocomplete_reset(ac);
+    bench_report("complete and cycle, late prefix", start, end, BENCH_AC_ENTRIES);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_AC_ENTRIES; i++) {
+        char *found = autocomplete_complete(ac, "nomatch", FALSE);
+        free(found);
+    }
+    end = g_get_monotonic_time();
+    bench_report("complete, no match", start, end, BENCH_AC_ENTRIES);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_AC_ENTRIES; i++) {
+        char *entry = _entry(i);
+        autocomplete_remove(ac, entry);
+        g_free(entry);
+    }
+    end = g_get_monotonic_time();
+    bench_report("remove 10k", start, end, BENCH_AC_ENTRIES);
+
+    autocomplete_free(ac);
+}
+
+void
+bench_autocomplete_fuzzy(void)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_set_fuzzy(ac, TRUE);
+    autocomplete_fuzzy_enable(TRUE);
+    int i;
+
+    gint64 start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_FUZZY_ENTRIES; i++) {
+        char *entry = _fuzzy_entry(i);
+        autocomplete_add(ac, entry);
+        g_free(entry);
+    }
+    gint64 end = g_get_monotonic_time();
+    bench_report("add 20k indexed", start, end, BENCH_FUZZY_ENTRIES);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < 1000; i++) {
+        char *found = autocomplete_complete(ac, "01234.jon", FALSE);
+        free(found);
+        autocomplete_reset(ac);
+    }
+    end = g_get_monotonic_time();
+    bench_report("fuzzy tab press, rare trigram", start, end, 1000);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < 100; i++) {
+        char *found = autocomplete_complete(ac, "smith@server", FALSE);
+        free(found);
+        autocomplete_reset(ac);
+    }
+    end = g_get_monotonic_time();
+    bench_report("fuzzy tab press, common trigrams", start, end, 100);
+
+    autocomplete_fuzzy_enable(FALSE);
+    autocomplete_free(ac);
+}
+
+void
+bench_autocomplete_nicks(void)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_set_fuzzy(ac, TRUE);
+    autocomplete_fuzzy_enable(TRUE);
+    int i;
+
+    gint64 start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_NICK_ENTRIES; i++) {
+        char *nick = _nick(i);
+        autocomplete_add(ac, nick);
+        g_free(nick);
+    }
+    gint64 end = g_get_monotonic_time();
+    bench_report("add 2k nicks indexed", start, end, BENCH_NICK_ENTRIES);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < 1000; i++) {
+        char *found = autocomplete_complete(ac, "marolpet", FALSE);
+        free(found);
+        autocomplete_reset(ac);
+    }
+    end = g_get_monotonic_time();
+    bench_report("fuzzy tab press, nick with typo", start, end, 1000);
+
+    start = g_get_monotonic_time();
+    for (i = 0; i < 1000; i++) {
+        char *found = autocomplete_complete(ac, "samtom", FALSE);
+        free(found);
+        autocomplete_reset(ac);
+    }
+    end = g_get_monotonic_time();
+    bench_report("fuzzy tab press, common nick parts", start, end, 1000);
+
+    autocomplete_fuzzy_enable(FALSE);
+    autocomplete_free(ac);
+}
@@ -0,0 +1,3 @@
+void bench_autocomplete(void);
+void bench_autocomplete_fuzzy(void);
+void bench_autocomplete_nicks(void);
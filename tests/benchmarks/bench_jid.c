@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+
+#include "jid.h"
+#include "benchmarks.h"
+
+#define BENCH_JID_DISTINCT 10000
+#define BENCH_JID_REPEATED 100000
+#define BENCH_JID_CONTACTS 200
+
+static char *
+_fulljid(int i)
+{
+    return g_strdup_printf("Contact%05d@Server%02d.org/resource%d", i, i % 50, i % 3);
+}
+
+void
+bench_jid(void)
+{
+    char **jids = malloc(sizeof(char *) * BENCH_JID_DISTINCT);
+    int i;
+
+    for (i = 0; i < BENCH_JID_DISTINCT; i++) {
+        jids[i] = _fulljid(i);
+    }
+
+    // every parse misses the cache
+    gint64 start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_JID_DISTINCT; i++) {
+        Jid *jid = jid_create(jids[i]);
+        jid_destroy(jid);
+    }
+    gint64 end = g_get_monotonic_time();
+    bench_report("create distinct 10k", start, end, BENCH_JID_DISTINCT);
+    jid_cache_clear();
+
+    // a presence burst from a small roster
+    start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_JID_REPEATED; i++) {
+        Jid *jid = jid_create(jids[i % BENCH_JID_CONTACTS]);
+        jid_destroy(jid);
+    }
+    end = g_get_monotonic_time();
+    bench_report("create repeated 100k", start, end, BENCH_JID_REPEATED);
+
+    Jid *held = jid_create(jids[0]);
+    start = g_get_monotonic_time();
+    for (i = 0; i < BENCH_JID_REPEATED; i++) {
+        Jid *ref = jid_ref(held);
+        jid_destroy(ref);
+    }
+    end = g_get_monotonic_time();
+    bench_report("ref 100k", start, end, BENCH_JID_REPEATED);
+    jid_destroy(held);
+    jid_cache_clear();
+
+    for (i = 0; i < BENCH_JID_DISTINCT; i++) {
+        g_free(jids[i]);
+    }
+    free(jids);
+}
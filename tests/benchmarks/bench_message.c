@@ -0,0 +1,382 @@
+#include "config.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <glib.h>
+
+#ifdef HAVE_LIBMESODE
+#include <mesode.h>
+#endif
+#ifdef HAVE_LIBSTROPHE
+#include <strophe.h>
+#endif
+
+#include "xmpp/message.h"
+#include "xmpp/stanza.h"
+#include "benchmarks.h"
+#include "bench_message_old.h"
+#include "stub_message.h"
+
+#define BENCH_MESSAGE_COUNT 100000
+#define BENCH_MESSAGE_KINDS 4
+
+// chat with body, chat state and receipt request, typing notification,
+// room message and delivery receipt
+static const char * const bench_messages[BENCH_MESSAGE_KINDS] = {
+    "<message type='chat' from='buddy@localhost/laptop' id='bench1'>"
+        "<body>hello there</body>"
+        "<active xmlns='http://jabber.org/protocol/chatstates'/>"
+        "<request xmlns='urn:xmpp:receipts'/>"
+    "</message>",
+    "<message type='chat' from='buddy@localhost/laptop' id='bench2'>"
+        "<composing xmlns='http://jabber.org/protocol/chatstates'/>"
+    "</message>",
+    "<message type='groupchat' from='room@conference.localhost/nick' id='bench3'>"
+        "<body>hello room</body>"
+    "</message>",
+    "<message from='buddy@localhost/laptop' id='bench4'>"
+        "<received xmlns='urn:xmpp:receipts' id='bench1'/>"
+    "</message>"
+};
+
+#define BENCH_STREAM_HEADER \
+    "<?xml version='1.0'?>" \
+    "<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams'" \
+    " id='bench' from='localhost' version='1.0'>"
+
+typedef void(*bench_register_func)(xmpp_conn_t * const conn, xmpp_ctx_t * const ctx);
+
+// steps of the login the loopback server answers, in order
+typedef enum {
+    BENCH_SERVER_STREAM,
+    BENCH_SERVER_AUTH,
+    BENCH_SERVER_RESTART,
+    BENCH_SERVER_BIND,
+    BENCH_SERVER_SESSION
+} bench_server_state_t;
+
+// a loopback server which logs the client in then streams messages to it,
+// so stanzas arrive through libstrophe's parser and handler dispatch
+static struct {
+    int listener;
+    int client;
+    bench_server_state_t state;
+    GString *in;
+    GString *out;
+    gsize out_sent;
+} server;
+
+static gboolean connected = FALSE;
+static gboolean closed = FALSE;
+static int received = 0;
+
+static gboolean
+_server_listen(void)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    server.listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (server.listener < 0) {
+        return FALSE;
+    }
+    if (bind(server.listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+            listen(server.listener, 1) != 0 ||
+            getsockname(server.listener, (struct sockaddr *)&addr, &addr_len) != 0) {
+        close(server.listener);
+        return FALSE;
+    }
+    fcntl(server.listener, F_SETFL, O_NONBLOCK);
+
+    server.client = -1;
+    server.in = g_string_new(NULL);
+    server.out = g_string_new(NULL);
+
+    return TRUE;
+}
+
+static int
+_server_port(void)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    getsockname(server.listener, (struct sockaddr *)&addr, &addr_len);
+
+    return ntohs(addr.sin_port);
+}
+
+static void
+_server_close_client(void)
+{
+    if (server.client >= 0) {
+        close(server.client);
+        server.client = -1;
+    }
+    server.state = BENCH_SERVER_STREAM;
+    g_string_truncate(server.in, 0);
+    g_string_truncate(server.out, 0);
+    server.out_sent = 0;
+}
+
+// consume input up to and including the first occurrence of marker
+static gboolean
+_server_take(const char * const marker)
+{
+    char *found = strstr(server.in->str, marker);
+    if (found == NULL) {
+        return FALSE;
+    }
+
+    g_string_erase(server.in, 0, (found - server.in->str) + strlen(marker));
+    return TRUE;
+}
+
+// consume the next iq, returning its id
+static char *
+_server_take_iq_id(void)
+{
+    char *iq = strstr(server.in->str, "<iq");
+    if (iq == NULL) {
+        return NULL;
+    }
+    char *iq_end = strstr(iq, "</iq>");
+    if (iq_end == NULL) {
+        return NULL;
+    }
+
+    char *id = NULL;
+    char *id_attr = strstr(iq, "id=\"");
+    if (id_attr && id_attr < iq_end) {
+        id_attr += strlen("id=\"");
+        char *id_end = strchr(id_attr, '"');
+        if (id_end) {
+            id = g_strndup(id_attr, id_end - id_attr);
+        }
+    }
+    g_string_erase(server.in, 0, (iq_end - server.in->str) + strlen("</iq>"));
+
+    return id;
+}
+
+static void
+_server_respond(void)
+{
+    char *id = NULL;
+
+    switch (server.state)
+    {
+        case BENCH_SERVER_STREAM:
+            if (_server_take("<stream:stream")) {
+                g_string_append(server.out, BENCH_STREAM_HEADER
+                    "<stream:features>"
+                    "<mechanisms xmlns='urn:ietf:params:xml:ns:xmpp-sasl'><mechanism>PLAIN</mechanism></mechanisms>"
+                    "</stream:features>");
+                server.state = BENCH_SERVER_AUTH;
+            }
+            break;
+        case BENCH_SERVER_AUTH:
+            if (_server_take("</auth>")) {
+                g_string_append(server.out, "<success xmlns='urn:ietf:params:xml:ns:xmpp-sasl'/>");
+                server.state = BENCH_SERVER_RESTART;
+            }
+            break;
+        case BENCH_SERVER_RESTART:
+            if (_server_take("<stream:stream")) {
+                g_string_append(server.out, BENCH_STREAM_HEADER
+                    "<stream:features>"
+                    "<bind xmlns='urn:ietf:params:xml:ns:xmpp-bind'/>"
+                    "<session xmlns='urn:ietf:params:xml:ns:xmpp-session'/>"
+                    "</stream:features>");
+                server.state = BENCH_SERVER_BIND;
+            }
+            break;
+        case BENCH_SERVER_BIND:
+            id = _server_take_iq_id();
+            if (id) {
+                g_string_append_printf(server.out, "<iq type='result' id='%s'>"
+                    "<bind xmlns='urn:ietf:params:xml:ns:xmpp-bind'><jid>bench@localhost/bench</jid></bind>"
+                    "</iq>", id);
+                server.state = BENCH_SERVER_SESSION;
+            }
+            break;
+        case BENCH_SERVER_SESSION:
+            id = _server_take_iq_id();
+            if (id) {
+                g_string_append_printf(server.out, "<iq type='result' id='%s'/>", id);
+            }
+            break;
+    }
+
+    g_free(id);
+}
+
+static void
+_server_pump(void)
+{
+    if (server.client < 0) {
+        server.client = accept(server.listener, NULL, NULL);
+        if (server.client < 0) {
+            return;
+        }
+        fcntl(server.client, F_SETFL, O_NONBLOCK);
+    }
+
+    char buf[4096];
+    ssize_t len = 0;
+    while ((len = recv(server.client, buf, sizeof(buf), 0)) > 0) {
+        g_string_append_len(server.in, buf, len);
+    }
+
+    bench_server_state_t state;
+    do {
+        state = server.state;
+        _server_respond();
+    } while (state != server.state);
+
+    while (server.out_sent < server.out->len) {
+        len = send(server.client, server.out->str + server.out_sent, server.out->len - server.out_sent, 0);
+        if (len <= 0) {
+            break;
+        }
+        server.out_sent += len;
+    }
+    if (server.out_sent == server.out->len) {
+        g_string_truncate(server.out, 0);
+        server.out_sent = 0;
+    }
+}
+
+static void
+_bench_conn_handler(xmpp_conn_t * const conn, const xmpp_conn_event_t status, const int error,
+    xmpp_stream_error_t * const stream_error, void * const userdata)
+{
+    if (status == XMPP_CONN_CONNECT) {
+        connected = TRUE;
+    } else {
+        connected = FALSE;
+        closed = TRUE;
+    }
+}
+
+#ifdef HAVE_LIBMESODE
+static int
+_bench_certfail_cb(const char * const certname, const char * const certfp,
+    char * const notbefore, char * const notafter, const char * const errormsg)
+{
+    return 0;
+}
+#endif
+
+static int
+_bench_count_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    received++;
+    return 1;
+}
+
+static void
+_register_none(xmpp_conn_t * const conn, xmpp_ctx_t * const ctx)
+{
+}
+
+static void
+_register_single(xmpp_conn_t * const conn, xmpp_ctx_t * const ctx)
+{
+    message_add_handlers();
+}
+
+// log in over loopback, register the handlers, then time the stream of
+// messages until every one has been dispatched
+static void
+_bench_registration(xmpp_ctx_t *ctx, const char * const name, GString *payload, bench_register_func register_handlers)
+{
+    xmpp_conn_t *conn = xmpp_conn_new(ctx);
+    xmpp_conn_set_jid(conn, "bench@localhost");
+    xmpp_conn_set_pass(conn, "bench");
+    xmpp_conn_disable_tls(conn);
+    stub_message_set_conn(conn, ctx);
+
+    connected = FALSE;
+    closed = FALSE;
+#ifdef HAVE_LIBMESODE
+    int res = xmpp_connect_client(conn, "127.0.0.1", _server_port(), _bench_certfail_cb, _bench_conn_handler, ctx);
+#else
+    int res = xmpp_connect_client(conn, "127.0.0.1", _server_port(), _bench_conn_handler, ctx);
+#endif
+    while (res == 0 && !connected && !closed) {
+        xmpp_run_once(ctx, 1);
+        _server_pump();
+    }
+    if (!connected) {
+        printf("  %-40s login to loopback server failed\n", name);
+        _server_close_client();
+        xmpp_conn_release(conn);
+        return;
+    }
+
+    register_handlers(conn, ctx);
+    xmpp_handler_add(conn, _bench_count_handler, NULL, STANZA_NAME_MESSAGE, NULL, NULL);
+    received = 0;
+    guint events = stub_message_events();
+    g_string_append_len(server.out, payload->str, payload->len);
+
+    gint64 start = g_get_monotonic_time();
+    while (connected && received < BENCH_MESSAGE_COUNT) {
+        _server_pump();
+        xmpp_run_once(ctx, 1);
+    }
+    gint64 end = g_get_monotonic_time();
+
+    bench_report(name, start, end, BENCH_MESSAGE_COUNT);
+    printf("  %-40s %10.0f msg/s %10u events\n", "", received / ((end - start) / 1000000.0),
+        stub_message_events() - events);
+
+    // closing the server side ends the stream
+    _server_close_client();
+    while (!closed) {
+        xmpp_run_once(ctx, 1);
+    }
+    xmpp_conn_release(conn);
+}
+
+void
+bench_message(void)
+{
+    if (!_server_listen()) {
+        printf("  could not listen on loopback\n");
+        return;
+    }
+
+    GString *payload = g_string_new(NULL);
+    int i;
+    for (i = 0; i < BENCH_MESSAGE_COUNT; i++) {
+        g_string_append(payload, bench_messages[i % BENCH_MESSAGE_KINDS]);
+    }
+
+    xmpp_initialize();
+    xmpp_ctx_t *ctx = xmpp_ctx_new(NULL, NULL);
+
+    // parse and dispatch with no message handlers, the floor for both
+    _bench_registration(ctx, "dispatch only 100k", payload, _register_none);
+    _bench_registration(ctx, "seven handlers 100k", payload, bench_message_old_add_handlers);
+    _bench_registration(ctx, "single _message_handler 100k", payload, _register_single);
+
+    xmpp_ctx_free(ctx);
+    xmpp_shutdown();
+
+    g_string_free(payload, TRUE);
+    g_string_free(server.in, TRUE);
+    g_string_free(server.out, TRUE);
+    close(server.listener);
+}
@@ -0,0 +1 @@
+void bench_message(void);
@@ -0,0 +1,538 @@
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#ifdef HAVE_LIBMESODE
+#include <mesode.h>
+#endif
+#ifdef HAVE_LIBSTROPHE
+#include <strophe.h>
+#endif
+
+#include "chat_session.h"
+#include "config/preferences.h"
+#include "log.h"
+#include "muc.h"
+#include "ui/ui.h"
+#include "event/server_events.h"
+#include "xmpp/connection.h"
+#include "xmpp/stanza.h"
+#include "xmpp/xmpp.h"
+#include "bench_message_old.h"
+
+// the seven <message> handlers registered before the single
+// _message_handler, copied unchanged from message.c so both registrations
+// can be dispatched the same stanzas
+
+#define HANDLE(ns, type, func) xmpp_handler_add(conn, func, ns, STANZA_NAME_MESSAGE, type, ctx)
+
+static int _groupchat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _chat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _muc_user_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _conference_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _captcha_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _message_error_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+static int _receipt_received_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata);
+
+void
+bench_message_old_add_handlers(xmpp_conn_t * const conn, xmpp_ctx_t * const ctx)
+{
+    HANDLE(NULL,                 STANZA_TYPE_ERROR,      _message_error_handler);
+    HANDLE(NULL,                 STANZA_TYPE_GROUPCHAT,  _groupchat_handler);
+    HANDLE(NULL,                 NULL,                   _chat_handler);
+    HANDLE(STANZA_NS_MUC_USER,   NULL,                   _muc_user_handler);
+    HANDLE(STANZA_NS_CONFERENCE, NULL,                   _conference_handler);
+    HANDLE(STANZA_NS_CAPTCHA,    NULL,                   _captcha_handler);
+    HANDLE(STANZA_NS_RECEIPTS,   NULL,                   _receipt_received_handler);
+}
+
+static int
+_message_error_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    char *id = xmpp_stanza_get_id(stanza);
+    char *jid = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    xmpp_stanza_t *error_stanza = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_ERROR);
+    char *type = NULL;
+    if (error_stanza) {
+        type = xmpp_stanza_get_attribute(error_stanza, STANZA_ATTR_TYPE);
+    }
+
+    // stanza_get_error never returns NULL
+    char *err_msg = stanza_get_error_message(stanza);
+
+    GString *log_msg = g_string_new("message stanza error received");
+    if (id) {
+        g_string_append(log_msg, " id=");
+        g_string_append(log_msg, id);
+    }
+    if (jid) {
+        g_string_append(log_msg, " from=");
+        g_string_append(log_msg, jid);
+    }
+    if (type) {
+        g_string_append(log_msg, " type=");
+        g_string_append(log_msg, type);
+    }
+    g_string_append(log_msg, " error=");
+    g_string_append(log_msg, err_msg);
+
+    log_info(log_msg->str);
+
+    g_string_free(log_msg, TRUE);
+
+    if (!jid) {
+        ui_handle_error(err_msg);
+    } else if (type && (strcmp(type, "cancel") == 0)) {
+        log_info("Recipient %s not found: %s", jid, err_msg);
+        Jid *jidp = jid_create(jid);
+        chat_session_remove(jidp->barejid);
+        jid_destroy(jidp);
+    } else {
+        ui_handle_recipient_error(jid, err_msg);
+    }
+
+    free(err_msg);
+
+    return 1;
+}
+
+static int
+_muc_user_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    xmpp_ctx_t *ctx = connection_get_ctx();
+    xmpp_stanza_t *xns_muc_user = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_MUC_USER);
+    char *room = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+
+    if (!room) {
+        log_warning("Message received with no from attribute, ignoring");
+        return 1;
+    }
+
+    // XEP-0045
+    xmpp_stanza_t *invite = xmpp_stanza_get_child_by_name(xns_muc_user, STANZA_NAME_INVITE);
+    if (!invite) {
+        return 1;
+    }
+
+    char *invitor_jid = xmpp_stanza_get_attribute(invite, STANZA_ATTR_FROM);
+    if (!invitor_jid) {
+        log_warning("Chat room invite received with no from attribute");
+        return 1;
+    }
+
+    Jid *jidp = jid_create(invitor_jid);
+    if (!jidp) {
+        return 1;
+    }
+    char *invitor = jidp->barejid;
+
+    char *reason = NULL;
+    xmpp_stanza_t *reason_st = xmpp_stanza_get_child_by_name(invite, STANZA_NAME_REASON);
+    if (reason_st) {
+        reason = xmpp_stanza_get_text(reason_st);
+    }
+
+    char *password = NULL;
+    xmpp_stanza_t *password_st = xmpp_stanza_get_child_by_name(xns_muc_user, STANZA_NAME_PASSWORD);
+    if (password_st) {
+        password = xmpp_stanza_get_text(password_st);
+    }
+
+    sv_ev_room_invite(INVITE_MEDIATED, invitor, room, reason, password);
+    jid_destroy(jidp);
+    if (reason) {
+        xmpp_free(ctx, reason);
+    }
+    if (password) {
+        xmpp_free(ctx, password);
+    }
+
+    return 1;
+}
+
+static int
+_conference_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    xmpp_stanza_t *xns_conference = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_CONFERENCE);
+
+    char *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    if (!from) {
+        log_warning("Message received with no from attribute, ignoring");
+        return 1;
+    }
+
+    Jid *jidp = jid_create(from);
+    if (!jidp) {
+        return 1;
+    }
+
+    // XEP-0249
+    char *room = xmpp_stanza_get_attribute(xns_conference, STANZA_ATTR_JID);
+    if (!room) {
+        jid_destroy(jidp);
+        return 1;
+    }
+
+    char *reason = xmpp_stanza_get_attribute(xns_conference, STANZA_ATTR_REASON);
+    char *password = xmpp_stanza_get_attribute(xns_conference, STANZA_ATTR_PASSWORD);
+
+    sv_ev_room_invite(INVITE_DIRECT, jidp->barejid, room, reason, password);
+    jid_destroy(jidp);
+
+    return 1;
+}
+
+static int
+_captcha_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    xmpp_ctx_t *ctx = connection_get_ctx();
+    char *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+
+    if (!from) {
+        log_warning("Message received with no from attribute, ignoring");
+        return 1;
+    }
+
+    // XEP-0158
+    xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
+    if (!body) {
+        return 1;
+    }
+
+    char *message = xmpp_stanza_get_text(body);
+    if (!message) {
+        return 1;
+    }
+
+    sv_ev_room_broadcast(from, message);
+    xmpp_free(ctx, message);
+
+    return 1;
+}
+
+static int
+_groupchat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    xmpp_ctx_t *ctx = connection_get_ctx();
+    char *message = NULL;
+    char *room_jid = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    Jid *jid = jid_create(room_jid);
+
+    // handle room subject
+    xmpp_stanza_t *subject = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_SUBJECT);
+    if (subject) {
+        message = xmpp_stanza_get_text(subject);
+        sv_ev_room_subject(jid->barejid, jid->resourcepart, message);
+        xmpp_free(ctx, message);
+
+        jid_destroy(jid);
+        return 1;
+    }
+
+    // handle room broadcasts
+    if (!jid->resourcepart) {
+        xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
+        if (!body) {
+            jid_destroy(jid);
+            return 1;
+        }
+
+        message = xmpp_stanza_get_text(body);
+        if (!message) {
+            jid_destroy(jid);
+            return 1;
+        }
+
+        sv_ev_room_broadcast(room_jid, message);
+        xmpp_free(ctx, message);
+
+        jid_destroy(jid);
+        return 1;
+    }
+
+    if (!jid_is_valid_room_form(jid)) {
+        log_error("Invalid room JID: %s", jid->str);
+        jid_destroy(jid);
+        return 1;
+    }
+
+    // room not active in profanity
+    if (!muc_active(jid->barejid)) {
+        log_error("Message received for inactive chat room: %s", jid->str);
+        jid_destroy(jid);
+        return 1;
+    }
+
+    xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
+
+    // check for and deal with message
+    if (!body) {
+        jid_destroy(jid);
+        return 1;
+    }
+
+    message = xmpp_stanza_get_text(body);
+    if (!message) {
+        jid_destroy(jid);
+        return 1;
+    }
+
+    // determine if the notifications happened whilst offline
+    GDateTime *timestamp = stanza_get_delay(stanza);
+    if (timestamp) {
+        sv_ev_room_history(jid->barejid, jid->resourcepart, timestamp, message);
+        g_date_time_unref(timestamp);
+    } else {
+        sv_ev_room_message(jid->barejid, jid->resourcepart, message);
+    }
+
+    xmpp_free(ctx, message);
+    jid_destroy(jid);
+
+    return 1;
+}
+
+static void
+_message_send_receipt(const char * const fulljid, const char * const message_id)
+{
+    xmpp_conn_t * const conn = connection_get_conn();
+    xmpp_ctx_t * const ctx = connection_get_ctx();
+    xmpp_stanza_t *message = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(message, STANZA_NAME_MESSAGE);
+    char *id = create_unique_id("receipt");
+    xmpp_stanza_set_id(message, id);
+    free(id);
+    xmpp_stanza_set_attribute(message, STANZA_ATTR_TO, fulljid);
+
+    xmpp_stanza_t *receipt = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(receipt, "received");
+    xmpp_stanza_set_ns(receipt, STANZA_NS_RECEIPTS);
+    xmpp_stanza_set_attribute(receipt, STANZA_ATTR_ID, message_id);
+
+    xmpp_stanza_add_child(message, receipt);
+    xmpp_stanza_release(receipt);
+
+    xmpp_send(conn, message);
+    xmpp_stanza_release(message);
+}
+
+static int
+_receipt_received_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    xmpp_stanza_t *receipt = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_RECEIPTS);
+    char *name = xmpp_stanza_get_name(receipt);
+    if (g_strcmp0(name, "received") != 0) {
+        return 1;
+    }
+
+    char *id = xmpp_stanza_get_attribute(receipt, STANZA_ATTR_ID);
+    if (!id) {
+        return 1;
+    }
+
+    char *fulljid = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    if (!fulljid) {
+        return 1;
+    }
+
+    Jid *jidp = jid_create(fulljid);
+    sv_ev_message_receipt(jidp->barejid, id);
+    jid_destroy(jidp);
+
+    return 1;
+}
+
+static void
+_receipt_request_handler(xmpp_stanza_t * const stanza)
+{
+    if (!prefs_get_boolean(PREF_RECEIPTS_SEND)) {
+        return;
+    }
+
+    char *id = xmpp_stanza_get_id(stanza);
+    if (!id) {
+        return;
+    }
+
+    xmpp_stanza_t *receipts = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_RECEIPTS);
+    if (!receipts) {
+        return;
+    }
+
+    char *receipts_name = xmpp_stanza_get_name(receipts);
+    if (g_strcmp0(receipts_name, "request") != 0) {
+        return;
+    }
+
+    gchar *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    Jid *jid = jid_create(from);
+    _message_send_receipt(jid->fulljid, id);
+    jid_destroy(jid);
+}
+
+static void
+_private_chat_handler(xmpp_stanza_t * const stanza, const char * const fulljid)
+{
+    xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
+    if (!body) {
+        return;
+    }
+
+    char *message = xmpp_stanza_get_text(body);
+    if (!message) {
+        return;
+    }
+
+    GDateTime *timestamp = stanza_get_delay(stanza);
+    if (timestamp) {
+        sv_ev_delayed_private_message(fulljid, message, timestamp);
+        g_date_time_unref(timestamp);
+    } else {
+        sv_ev_incoming_private_message(fulljid, message);
+    }
+
+    xmpp_ctx_t *ctx = connection_get_ctx();
+    xmpp_free(ctx, message);
+}
+
+static gboolean
+_handle_carbons(xmpp_stanza_t * const stanza)
+{
+    xmpp_stanza_t *carbons = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_CARBONS);
+    if (!carbons) {
+        return FALSE;
+    }
+
+    char *name = xmpp_stanza_get_name(carbons);
+    if ((g_strcmp0(name, "received") == 0) || (g_strcmp0(name, "sent")) == 0) {
+        xmpp_stanza_t *forwarded = xmpp_stanza_get_child_by_ns(carbons, STANZA_NS_FORWARD);
+        xmpp_stanza_t *message = xmpp_stanza_get_child_by_name(forwarded, STANZA_NAME_MESSAGE);
+
+        xmpp_ctx_t *ctx = connection_get_ctx();
+
+        gchar *to = xmpp_stanza_get_attribute(message, STANZA_ATTR_TO);
+        gchar *from = xmpp_stanza_get_attribute(message, STANZA_ATTR_FROM);
+
+        // happens when receive a carbon of a self sent message
+        if (!to) to = from;
+
+        Jid *jid_from = jid_create(from);
+        Jid *jid_to = jid_create(to);
+        Jid *my_jid = jid_ref(jabber_get_jid());
+
+        // check for and deal with message
+        xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(message, STANZA_NAME_BODY);
+        if (body) {
+            char *message = xmpp_stanza_get_text(body);
+            if (message) {
+                // if we are the recipient, treat as standard incoming message
+                if(g_strcmp0(my_jid->barejid, jid_to->barejid) == 0){
+                    sv_ev_incoming_carbon(jid_from->barejid, jid_from->resourcepart, message);
+                }
+                // else treat as a sent message
+                else{
+                    sv_ev_outgoing_carbon(jid_to->barejid, message);
+                }
+                xmpp_free(ctx, message);
+            }
+        }
+
+        jid_destroy(jid_from);
+        jid_destroy(jid_to);
+        jid_destroy(my_jid);
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+static int
+_chat_handler(xmpp_conn_t * const conn, xmpp_stanza_t * const stanza, void * const userdata)
+{
+    // ignore if type not chat or absent
+    char *type = xmpp_stanza_get_type(stanza);
+    if (!(g_strcmp0(type, "chat") == 0 || type == NULL)) {
+        return 1;
+    }
+
+    // check if carbon message
+    gboolean res = _handle_carbons(stanza);
+    if (res) {
+        return 1;
+    }
+
+    // ignore handled namespaces
+    xmpp_stanza_t *conf = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_CONFERENCE);
+    xmpp_stanza_t *captcha = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_CAPTCHA);
+    if (conf || captcha) {
+        return 1;
+    }
+
+    // some clients send the mucuser namespace with private messages
+    // if the namespace exists, and the stanza contains a body element, assume its a private message
+    // otherwise exit the handler
+    xmpp_stanza_t *mucuser = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_MUC_USER);
+    xmpp_stanza_t *body = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_BODY);
+    if (mucuser && body == NULL) {
+        return 1;
+    }
+
+    gchar *from = xmpp_stanza_get_attribute(stanza, STANZA_ATTR_FROM);
+    Jid *jid = jid_create(from);
+
+    // private message from chat room use full jid (room/nick)
+    if (muc_active(jid->barejid)) {
+        _private_chat_handler(stanza, jid->fulljid);
+        jid_destroy(jid);
+        return 1;
+    }
+
+    // standard chat message, use jid without resource
+    xmpp_ctx_t *ctx = connection_get_ctx();
+    GDateTime *timestamp = stanza_get_delay(stanza);
+    if (body) {
+        char *message = xmpp_stanza_get_text(body);
+        if (message) {
+            char *enc_message = NULL;
+            xmpp_stanza_t *x = xmpp_stanza_get_child_by_ns(stanza, STANZA_NS_ENCRYPTED);
+            if (x) {
+                enc_message = xmpp_stanza_get_text(x);
+            }
+            sv_ev_incoming_message(jid->barejid, jid->resourcepart, message, enc_message, timestamp);
+            xmpp_free(ctx, enc_message);
+
+            _receipt_request_handler(stanza);
+
+            xmpp_free(ctx, message);
+        }
+    }
+
+    // handle chat sessions and states
+    if (!timestamp && jid->resourcepart) {
+        gboolean gone = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_GONE) != NULL;
+        gboolean typing = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_COMPOSING) != NULL;
+        gboolean paused = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_PAUSED) != NULL;
+        gboolean inactive = xmpp_stanza_get_child_by_name(stanza, STANZA_NAME_INACTIVE) != NULL;
+        if (gone) {
+            sv_ev_gone(jid->barejid, jid->resourcepart);
+        } else if (typing) {
+            sv_ev_typing(jid->barejid, jid->resourcepart);
+        } else if (paused) {
+            sv_ev_paused(jid->barejid, jid->resourcepart);
+        } else if (inactive) {
+            sv_ev_inactive(jid->barejid, jid->resourcepart);
+        } else if (stanza_contains_chat_state(stanza)) {
+            sv_ev_activity(jid->barejid, jid->resourcepart, TRUE);
+        } else {
+            sv_ev_activity(jid->barejid, jid->resourcepart, FALSE);
+        }
+    }
+
+    if (timestamp) g_date_time_unref(timestamp);
+    jid_destroy(jid);
+    return 1;
+}
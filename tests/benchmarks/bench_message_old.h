@@ -0,0 +1,15 @@
+#ifndef BENCH_MESSAGE_OLD_H
+#define BENCH_MESSAGE_OLD_H
+
+#include "config.h"
+
+#ifdef HAVE_LIBMESODE
+#include <mesode.h>
+#endif
+#ifdef HAVE_LIBSTROPHE
+#include <strophe.h>
+#endif
+
+void bench_message_old_add_handlers(xmpp_conn_t * const conn, xmpp_ctx_t * const ctx);
+
+#endif
@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <string.h>
+#include <glib.h>
+
+#include "benchmarks.h"
+#include "bench_autocomplete.h"
+#include "bench_jid.h"
+#include "bench_message.h"
+
+typedef struct benchmark_t {
+    const char *name;
+    benchmark_func func;
+} Benchmark;
+
+static Benchmark all_benchmarks[] = {
+    { "autocomplete", bench_autocomplete },
+    { "autocomplete_fuzzy", bench_autocomplete_fuzzy },
+    { "autocomplete_nicks", bench_autocomplete_nicks },
+    { "jid", bench_jid },
+    { "message", bench_message },
+};
+
+void
+bench_report(const char * const name, gint64 start, gint64 end, int ops)
+{
+    double total_ms = (end - start) / 1000.0;
+    double per_op_us = (double)(end - start) / ops;
+    printf("  %-40s %10.2f ms total %10.3f us/op\n", name, total_ms, per_op_us);
+}
+
+int main(int argc, char* argv[]) {
+    int i;
+    int count = sizeof(all_benchmarks) / sizeof(all_benchmarks[0]);
+
+    for (i = 0; i < count; i++) {
+        // run only the named benchmark when one is given
+        if (argc > 1 && strcmp(argv[1], all_benchmarks[i].name) != 0) {
+            continue;
+        }
+        printf("%s\n", all_benchmarks[i].name);
+        all_benchmarks[i].func();
+    }
+
+    return 0;
+}
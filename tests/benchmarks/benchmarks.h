@@ -0,0 +1,11 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <glib.h>
+
+typedef void(*benchmark_func)(void);
+
+// print the mean time per operation for a benchmark run
+void bench_report(const char * const name, gint64 start, gint64 end, int ops);
+
+#endif
@@ -0,0 +1,108 @@
+#include "config.h"
+
+#include <glib.h>
+
+#ifdef HAVE_LIBMESODE
+#include <mesode.h>
+#endif
+#ifdef HAVE_LIBSTROPHE
+#include <strophe.h>
+#endif
+
+#include "chat_session.h"
+#include "jid.h"
+#include "muc.h"
+#include "config/account.h"
+#include "config/accounts.h"
+#include "config/preferences.h"
+#include "event/server_events.h"
+#include "pgp/gpg.h"
+#include "ui/ui.h"
+#include "xmpp/capabilities.h"
+#include "xmpp/connection.h"
+#include "xmpp/form.h"
+#include "xmpp/xmpp.h"
+#include "stub_message.h"
+
+// everything message.c and stanza.c call outside the xmpp handlers, the
+// handlers run for real and stop at the server events
+
+static xmpp_conn_t *bench_conn = NULL;
+static xmpp_ctx_t *bench_ctx = NULL;
+static guint events = 0;
+
+void
+stub_message_set_conn(xmpp_conn_t * const conn, xmpp_ctx_t * const ctx)
+{
+    bench_conn = conn;
+    bench_ctx = ctx;
+}
+
+guint
+stub_message_events(void)
+{
+    return events;
+}
+
+// connection
+xmpp_conn_t* connection_get_conn(void) { return bench_conn; }
+xmpp_ctx_t* connection_get_ctx(void) { return bench_ctx; }
+void connection_send_stanza(xmpp_stanza_t * const stanza)
+{
+    xmpp_send(bench_conn, stanza);
+}
+char* jabber_get_account_name(void) { return NULL; }
+Jid* jabber_get_jid(void)
+{
+    static Jid *jid = NULL;
+    if (jid == NULL) {
+        jid = jid_create("bench@localhost/bench");
+    }
+    return jid;
+}
+
+// the benchmark rooms are joined, other state is empty
+gboolean muc_active(const char * const room) { return g_str_has_prefix(room, "room@"); }
+char* muc_nick(const char * const room) { return "bench"; }
+char* muc_password(const char * const room) { return NULL; }
+gboolean muc_nick_change_pending(const char * const room) { return FALSE; }
+char* muc_old_nick(const char * const room, const char * const new_nick) { return NULL; }
+muc_member_type_t muc_member_type(const char * const room) { return MUC_MEMBER_TYPE_PUBLIC; }
+
+ChatSession* chat_session_get(const char * const barejid) { return NULL; }
+void chat_session_remove(const char * const barejid) {}
+gboolean prefs_get_boolean(preference_t pref) { return FALSE; }
+ProfAccount* accounts_get_account(const char * const name) { return NULL; }
+void account_free(ProfAccount *account) {}
+gboolean caps_jid_has_feature(const char * const jid, caps_feature_t feature) { return FALSE; }
+xmpp_stanza_t* caps_create_query_response_stanza(xmpp_ctx_t * const ctx) { return NULL; }
+char* caps_get_my_sha1(xmpp_ctx_t * const ctx) { return NULL; }
+xmpp_stanza_t* form_create_submission(DataForm *form) { return NULL; }
+#ifdef HAVE_LIBGPGME
+char* p_gpg_encrypt(const char * const barejid, const char * const message) { return NULL; }
+#endif
+
+// ui
+void ui_handle_error(const char * const err_msg) { events++; }
+void ui_handle_recipient_error(const char * const recipient, const char * const err_msg) { events++; }
+
+// server events
+void sv_ev_room_invite(jabber_invite_t invite_type, const char * const invitor, const char * const room,
+    const char * const reason, const char * const password) { events++; }
+void sv_ev_room_broadcast(const char *const room_jid, const char * const message) { events++; }
+void sv_ev_room_subject(const char * const room, const char * const nick, const char * const subject) { events++; }
+void sv_ev_room_history(const char * const room_jid, const char * const nick,
+    GDateTime *timestamp, const char * const message) { events++; }
+void sv_ev_room_message(const char * const room_jid, const char * const nick,
+    const char * const message) { events++; }
+void sv_ev_incoming_message(char *barejid, char *resource, char *message, char *pgp_message, GDateTime *timestamp) { events++; }
+void sv_ev_incoming_private_message(const char * const fulljid, char *message) { events++; }
+void sv_ev_delayed_private_message(const char * const fulljid, char *message, GDateTime *timestamp) { events++; }
+void sv_ev_typing(char *barejid, char *resource) { events++; }
+void sv_ev_paused(char *barejid, char *resource) { events++; }
+void sv_ev_inactive(char *barejid, char *resource) { events++; }
+void sv_ev_activity(char *barejid, char *resource, gboolean send_states) { events++; }
+void sv_ev_gone(const char * const barejid, const char * const resource) { events++; }
+void sv_ev_message_receipt(char *barejid, char *id) { events++; }
+void sv_ev_outgoing_carbon(char *barejid, char *message) { events++; }
+void sv_ev_incoming_carbon(char *barejid, char *resource, char *message) { events++; }
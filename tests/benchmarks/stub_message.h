@@ -0,0 +1,21 @@
+#ifndef STUB_MESSAGE_H
+#define STUB_MESSAGE_H
+
+#include "config.h"
+
+#include <glib.h>
+
+#ifdef HAVE_LIBMESODE
+#include <mesode.h>
+#endif
+#ifdef HAVE_LIBSTROPHE
+#include <strophe.h>
+#endif
+
+// the connection message_add_handlers and the handlers see
+void stub_message_set_conn(xmpp_conn_t * const conn, xmpp_ctx_t * const ctx);
+
+// server events raised by the handlers so far
+guint stub_message_events(void);
+
+#endif
@@ -20,6 +20,7 @@
 #include "test_receipts.h"
 #include "test_roster.h"
 #include "test_software.h"
+#include "test_sm.h"
 
 #define PROF_FUNC_TEST(test) unit_test_setup_teardown(test, init_prof_test, close_prof_test)
 
@@ -28,6 +29,7 @@ int main(int argc, char* argv[]) {
     const UnitTest all_tests[] = {
 
         PROF_FUNC_TEST(connect_jid_requests_roster),
+        PROF_FUNC_TEST(connect_jid_requests_roster_with_cached_version),
         PROF_FUNC_TEST(connect_jid_sends_presence_after_receiving_roster),
         PROF_FUNC_TEST(connect_jid_requests_bookmarks),
         PROF_FUNC_TEST(connect_bad_password),
@@ -82,6 +84,10 @@ int main(int argc, char* argv[]) {
         PROF_FUNC_TEST(display_software_version_result_when_from_domainpart),
         PROF_FUNC_TEST(show_message_in_chat_window_when_no_resource),
         PROF_FUNC_TEST(display_software_version_result_in_chat),
+
+        PROF_FUNC_TEST(connect_with_sm_sends_enable),
+        PROF_FUNC_TEST(sm_answers_ack_request),
+        PROF_FUNC_TEST(sm_requests_ack_after_sends),
     };
 
     return run_tests(all_tests);
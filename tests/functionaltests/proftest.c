@@ -262,3 +262,20 @@ prof_connect(void)
         "<item jid=\"buddy2@localhost\" subscription=\"both\" name=\"Buddy2\"/>"
     );
 }
+
+// connect with stream management enabled, stabber does not answer <enable/> itself
+void
+prof_connect_with_sm(void)
+{
+    prof_input("/sm on");
+    assert_true(prof_output_exact("Stream management preference enabled."));
+
+    prof_connect();
+
+    assert_true(stbbr_received(
+        "<enable xmlns=\"urn:xmpp:sm:3\"/>"
+    ));
+    stbbr_send(
+        "<enabled xmlns=\"urn:xmpp:sm:3\"/>"
+    );
+}
@@ -10,6 +10,7 @@ void close_prof_test(void **state);
 void prof_start(void);
 void prof_connect(void);
 void prof_connect_with_roster(char *roster);
+void prof_connect_with_sm(void);
 void prof_input(char *input);
 
 int prof_output_exact(char *text);
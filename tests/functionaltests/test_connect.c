@@ -17,7 +17,21 @@ connect_jid_requests_roster(void **state)
     prof_connect();
 
     assert_true(stbbr_received(
-        "<iq id=\"*\" type=\"get\"><query xmlns=\"jabber:iq:roster\"/></iq>"
+        "<iq id=\"*\" type=\"get\"><query xmlns=\"jabber:iq:roster\" ver=\"\"/></iq>"
+    ));
+}
+
+void
+connect_jid_requests_roster_with_cached_version(void **state)
+{
+    prof_connect();
+    prof_input("/disconnect");
+    assert_true(prof_output_exact("stabber@localhost logged out successfully."));
+
+    prof_connect();
+
+    assert_true(stbbr_received(
+        "<iq id=\"*\" type=\"get\"><query xmlns=\"jabber:iq:roster\" ver=\"362\"/></iq>"
     ));
 }
 
@@ -0,0 +1,54 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <stabber.h>
+#include <expect.h>
+
+#include "proftest.h"
+
+void
+connect_with_sm_sends_enable(void **state)
+{
+    prof_input("/sm on");
+
+    prof_connect();
+
+    assert_true(stbbr_received(
+        "<enable xmlns=\"urn:xmpp:sm:3\"/>"
+    ));
+}
+
+void
+sm_answers_ack_request(void **state)
+{
+    prof_connect_with_sm();
+
+    stbbr_send(
+        "<r xmlns=\"urn:xmpp:sm:3\"/>"
+    );
+
+    assert_true(stbbr_received(
+        "<a xmlns=\"urn:xmpp:sm:3\" h=\"*\"/>"
+    ));
+}
+
+void
+sm_requests_ack_after_sends(void **state)
+{
+    prof_connect_with_sm();
+
+    prof_input("/msg somejid@someserver.com One");
+    prof_input("/msg somejid@someserver.com Two");
+    prof_input("/msg somejid@someserver.com Three");
+    prof_input("/msg somejid@someserver.com Four");
+    prof_input("/msg somejid@someserver.com Five");
+
+    assert_true(stbbr_received(
+        "<r xmlns=\"urn:xmpp:sm:3\"/>"
+    ));
+}
@@ -0,0 +1,3 @@
+void connect_with_sm_sends_enable(void **state);
+void sm_answers_ack_request(void **state);
+void sm_requests_ack_after_sends(void **state);
@@ -117,3 +117,230 @@ void add_two_same_updates(void **state)
     autocomplete_clear(ac);
     g_slist_free_full(result, g_free);
 }
+
+void add_all_adds_sorted_without_duplicates(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "Help");
+    GSList *items = NULL;
+    items = g_slist_append(items, "Hello");
+    items = g_slist_append(items, "Abc");
+    items = g_slist_append(items, "Help");
+    items = g_slist_append(items, "Hello");
+    autocomplete_add_all(ac, items);
+    GSList *result = autocomplete_create_list(ac);
+
+    assert_int_equal(3, g_slist_length(result));
+    assert_string_equal("Abc", g_slist_nth_data(result, 0));
+    assert_string_equal("Hello", g_slist_nth_data(result, 1));
+    assert_string_equal("Help", g_slist_nth_data(result, 2));
+
+    autocomplete_clear(ac);
+    g_slist_free(items);
+    g_slist_free_full(result, g_free);
+}
+
+void add_all_then_complete(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    GSList *items = NULL;
+    items = g_slist_append(items, "Help");
+    items = g_slist_append(items, "Hello");
+    autocomplete_add_all(ac, items);
+    char *result = autocomplete_complete(ac, "Hel", TRUE);
+
+    assert_string_equal("Hello", result);
+
+    autocomplete_clear(ac);
+    g_slist_free(items);
+}
+
+void add_after_add_all_with_duplicates_completes(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "Help");
+    GSList *items = NULL;
+    items = g_slist_append(items, "Help");
+    items = g_slist_append(items, "Hello");
+    items = g_slist_append(items, "Hello");
+    autocomplete_add_all(ac, items);
+    autocomplete_add(ac, "Helm");
+    autocomplete_add(ac, "Helium");
+    autocomplete_add(ac, "Helix");
+    char *result1 = autocomplete_complete(ac, "Hel", TRUE);
+    char *result2 = autocomplete_complete(ac, result1, TRUE);
+
+    assert_int_equal(5, autocomplete_length(ac));
+    assert_string_equal("Helium", result1);
+    assert_string_equal("Helix", result2);
+
+    free(result1);
+    free(result2);
+    autocomplete_free(ac);
+    g_slist_free(items);
+}
+
+void complete_continues_cycle_after_add_before_last_found(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "James");
+    autocomplete_add(ac, "Jamie");
+    autocomplete_add(ac, "Jamo");
+    char *result1 = autocomplete_complete(ac, "Jam", TRUE);
+    autocomplete_add(ac, "Jamb");
+    char *result2 = autocomplete_complete(ac, result1, TRUE);
+
+    assert_string_equal("James", result1);
+    assert_string_equal("Jamie", result2);
+
+    free(result1);
+    free(result2);
+    autocomplete_free(ac);
+}
+
+void complete_wraps_to_first_match(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_add(ac, "James");
+    autocomplete_add(ac, "Jamie");
+    autocomplete_add(ac, "Bob");
+    char *result1 = autocomplete_complete(ac, "Jam", TRUE);
+    char *result2 = autocomplete_complete(ac, result1, TRUE);
+    char *result3 = autocomplete_complete(ac, result2, TRUE);
+
+    assert_string_equal("James", result1);
+    assert_string_equal("Jamie", result2);
+    assert_string_equal("James", result3);
+    assert_true(autocomplete_contains(ac, "Bob"));
+    assert_false(autocomplete_contains(ac, "Bo"));
+
+    free(result1);
+    free(result2);
+    free(result3);
+    autocomplete_free(ac);
+}
+
+void fuzzy_completes_substring_match(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_set_fuzzy(ac, TRUE);
+    autocomplete_fuzzy_enable(TRUE);
+    autocomplete_add(ac, "bob.smith@server.org");
+    autocomplete_add(ac, "james.jones@server.org");
+    char *result = autocomplete_complete(ac, "jones", TRUE);
+
+    assert_string_equal("james.jones@server.org", result);
+
+    free(result);
+    autocomplete_fuzzy_enable(FALSE);
+    autocomplete_free(ac);
+}
+
+void fuzzy_ranks_recently_used_first(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_set_fuzzy(ac, TRUE);
+    autocomplete_fuzzy_enable(TRUE);
+    autocomplete_add(ac, "anna@work.org");
+    autocomplete_add(ac, "zoe@work.org");
+    autocomplete_touch(ac, "zoe@work.org");
+    char *result1 = autocomplete_complete(ac, "work", TRUE);
+    char *result2 = autocomplete_complete(ac, result1, TRUE);
+
+    assert_string_equal("zoe@work.org", result1);
+    assert_string_equal("anna@work.org", result2);
+
+    free(result1);
+    free(result2);
+    autocomplete_fuzzy_enable(FALSE);
+    autocomplete_free(ac);
+}
+
+void fuzzy_disabled_uses_prefix_completion(void **state)
+{
+    Autocomplete ac = autocomplete_new();
+    autocomplete_set_fuzzy(ac, TRUE);
+    autocomplete_add(ac, "james.jones@server.org");
+    char *result = autocomplete_complete(ac, "jones", TRUE);
+
+    assert_null(result);
+
+    autocomplete_free(ac);
+}
+
+static const char * const static_items[] = { "/about", "/account", "/away", "/connect" };
+
+void static_completes_base_and_added_items_in_order(void **state)
+{
+    Autocomplete ac = autocomplete_new_static(static_items, 4);
+    autocomplete_add(ac, "/ab");
+    char *result1 = autocomplete_complete(ac, "/a", TRUE);
+    char *result2 = autocomplete_complete(ac, result1, TRUE);
+    char *result3 = autocomplete_complete(ac, result2, TRUE);
+    char *result4 = autocomplete_complete(ac, result3, TRUE);
+    char *result5 = autocomplete_complete(ac, result4, TRUE);
+
+    assert_string_equal("/ab", result1);
+    assert_string_equal("/about", result2);
+    assert_string_equal("/account", result3);
+    assert_string_equal("/away", result4);
+    assert_string_equal("/ab", result5);
+
+    free(result1);
+    free(result2);
+    free(result3);
+    free(result4);
+    free(result5);
+    autocomplete_free(ac);
+}
+
+void static_completes_added_items_between_base_items(void **state)
+{
+    Autocomplete ac = autocomplete_new_static(static_items, 4);
+    autocomplete_add(ac, "/accept");
+    autocomplete_add(ac, "/b");
+    char *result1 = autocomplete_complete(ac, "/a", TRUE);
+    char *result2 = autocomplete_complete(ac, result1, TRUE);
+    char *result3 = autocomplete_complete(ac, result2, TRUE);
+    char *result4 = autocomplete_complete(ac, result3, TRUE);
+    char *result5 = autocomplete_complete(ac, result4, TRUE);
+
+    assert_string_equal("/about", result1);
+    assert_string_equal("/accept", result2);
+    assert_string_equal("/account", result3);
+    assert_string_equal("/away", result4);
+    assert_string_equal("/about", result5);
+
+    free(result1);
+    free(result2);
+    free(result3);
+    free(result4);
+    free(result5);
+    autocomplete_free(ac);
+}
+
+void static_add_existing_item_not_duplicated(void **state)
+{
+    Autocomplete ac = autocomplete_new_static(static_items, 4);
+    autocomplete_add(ac, "/away");
+    GSList *result = autocomplete_create_list(ac);
+
+    assert_int_equal(4, autocomplete_length(ac));
+    assert_int_equal(4, g_slist_length(result));
+
+    g_slist_free_full(result, free);
+    autocomplete_free(ac);
+}
+
+void static_clear_removes_added_items_only(void **state)
+{
+    Autocomplete ac = autocomplete_new_static(static_items, 4);
+    autocomplete_add(ac, "/alias");
+    autocomplete_clear(ac);
+
+    assert_int_equal(4, autocomplete_length(ac));
+    assert_false(autocomplete_contains(ac, "/alias"));
+    assert_true(autocomplete_contains(ac, "/connect"));
+
+    autocomplete_free(ac);
+}
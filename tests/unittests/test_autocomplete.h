@@ -8,3 +8,15 @@ void add_two_and_complete_returns_second(void **state);
 void add_two_adds_two(void **state);
 void add_two_same_adds_one(void **state);
 void add_two_same_updates(void **state);
+void add_all_adds_sorted_without_duplicates(void **state);
+void add_all_then_complete(void **state);
+void add_after_add_all_with_duplicates_completes(void **state);
+void complete_continues_cycle_after_add_before_last_found(void **state);
+void complete_wraps_to_first_match(void **state);
+void fuzzy_completes_substring_match(void **state);
+void fuzzy_ranks_recently_used_first(void **state);
+void fuzzy_disabled_uses_prefix_completion(void **state);
+void static_completes_base_and_added_items_in_order(void **state);
+void static_completes_added_items_between_base_items(void **state);
+void static_add_existing_item_not_duplicated(void **state);
+void static_clear_removes_added_items_only(void **state);
@@ -0,0 +1,130 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "ui/buffer.h"
+
+static DeliveryReceipt*
+_receipt(const char * const id)
+{
+    DeliveryReceipt *receipt = malloc(sizeof(struct delivery_receipt_t));
+    receipt->id = strdup(id);
+    receipt->received = FALSE;
+
+    return receipt;
+}
+
+static void
+_push_messages(ProfBuff buffer, int first, int count)
+{
+    GDateTime *time = g_date_time_new_now_local();
+    int i;
+    for (i = first; i < first + count; i++) {
+        char *message = g_strdup_printf("msg%05d", i);
+        buffer_push(buffer, '-', 0, time, 0, THEME_TEXT, "", message, NULL);
+        g_free(message);
+    }
+    g_date_time_unref(time);
+}
+
+void buffer_pack_unpack_keeps_entries(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    GDateTime *time = g_date_time_new_local(2015, 10, 1, 10, 30, 15.25);
+    buffer_push(buffer, '*', 2, time, 1, THEME_TEXT_ME, "me", "hello", _receipt("id1"));
+    buffer_push(buffer, '-', 0, time, 0, THEME_TEXT_THEM, "bob", "hi there", NULL);
+
+    buffer_pack(buffer);
+    assert_true(buffer_is_packed(buffer));
+
+    assert_int_equal(2, buffer_size(buffer));
+    assert_false(buffer_is_packed(buffer));
+
+    ProfBuffEntry *first = buffer_yield_entry(buffer, 0);
+    assert_int_equal('*', first->show_char);
+    assert_int_equal(2, first->pad_indent);
+    assert_int_equal(1, first->flags);
+    assert_int_equal(THEME_TEXT_ME, first->theme_item);
+    assert_string_equal("me", first->from);
+    assert_string_equal("hello", first->message);
+    assert_int_equal(0, g_date_time_compare(time, first->time));
+    assert_true(g_date_time_get_utc_offset(time) == g_date_time_get_utc_offset(first->time));
+    assert_non_null(first->receipt);
+    assert_string_equal("id1", first->receipt->id);
+    assert_false(first->receipt->received);
+
+    ProfBuffEntry *second = buffer_yield_entry(buffer, 1);
+    assert_string_equal("bob", second->from);
+    assert_string_equal("hi there", second->message);
+    assert_null(second->receipt);
+
+    g_date_time_unref(time);
+    buffer_free(buffer);
+}
+
+void buffer_mark_received_while_packed(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    GDateTime *time = g_date_time_new_now_local();
+    buffer_push(buffer, '-', 0, time, 0, THEME_TEXT_ME, "me", "first", _receipt("id1"));
+    buffer_push(buffer, '-', 0, time, 0, THEME_TEXT_ME, "me", "second", _receipt("id2"));
+    buffer_pack(buffer);
+
+    assert_true(buffer_mark_received(buffer, "id2"));
+    assert_false(buffer_mark_received(buffer, "id2"));
+    assert_false(buffer_mark_received(buffer, "id3"));
+    assert_true(buffer_is_packed(buffer));
+
+    assert_false(buffer_yield_entry(buffer, 0)->receipt->received);
+    assert_true(buffer_yield_entry(buffer, 1)->receipt->received);
+
+    g_date_time_unref(time);
+    buffer_free(buffer);
+}
+
+void buffer_push_while_packed_kept_on_unpack(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    _push_messages(buffer, 0, 2);
+    buffer_pack(buffer);
+
+    _push_messages(buffer, 2, 1);
+
+    assert_int_equal(3, buffer_size(buffer));
+    assert_string_equal("msg00002", buffer_yield_entry(buffer, 2)->message);
+
+    buffer_free(buffer);
+}
+
+void buffer_push_while_packed_keeps_newest(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    buffer_pack(buffer);
+
+    _push_messages(buffer, 0, 1250);
+
+    assert_int_equal(1200, buffer_size(buffer));
+    assert_string_equal("msg00050", buffer_yield_entry(buffer, 0)->message);
+    assert_string_equal("msg01249", buffer_yield_entry(buffer, 1199)->message);
+
+    buffer_free(buffer);
+}
+
+void buffer_push_while_packed_bounds_memory(void **state)
+{
+    ProfBuff buffer = buffer_create();
+    buffer_pack(buffer);
+    _push_messages(buffer, 0, 1200);
+    gsize full_size = buffer_mem_size(buffer);
+
+    _push_messages(buffer, 1200, 10000);
+
+    assert_true(buffer_is_packed(buffer));
+    assert_true(buffer_mem_size(buffer) <= full_size * 2);
+
+    buffer_free(buffer);
+}
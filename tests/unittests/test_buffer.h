@@ -0,0 +1,5 @@
+void buffer_pack_unpack_keeps_entries(void **state);
+void buffer_mark_received_while_packed(void **state);
+void buffer_push_while_packed_kept_on_unpack(void **state);
+void buffer_push_while_packed_keeps_newest(void **state);
+void buffer_push_while_packed_bounds_memory(void **state);
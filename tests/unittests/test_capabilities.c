@@ -0,0 +1,127 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "helpers.h"
+#include "xmpp/xmpp.h"
+#include "xmpp/stanza.h"
+#include "xmpp/capabilities.h"
+
+static xmpp_ctx_t *ctx;
+
+static xmpp_stanza_t*
+_create_query(const char * const feature1, const char * const feature2)
+{
+    xmpp_stanza_t *query = xmpp_stanza_new(ctx);
+    xmpp_stanza_set_name(query, STANZA_NAME_QUERY);
+    xmpp_stanza_set_ns(query, XMPP_NS_DISCO_INFO);
+
+    const char *features[] = { feature1, feature2 };
+    int i;
+    for (i = 0; i < 2; i++) {
+        if (features[i]) {
+            xmpp_stanza_t *feature = xmpp_stanza_new(ctx);
+            xmpp_stanza_set_name(feature, "feature");
+            xmpp_stanza_set_attribute(feature, "var", features[i]);
+            xmpp_stanza_add_child(query, feature);
+            xmpp_stanza_release(feature);
+        }
+    }
+
+    return query;
+}
+
+static Capabilities*
+_create_caps(const char * const feature1, const char * const feature2)
+{
+    xmpp_stanza_t *query = _create_query(feature1, feature2);
+    Capabilities *caps = caps_create(query);
+    xmpp_stanza_release(query);
+
+    return caps;
+}
+
+void caps_before_test(void **state)
+{
+    create_data_dir(state);
+    ctx = xmpp_ctx_new(NULL, NULL);
+    caps_init();
+}
+
+void caps_after_test(void **state)
+{
+    caps_close();
+    xmpp_ctx_free(ctx);
+    remove("./tests/files/xdg_data_home/profanity/capscache");
+    remove_data_dir(state);
+    rmdir("./tests/files");
+}
+
+void caps_create_sets_bits_for_known_features(void **state)
+{
+    Capabilities *caps = _create_caps(STANZA_NS_CHATSTATES, STANZA_NS_RECEIPTS);
+
+    assert_int_equal(FEATURE_CHATSTATES | FEATURE_RECEIPTS, caps->feature_bits);
+
+    caps_unref(caps);
+}
+
+void caps_create_ignores_unknown_features(void **state)
+{
+    Capabilities *caps = _create_caps("urn:xmpp:unknown", STANZA_NS_CARBONS);
+
+    assert_int_equal(FEATURE_CARBONS, caps->feature_bits);
+
+    caps_unref(caps);
+}
+
+void caps_create_no_features_sets_no_bits(void **state)
+{
+    Capabilities *caps = _create_caps(NULL, NULL);
+
+    assert_int_equal(0, caps->feature_bits);
+
+    caps_unref(caps);
+}
+
+void caps_jid_has_feature_false_for_unknown_jid(void **state)
+{
+    assert_false(caps_jid_has_feature("buddy@server.org/laptop", FEATURE_CHATSTATES));
+}
+
+void caps_jid_has_feature_found_by_jid(void **state)
+{
+    caps_add_by_jid("buddy@server.org/laptop", _create_caps(STANZA_NS_CHATSTATES, NULL));
+
+    assert_true(caps_jid_has_feature("buddy@server.org/laptop", FEATURE_CHATSTATES));
+    assert_false(caps_jid_has_feature("buddy@server.org/laptop", FEATURE_RECEIPTS));
+    assert_false(caps_jid_has_feature("buddy@server.org/phone", FEATURE_CHATSTATES));
+}
+
+void caps_jid_has_feature_found_by_ver(void **state)
+{
+    Capabilities *caps = _create_caps(STANZA_NS_RECEIPTS, STANZA_NS_PING);
+    caps_add_by_ver("ver1", caps);
+    caps_unref(caps);
+    caps_map_jid_to_ver("buddy@server.org/laptop", "ver1");
+    caps_map_jid_to_ver("buddy@server.org/phone", "ver1");
+
+    assert_true(caps_jid_has_feature("buddy@server.org/laptop", FEATURE_RECEIPTS));
+    assert_true(caps_jid_has_feature("buddy@server.org/phone", FEATURE_PING));
+    assert_false(caps_jid_has_feature("buddy@server.org/phone", FEATURE_CHATSTATES));
+}
+
+void caps_jid_has_feature_false_after_remove(void **state)
+{
+    Capabilities *caps = _create_caps(STANZA_NS_CHATSTATES, NULL);
+    caps_add_by_ver("ver1", caps);
+    caps_unref(caps);
+    caps_map_jid_to_ver("buddy@server.org/laptop", "ver1");
+
+    caps_remove_jid("buddy@server.org/laptop");
+
+    assert_false(caps_jid_has_feature("buddy@server.org/laptop", FEATURE_CHATSTATES));
+}
@@ -0,0 +1,10 @@
+void caps_before_test(void **state);
+void caps_after_test(void **state);
+
+void caps_create_sets_bits_for_known_features(void **state);
+void caps_create_ignores_unknown_features(void **state);
+void caps_create_no_features_sets_no_bits(void **state);
+void caps_jid_has_feature_false_for_unknown_jid(void **state);
+void caps_jid_has_feature_found_by_jid(void **state);
+void caps_jid_has_feature_found_by_ver(void **state);
+void caps_jid_has_feature_false_after_remove(void **state);
@@ -405,3 +405,61 @@ void contact_available_when_highest_priority_chat(void **state)
 
     p_contact_free(contact);
 }
+
+void contact_presence_updated_when_resource_replaced(void **state)
+{
+    PContact contact = p_contact_new("bob@server.com", "bob", NULL, "both",
+        "is offline", FALSE);
+
+    Resource *resource_online = resource_new("laptop", RESOURCE_ONLINE, NULL, 10);
+    Resource *resource_away = resource_new("laptop", RESOURCE_AWAY, "lunch", 10);
+    p_contact_set_presence(contact, resource_online);
+    p_contact_set_presence(contact, resource_away);
+
+    GList *resources = p_contact_get_available_resources(contact);
+
+    assert_string_equal("away", p_contact_presence(contact));
+    assert_string_equal("lunch", p_contact_status(contact));
+    assert_int_equal(1, g_list_length(resources));
+
+    g_list_free(resources);
+    p_contact_free(contact);
+}
+
+void contact_presence_falls_back_when_best_resource_removed(void **state)
+{
+    PContact contact = p_contact_new("bob@server.com", "bob", NULL, "both",
+        "is offline", FALSE);
+
+    Resource *resource10 = resource_new("resource10", RESOURCE_AWAY, NULL, 10);
+    Resource *resource20 = resource_new("resource20", RESOURCE_CHAT, NULL, 20);
+    p_contact_set_presence(contact, resource10);
+    p_contact_set_presence(contact, resource20);
+    p_contact_remove_resource(contact, "resource20");
+
+    assert_string_equal("away", p_contact_presence(contact));
+
+    p_contact_remove_resource(contact, "resource10");
+
+    assert_string_equal("offline", p_contact_presence(contact));
+    assert_string_equal("is offline", p_contact_status(contact));
+
+    p_contact_free(contact);
+}
+
+void contact_presence_updates_existing_resource(void **state)
+{
+    PContact contact = p_contact_new("bob@server.com", "bob", NULL, "both",
+        "is offline", FALSE);
+
+    Resource *first = resource_new("resource", RESOURCE_ONLINE, NULL, 10);
+    Resource *held = p_contact_set_presence(contact, first);
+    Resource *update = resource_new("resource", RESOURCE_XA, "gone", 10);
+    Resource *current = p_contact_set_presence(contact, update);
+
+    assert_ptr_equal(held, current);
+    assert_string_equal("xa", p_contact_presence(contact));
+    assert_string_equal("gone", p_contact_status(contact));
+
+    p_contact_free(contact);
+}
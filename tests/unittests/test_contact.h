@@ -22,3 +22,6 @@ void contact_not_available_when_highest_priority_xa(void **state);
 void contact_not_available_when_highest_priority_dnd(void **state);
 void contact_available_when_highest_priority_online(void **state);
 void contact_available_when_highest_priority_chat(void **state);
+void contact_presence_updated_when_resource_replaced(void **state);
+void contact_presence_falls_back_when_best_resource_removed(void **state);
+void contact_presence_updates_existing_resource(void **state);
@@ -182,4 +182,56 @@ void returns_barejid_when_fulljid_not_exists(void **state)
     char *result = jid_fulljid_or_barejid(jid);
 
     assert_string_equal("localpart@domainpart", result);
-}
\ No newline at end of file
+}
+
+void create_same_jid_returns_shared_jid(void **state)
+{
+    Jid *first = jid_create("myuser@mydomain/laptop");
+    Jid *second = jid_create("myuser@mydomain/laptop");
+
+    assert_ptr_equal(first, second);
+
+    jid_destroy(first);
+    jid_destroy(second);
+}
+
+void shared_jid_valid_after_other_reference_destroyed(void **state)
+{
+    Jid *first = jid_create("myuser@mydomain/desktop");
+    Jid *second = jid_create("myuser@mydomain/desktop");
+
+    jid_destroy(first);
+
+    assert_string_equal("myuser@mydomain", second->barejid);
+    assert_string_equal("desktop", second->resourcepart);
+
+    jid_destroy(second);
+}
+
+void jid_ref_shares_jid(void **state)
+{
+    Jid *jid = jid_create("myuser@mydomain");
+    Jid *ref = jid_ref(jid);
+
+    jid_destroy(jid);
+
+    assert_ptr_equal(jid, ref);
+    assert_string_equal("myuser@mydomain", ref->barejid);
+
+    jid_destroy(ref);
+}
+
+void jid_held_over_cache_clear_stays_valid(void **state)
+{
+    Jid *held = jid_create("myuser@mydomain/phone");
+    jid_cache_clear();
+
+    Jid *fresh = jid_create("myuser@mydomain/phone");
+
+    assert_ptr_not_equal(held, fresh);
+    assert_string_equal("phone", held->resourcepart);
+
+    jid_destroy(held);
+    jid_destroy(fresh);
+    jid_cache_clear();
+}
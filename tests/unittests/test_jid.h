@@ -23,3 +23,7 @@ void create_with_at_and_slash_in_resource(void **state);
 void create_full_with_trailing_slash(void **state);
 void returns_fulljid_when_exists(void **state);
 void returns_barejid_when_fulljid_not_exists(void **state);
+void create_same_jid_returns_shared_jid(void **state);
+void shared_jid_valid_after_other_reference_destroyed(void **state);
+void jid_ref_shares_jid(void **state);
+void jid_held_over_cache_clear_stays_valid(void **state);
@@ -0,0 +1,59 @@
+#include <glib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+
+#include "tools/keyword_matcher.h"
+
+void keyword_matcher_empty_matches_nothing(void **state)
+{
+    KeywordMatcher matcher = keyword_matcher_new(NULL);
+
+    assert_false(keyword_matcher_match(matcher, "some message"));
+
+    keyword_matcher_free(matcher);
+}
+
+void keyword_matcher_matches_ignoring_case(void **state)
+{
+    GList *keywords = g_list_append(NULL, "Bob");
+    KeywordMatcher matcher = keyword_matcher_new(keywords);
+
+    assert_true(keyword_matcher_match(matcher, "hello BOB, are you there"));
+    assert_false(keyword_matcher_match(matcher, "hello bill"));
+
+    keyword_matcher_free(matcher);
+    g_list_free(keywords);
+}
+
+void keyword_matcher_matches_any_keyword(void **state)
+{
+    GList *keywords = NULL;
+    keywords = g_list_append(keywords, "he");
+    keywords = g_list_append(keywords, "she");
+    keywords = g_list_append(keywords, "hers");
+    KeywordMatcher matcher = keyword_matcher_new(keywords);
+
+    assert_true(keyword_matcher_match(matcher, "ushers"));
+    assert_true(keyword_matcher_match(matcher, "xshx he"));
+    assert_false(keyword_matcher_match(matcher, "shx"));
+
+    keyword_matcher_free(matcher);
+    g_list_free(keywords);
+}
+
+void keyword_matcher_matches_after_failed_partial_match(void **state)
+{
+    GList *keywords = NULL;
+    keywords = g_list_append(keywords, "abcd");
+    keywords = g_list_append(keywords, "bcx");
+    KeywordMatcher matcher = keyword_matcher_new(keywords);
+
+    assert_true(keyword_matcher_match(matcher, "zabcx"));
+    assert_false(keyword_matcher_match(matcher, "abcabc"));
+
+    keyword_matcher_free(matcher);
+    g_list_free(keywords);
+}
@@ -0,0 +1,4 @@
+void keyword_matcher_empty_matches_nothing(void **state);
+void keyword_matcher_matches_ignoring_case(void **state);
+void keyword_matcher_matches_any_keyword(void **state);
+void keyword_matcher_matches_after_failed_partial_match(void **state);
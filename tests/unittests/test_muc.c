@@ -76,3 +76,151 @@ void test_muc_active(void **state)
 
     assert_true(room_is_active);
 }
+
+void test_muc_roster_sorted_by_nick(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "mike", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "alice", NULL, "moderator", "none", NULL, NULL);
+    muc_roster_add(room, "zoe", NULL, "visitor", "none", NULL, NULL);
+
+    GList *occupants = muc_roster(room);
+
+    assert_int_equal(3, g_list_length(occupants));
+    assert_string_equal("alice", ((Occupant *)g_list_nth_data(occupants, 0))->nick);
+    assert_string_equal("mike", ((Occupant *)g_list_nth_data(occupants, 1))->nick);
+    assert_string_equal("zoe", ((Occupant *)g_list_nth_data(occupants, 2))->nick);
+
+    g_list_free(occupants);
+}
+
+void test_muc_occupants_by_role_updated_on_role_change(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "mike", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "alice", NULL, "participant", "none", NULL, NULL);
+    muc_roster_add(room, "mike", NULL, "moderator", "none", NULL, NULL);
+
+    GSList *moderators = muc_occupants_by_role(room, MUC_ROLE_MODERATOR);
+    GSList *participants = muc_occupants_by_role(room, MUC_ROLE_PARTICIPANT);
+
+    assert_int_equal(1, g_slist_length(moderators));
+    assert_string_equal("mike", ((Occupant *)moderators->data)->nick);
+    assert_int_equal(1, g_slist_length(participants));
+    assert_string_equal("alice", ((Occupant *)participants->data)->nick);
+
+    g_slist_free(moderators);
+    g_slist_free(participants);
+}
+
+void test_muc_roster_remove_removes_from_role(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "mike", NULL, "visitor", "none", NULL, NULL);
+    muc_roster_remove(room, "mike");
+
+    GList *occupants = muc_roster(room);
+    GSList *visitors = muc_occupants_by_role(room, MUC_ROLE_VISITOR);
+
+    assert_null(occupants);
+    assert_null(visitors);
+}
+
+void test_muc_roster_size_counts_occupants(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "mike", NULL, "visitor", "none", NULL, NULL);
+    muc_roster_add(room, "anna", NULL, "moderator", "owner", NULL, NULL);
+    muc_roster_remove(room, "mike");
+
+    assert_int_equal(1, muc_roster_size(room));
+    assert_int_equal(0, muc_roster_size("other@server.org"));
+}
+
+void test_muc_last_seen_null_when_no_messages(void **state)
+{
+    GDateTime *last_seen = muc_last_seen("room@server.org");
+
+    assert_null(last_seen);
+}
+
+void test_muc_last_seen_keeps_latest(void **state)
+{
+    char *room = "room@server.org";
+    GDateTime *earlier = g_date_time_new_utc(2015, 10, 1, 10, 0, 0);
+    GDateTime *later = g_date_time_new_utc(2015, 10, 1, 11, 0, 0);
+    muc_set_last_seen(room, later);
+    muc_set_last_seen(room, earlier);
+
+    GDateTime *last_seen = muc_last_seen(room);
+
+    assert_int_equal(0, g_date_time_compare(later, last_seen));
+
+    g_date_time_unref(earlier);
+    g_date_time_unref(later);
+}
+
+void test_muc_last_seen_kept_after_leave(void **state)
+{
+    char *room = "room@server.org";
+    GDateTime *timestamp = g_date_time_new_utc(2015, 10, 1, 10, 0, 0);
+    muc_join(room, "bob", NULL, FALSE);
+    muc_set_last_seen(room, timestamp);
+    muc_leave(room);
+
+    GDateTime *last_seen = muc_last_seen(room);
+
+    assert_int_equal(0, g_date_time_compare(timestamp, last_seen));
+
+    g_date_time_unref(timestamp);
+}
+
+void test_muc_message_mentions_nick_ignoring_case(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "Bob", NULL, FALSE);
+
+    assert_true(muc_message_mentions(room, "hi bob"));
+    assert_false(muc_message_mentions(room, "hi bill"));
+}
+
+void test_muc_message_mentions_trigger(void **state)
+{
+    char *room = "room@server.org";
+    GList *triggers = g_list_append(NULL, "kernel");
+    muc_join(room, "bob", NULL, FALSE);
+    muc_set_mention_triggers(triggers);
+
+    assert_true(muc_message_mentions(room, "new Kernel release"));
+
+    g_list_free(triggers);
+}
+
+void test_muc_message_mentions_new_nick(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_nick_change_start(room, "robert");
+    muc_nick_change_complete(room, "robert");
+
+    assert_true(muc_message_mentions(room, "hi robert"));
+}
+
+void test_muc_roster_add_updates_occupant_in_place(void **state)
+{
+    char *room = "room@server.org";
+    muc_join(room, "bob", NULL, FALSE);
+    muc_roster_add(room, "mike", NULL, "participant", "none", NULL, NULL);
+    Occupant *before = muc_roster_item(room, "mike");
+
+    muc_roster_add(room, "mike", NULL, "participant", "none", "away", "lunch");
+    Occupant *after = muc_roster_item(room, "mike");
+
+    assert_ptr_equal(before, after);
+    assert_int_equal(RESOURCE_AWAY, after->presence);
+    assert_string_equal("lunch", after->status);
+}
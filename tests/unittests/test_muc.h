@@ -7,3 +7,14 @@ void test_muc_invites_count_0(void **state);
 void test_muc_invites_count_5(void **state);
 void test_muc_room_is_not_active(void **state);
 void test_muc_active(void **state);
+void test_muc_roster_sorted_by_nick(void **state);
+void test_muc_occupants_by_role_updated_on_role_change(void **state);
+void test_muc_roster_remove_removes_from_role(void **state);
+void test_muc_roster_size_counts_occupants(void **state);
+void test_muc_last_seen_null_when_no_messages(void **state);
+void test_muc_last_seen_keeps_latest(void **state);
+void test_muc_last_seen_kept_after_leave(void **state);
+void test_muc_message_mentions_nick_ignoring_case(void **state);
+void test_muc_message_mentions_trigger(void **state);
+void test_muc_message_mentions_new_nick(void **state);
+void test_muc_roster_add_updates_occupant_in_place(void **state);
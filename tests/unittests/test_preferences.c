@@ -31,3 +31,58 @@ void statuses_muc_defaults_to_all(void **state)
     assert_non_null(setting);
     assert_string_equal("all", setting);
 }
+
+void string_const_defaults_to_default_value(void **state)
+{
+    const char *setting = prefs_get_string_const(PREF_ROSTER_BY);
+
+    assert_non_null(setting);
+    assert_string_equal("presence", setting);
+}
+
+void string_const_updated_when_set(void **state)
+{
+    prefs_set_string(PREF_ROSTER_BY, "group");
+
+    const char *setting = prefs_get_string_const(PREF_ROSTER_BY);
+
+    assert_non_null(setting);
+    assert_string_equal("group", setting);
+}
+
+void string_reverts_to_default_when_removed(void **state)
+{
+    prefs_set_string(PREF_ROSTER_BY, "group");
+    prefs_set_string(PREF_ROSTER_BY, NULL);
+
+    char *setting = prefs_get_string(PREF_ROSTER_BY);
+
+    assert_non_null(setting);
+    assert_string_equal("presence", setting);
+    prefs_free_string(setting);
+}
+
+void boolean_updated_when_set(void **state)
+{
+    assert_true(prefs_get_boolean(PREF_WRAP));
+
+    prefs_set_boolean(PREF_WRAP, FALSE);
+
+    assert_false(prefs_get_boolean(PREF_WRAP));
+}
+
+void inpblock_defaults_when_zero(void **state)
+{
+    prefs_set_inpblock(0);
+
+    assert_int_equal(1000, prefs_get_inpblock());
+}
+
+void wins_hibernate_off_by_default(void **state)
+{
+    assert_int_equal(0, prefs_get_wins_hibernate());
+
+    prefs_set_wins_hibernate(30);
+
+    assert_int_equal(30, prefs_get_wins_hibernate());
+}
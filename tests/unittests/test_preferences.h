@@ -1,3 +1,9 @@
 void statuses_console_defaults_to_all(void **state);
 void statuses_chat_defaults_to_all(void **state);
 void statuses_muc_defaults_to_all(void **state);
+void string_const_defaults_to_default_value(void **state);
+void string_const_updated_when_set(void **state);
+void string_reverts_to_default_when_removed(void **state);
+void boolean_updated_when_set(void **state);
+void inpblock_defaults_when_zero(void **state);
+void wins_hibernate_off_by_default(void **state);
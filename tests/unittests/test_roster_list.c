@@ -7,6 +7,7 @@
 #include <stdlib.h>
 
 #include "contact.h"
+#include "resource.h"
 #include "roster_list.h"
 
 void empty_list_when_none_added(void **state)
@@ -269,3 +270,140 @@ void find_twice_returns_first_when_two_match_and_reset(void **state)
     free(result2);
     roster_free();
 }
+
+void contacts_reordered_after_name_change(void **state)
+{
+    roster_init();
+    roster_add("james@server.org", "James", NULL, NULL, FALSE);
+    roster_add("bob@server.org", "Bob", NULL, NULL, FALSE);
+    PContact bob = roster_get_contact("bob@server.org");
+    roster_change_name(bob, "Zed");
+
+    GSList *list = roster_get_contacts();
+    PContact first = list->data;
+    PContact second = (g_slist_next(list))->data;
+
+    assert_int_equal(2, g_slist_length(list));
+    assert_string_equal("james@server.org", p_contact_barejid(first));
+    assert_string_equal("bob@server.org", p_contact_barejid(second));
+    g_slist_free(list);
+    roster_free();
+}
+
+void get_group_returns_members_in_order(void **state)
+{
+    roster_init();
+    GSList *friends1 = g_slist_append(NULL, strdup("friends"));
+    GSList *friends2 = g_slist_append(NULL, strdup("friends"));
+    GSList *work = g_slist_append(NULL, strdup("work"));
+    roster_add("james@server.org", NULL, friends1, NULL, FALSE);
+    roster_add("dave@server.org", NULL, work, NULL, FALSE);
+    roster_add("bob@server.org", NULL, friends2, NULL, FALSE);
+    roster_add("mike@server.org", NULL, NULL, NULL, FALSE);
+
+    GSList *list = roster_get_group("friends");
+    GSList *nogroup = roster_get_nogroup();
+
+    assert_int_equal(2, g_slist_length(list));
+    assert_string_equal("bob@server.org", p_contact_barejid(list->data));
+    assert_string_equal("james@server.org", p_contact_barejid(g_slist_next(list)->data));
+    assert_int_equal(1, g_slist_length(nogroup));
+    assert_string_equal("mike@server.org", p_contact_barejid(nogroup->data));
+    g_slist_free(list);
+    g_slist_free(nogroup);
+    roster_free();
+}
+
+void get_group_updated_when_groups_change(void **state)
+{
+    roster_init();
+    GSList *friends = g_slist_append(NULL, strdup("friends"));
+    GSList *work = g_slist_append(NULL, strdup("work"));
+    roster_add("james@server.org", NULL, friends, NULL, FALSE);
+    roster_update("james@server.org", NULL, work, NULL, FALSE);
+
+    GSList *friends_list = roster_get_group("friends");
+    GSList *work_list = roster_get_group("work");
+
+    assert_null(friends_list);
+    assert_int_equal(1, g_slist_length(work_list));
+    g_slist_free(work_list);
+    roster_free();
+}
+
+void contacts_by_presence_updated_on_presence_change(void **state)
+{
+    roster_init();
+    roster_add("james@server.org", NULL, NULL, NULL, FALSE);
+    roster_add("bob@server.org", NULL, NULL, NULL, FALSE);
+    Resource *resource = resource_new("laptop", RESOURCE_AWAY, NULL, 10);
+    roster_update_presence("james@server.org", resource, NULL);
+
+    GSList *away = roster_get_contacts_by_presence("away");
+    GSList *offline = roster_get_contacts_by_presence("offline");
+    GSList *online = roster_get_contacts_online();
+
+    assert_int_equal(1, g_slist_length(away));
+    assert_string_equal("james@server.org", p_contact_barejid(away->data));
+    assert_int_equal(1, g_slist_length(offline));
+    assert_string_equal("bob@server.org", p_contact_barejid(offline->data));
+    assert_int_equal(1, g_slist_length(online));
+    g_slist_free(away);
+    g_slist_free(offline);
+    g_slist_free(online);
+
+    roster_contact_offline("james@server.org", "laptop", NULL);
+    offline = roster_get_contacts_by_presence("offline");
+    away = roster_get_contacts_by_presence("away");
+
+    assert_int_equal(2, g_slist_length(offline));
+    assert_null(away);
+    g_slist_free(offline);
+    roster_free();
+}
+
+void removed_contact_not_in_views(void **state)
+{
+    roster_init();
+    GSList *friends = g_slist_append(NULL, strdup("friends"));
+    roster_add("james@server.org", NULL, friends, NULL, FALSE);
+    roster_add("bob@server.org", NULL, NULL, NULL, FALSE);
+    roster_remove("james@server.org", "james@server.org");
+
+    GSList *list = roster_get_contacts();
+    GSList *group = roster_get_group("friends");
+
+    assert_int_equal(1, g_slist_length(list));
+    assert_string_equal("bob@server.org", p_contact_barejid(list->data));
+    assert_null(group);
+    g_slist_free(list);
+    roster_free();
+}
+
+void bulk_add_builds_contacts_and_autocomplete(void **state)
+{
+    roster_init();
+    GSList *friends = g_slist_append(NULL, strdup("friends"));
+    roster_add_bulk_begin();
+    roster_add("james@server.org", "James", friends, NULL, FALSE);
+    roster_add("bob@server.org", NULL, NULL, NULL, FALSE);
+    roster_add("bob@server.org", NULL, NULL, NULL, FALSE);
+    roster_add_bulk_end();
+
+    GSList *list = roster_get_contacts();
+    GSList *groups = roster_get_groups();
+    char *name = roster_contact_autocomplete("Jam");
+    char *barejid = roster_barejid_autocomplete("bo");
+
+    assert_int_equal(2, g_slist_length(list));
+    assert_int_equal(1, g_slist_length(groups));
+    assert_string_equal("friends", groups->data);
+    assert_string_equal("James", name);
+    assert_string_equal("bob@server.org", barejid);
+    assert_string_equal("james@server.org", roster_barejid_from_name("James"));
+    g_slist_free(list);
+    g_slist_free_full(groups, free);
+    free(name);
+    free(barejid);
+    roster_free();
+}
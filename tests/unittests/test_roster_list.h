@@ -16,3 +16,9 @@ void find_on_empty_returns_null(void **state);
 void find_twice_returns_second_when_two_match(void **state);
 void find_five_times_finds_fifth(void **state);
 void find_twice_returns_first_when_two_match_and_reset(void **state);
+void contacts_reordered_after_name_change(void **state);
+void get_group_returns_members_in_order(void **state);
+void get_group_updated_when_groups_change(void **state);
+void contacts_by_presence_updated_on_presence_change(void **state);
+void removed_contact_not_in_views(void **state);
+void bulk_add_builds_contacts_and_autocomplete(void **state);
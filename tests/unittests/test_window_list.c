@@ -0,0 +1,170 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "ui/win_types.h"
+#include "window_list.h"
+
+#define TEST_MAX_WINS 12
+
+static ProfChatWin chatwins[TEST_MAX_WINS];
+static int chatwins_used;
+
+static ProfWin*
+_new_chat(const char * const barejid)
+{
+    assert_true(chatwins_used < TEST_MAX_WINS);
+    ProfChatWin *chatwin = &chatwins[chatwins_used++];
+    memset(chatwin, 0, sizeof(ProfChatWin));
+    chatwin->window.type = WIN_CHAT;
+    chatwin->barejid = (char*)barejid;
+    chatwin->memcheck = PROFCHATWIN_MEMCHECK;
+
+    will_return(win_create_chat, chatwin);
+    return wins_new_chat(barejid);
+}
+
+static void
+_new_chats(int count)
+{
+    static const char * const barejids[] = {
+        "a@server.org", "b@server.org", "c@server.org", "d@server.org",
+        "e@server.org", "f@server.org", "g@server.org", "h@server.org",
+        "i@server.org", "j@server.org", "k@server.org", "l@server.org"
+    };
+
+    int i;
+    for (i = 0; i < count; i++) {
+        _new_chat(barejids[chatwins_used]);
+    }
+}
+
+void wins_before_test(void **state)
+{
+    chatwins_used = 0;
+    wins_init();
+}
+
+void wins_after_test(void **state)
+{
+    wins_destroy();
+}
+
+void wins_new_takes_next_num_after_console(void **state)
+{
+    ProfWin *first = _new_chat("a@server.org");
+    ProfWin *second = _new_chat("b@server.org");
+
+    assert_int_equal(2, wins_get_num(first));
+    assert_int_equal(3, wins_get_num(second));
+}
+
+void wins_tenth_win_takes_num_0(void **state)
+{
+    _new_chats(8);
+
+    ProfWin *tenth = _new_chat("tenth@server.org");
+    ProfWin *eleventh = _new_chat("eleventh@server.org");
+
+    assert_int_equal(0, wins_get_num(tenth));
+    assert_int_equal(11, wins_get_num(eleventh));
+}
+
+void wins_new_fills_first_gap_after_close(void **state)
+{
+    _new_chats(4);
+    wins_close_by_num(3);
+
+    ProfWin *window = _new_chat("new@server.org");
+
+    assert_int_equal(3, wins_get_num(window));
+}
+
+void wins_new_fills_0_before_11_after_close(void **state)
+{
+    _new_chats(10);
+    wins_close_by_num(0);
+
+    ProfWin *window = _new_chat("new@server.org");
+
+    assert_int_equal(0, wins_get_num(window));
+}
+
+void wins_swap_into_empty_frees_source_num(void **state)
+{
+    _new_chats(1);
+    ProfWin *moved = _new_chat("moved@server.org");
+
+    gboolean result = wins_swap(3, 7);
+    ProfWin *window = _new_chat("new@server.org");
+
+    assert_true(result);
+    assert_ptr_equal(moved, wins_get_by_num(7));
+    assert_int_equal(3, wins_get_num(window));
+}
+
+void wins_tidy_closes_gaps(void **state)
+{
+    _new_chats(2);
+    ProfWin *last = _new_chat("last@server.org");
+    wins_close_by_num(2);
+
+    gboolean result = wins_tidy();
+    ProfWin *window = _new_chat("new@server.org");
+
+    assert_true(result);
+    assert_int_equal(3, wins_get_num(last));
+    assert_int_equal(4, wins_get_num(window));
+}
+
+void wins_tidy_moves_tenth_win_to_0(void **state)
+{
+    _new_chats(9);
+    ProfWin *last = _new_chat("last@server.org");
+    wins_close_by_num(2);
+
+    wins_tidy();
+    ProfWin *window = _new_chat("new@server.org");
+
+    assert_int_equal(0, wins_get_num(last));
+    assert_int_equal(11, wins_get_num(window));
+}
+
+void wins_tidy_not_required_without_gaps(void **state)
+{
+    _new_chats(3);
+
+    gboolean result = wins_tidy();
+
+    assert_false(result);
+}
+
+void wins_total_unread_counts_all_wins(void **state)
+{
+    ProfWin *first = _new_chat("a@server.org");
+    ProfWin *second = _new_chat("b@server.org");
+    wins_add_unread(first);
+    wins_add_unread(first);
+    wins_add_unread(second);
+
+    assert_int_equal(3, wins_get_total_unread());
+}
+
+void wins_total_unread_drops_on_focus_and_close(void **state)
+{
+    ProfWin *first = _new_chat("a@server.org");
+    ProfWin *second = _new_chat("b@server.org");
+    wins_add_unread(first);
+    wins_add_unread(first);
+    wins_add_unread(second);
+
+    wins_set_current_by_num(wins_get_num(first));
+    assert_int_equal(1, wins_get_total_unread());
+
+    wins_close_by_num(wins_get_num(second));
+    assert_int_equal(0, wins_get_total_unread());
+}
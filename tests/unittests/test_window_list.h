@@ -0,0 +1,13 @@
+void wins_before_test(void **state);
+void wins_after_test(void **state);
+
+void wins_new_takes_next_num_after_console(void **state);
+void wins_tenth_win_takes_num_0(void **state);
+void wins_new_fills_first_gap_after_close(void **state);
+void wins_new_fills_0_before_11_after_close(void **state);
+void wins_swap_into_empty_frees_source_num(void **state);
+void wins_tidy_closes_gaps(void **state);
+void wins_tidy_moves_tenth_win_to_0(void **state);
+void wins_tidy_not_required_without_gaps(void **state);
+void wins_total_unread_counts_all_wins(void **state);
+void wins_total_unread_drops_on_focus_and_close(void **state);
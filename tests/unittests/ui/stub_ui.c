@@ -453,6 +453,7 @@ void cons_theme_setting(void) {}
 void cons_privileges_setting(void) {}
 void cons_beep_setting(void) {}
 void cons_flash_setting(void) {}
+void cons_fuzzy_setting(void) {}
 void cons_splash_setting(void) {}
 void cons_vercheck_setting(void) {}
 void cons_resource_setting(void) {}
@@ -479,6 +480,7 @@ void cons_chlog_setting(void) {}
 void cons_grlog_setting(void) {}
 void cons_autoaway_setting(void) {}
 void cons_reconnect_setting(void) {}
+void cons_sm_setting(void) {}
 void cons_autoping_setting(void) {}
 void cons_priority_setting(void) {}
 void cons_autoconnect_setting(void) {}
@@ -502,6 +504,8 @@ void status_bar_set_all_inactive(void) {}
 
 // roster window
 void rosterwin_roster(void) {}
+void rosterwin_redraw(void) {}
+void rosterwin_update(void) {}
 
 // occupants window
 void occupantswin_occupants(const char * const room) {}
@@ -536,10 +540,24 @@ void win_update_virtual(ProfWin *window) {}
 void win_free(ProfWin *window) {}
 int win_unread(ProfWin *window)
 {
+    if (window && window->type == WIN_CHAT) {
+        return ((ProfChatWin*)window)->unread;
+    }
     return 0;
 }
 
 void win_resize(ProfWin *window) {}
+void win_hibernate(ProfWin *window) {}
+gboolean win_is_hibernated(ProfWin *window)
+{
+    return FALSE;
+}
+
+gsize win_mem_size(ProfWin *window)
+{
+    return 0;
+}
+
 void win_hide_subwin(ProfWin *window) {}
 void win_show_subwin(ProfWin *window) {}
 void win_refresh_without_subwin(ProfWin *window) {}
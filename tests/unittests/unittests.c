@@ -12,6 +12,7 @@
 
 #include "helpers.h"
 #include "test_autocomplete.h"
+#include "test_keyword_matcher.h"
 #include "test_chat_session.h"
 #include "test_common.h"
 #include "test_contact.h"
@@ -34,6 +35,9 @@
 #include "test_cmd_roster.h"
 #include "test_cmd_disconnect.h"
 #include "test_form.h"
+#include "test_capabilities.h"
+#include "test_window_list.h"
+#include "test_buffer.h"
 
 int main(int argc, char* argv[]) {
     const UnitTest all_tests[] = {
@@ -70,6 +74,22 @@ int main(int argc, char* argv[]) {
         unit_test(next_available_0_in_first_gap),
         unit_test(next_available_11_in_first_gap),
         unit_test(next_available_24_first_big_gap),
+        unit_test_setup_teardown(wins_new_takes_next_num_after_console, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_tenth_win_takes_num_0, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_new_fills_first_gap_after_close, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_new_fills_0_before_11_after_close, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_swap_into_empty_frees_source_num, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_tidy_closes_gaps, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_tidy_moves_tenth_win_to_0, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_tidy_not_required_without_gaps, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_total_unread_counts_all_wins, wins_before_test, wins_after_test),
+        unit_test_setup_teardown(wins_total_unread_drops_on_focus_and_close, wins_before_test, wins_after_test),
+
+        unit_test(buffer_pack_unpack_keeps_entries),
+        unit_test(buffer_mark_received_while_packed),
+        unit_test(buffer_push_while_packed_kept_on_unpack),
+        unit_test(buffer_push_while_packed_keeps_newest),
+        unit_test(buffer_push_while_packed_bounds_memory),
         unit_test(test_online_is_valid_resource_presence_string),
         unit_test(test_chat_is_valid_resource_presence_string),
         unit_test(test_away_is_valid_resource_presence_string),
@@ -114,6 +134,23 @@ int main(int argc, char* argv[]) {
         unit_test(add_two_adds_two),
         unit_test(add_two_same_adds_one),
         unit_test(add_two_same_updates),
+        unit_test(add_all_adds_sorted_without_duplicates),
+        unit_test(add_all_then_complete),
+        unit_test(add_after_add_all_with_duplicates_completes),
+        unit_test(complete_continues_cycle_after_add_before_last_found),
+        unit_test(complete_wraps_to_first_match),
+        unit_test(fuzzy_completes_substring_match),
+        unit_test(fuzzy_ranks_recently_used_first),
+        unit_test(fuzzy_disabled_uses_prefix_completion),
+        unit_test(static_completes_base_and_added_items_in_order),
+        unit_test(static_completes_added_items_between_base_items),
+        unit_test(static_add_existing_item_not_duplicated),
+        unit_test(static_clear_removes_added_items_only),
+
+        unit_test(keyword_matcher_empty_matches_nothing),
+        unit_test(keyword_matcher_matches_ignoring_case),
+        unit_test(keyword_matcher_matches_any_keyword),
+        unit_test(keyword_matcher_matches_after_failed_partial_match),
 
         unit_test(create_jid_from_null_returns_null),
         unit_test(create_jid_from_empty_string_returns_null),
@@ -140,6 +177,10 @@ int main(int argc, char* argv[]) {
         unit_test(create_full_with_trailing_slash),
         unit_test(returns_fulljid_when_exists),
         unit_test(returns_barejid_when_fulljid_not_exists),
+        unit_test(create_same_jid_returns_shared_jid),
+        unit_test(shared_jid_valid_after_other_reference_destroyed),
+        unit_test(jid_ref_shares_jid),
+        unit_test(jid_held_over_cache_clear_stays_valid),
 
         unit_test(parse_null_returns_null),
         unit_test(parse_empty_returns_null),
@@ -210,6 +251,12 @@ int main(int argc, char* argv[]) {
         unit_test(find_twice_returns_second_when_two_match),
         unit_test(find_five_times_finds_fifth),
         unit_test(find_twice_returns_first_when_two_match_and_reset),
+        unit_test(contacts_reordered_after_name_change),
+        unit_test(get_group_returns_members_in_order),
+        unit_test(get_group_updated_when_groups_change),
+        unit_test(contacts_by_presence_updated_on_presence_change),
+        unit_test(removed_contact_not_in_views),
+        unit_test(bulk_add_builds_contacts_and_autocomplete),
 
         unit_test_setup_teardown(returns_false_when_chat_session_does_not_exist,
             init_chat_sessions,
@@ -394,6 +441,9 @@ int main(int argc, char* argv[]) {
         unit_test(contact_not_available_when_highest_priority_dnd),
         unit_test(contact_available_when_highest_priority_online),
         unit_test(contact_available_when_highest_priority_chat),
+        unit_test(contact_presence_updated_when_resource_replaced),
+        unit_test(contact_presence_falls_back_when_best_resource_removed),
+        unit_test(contact_presence_updates_existing_resource),
 
         unit_test(cmd_statuses_shows_usage_when_bad_subcmd),
         unit_test(cmd_statuses_shows_usage_when_bad_console_setting),
@@ -436,6 +486,24 @@ int main(int argc, char* argv[]) {
         unit_test_setup_teardown(statuses_muc_defaults_to_all,
             load_preferences,
             close_preferences),
+        unit_test_setup_teardown(string_const_defaults_to_default_value,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(string_const_updated_when_set,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(string_reverts_to_default_when_removed,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(boolean_updated_when_set,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(inpblock_defaults_when_zero,
+            load_preferences,
+            close_preferences),
+        unit_test_setup_teardown(wins_hibernate_off_by_default,
+            load_preferences,
+            close_preferences),
 
         unit_test_setup_teardown(console_shows_online_presence_when_set_online,
             load_preferences,
@@ -475,6 +543,17 @@ int main(int argc, char* argv[]) {
         unit_test_setup_teardown(test_muc_invites_count_5, muc_before_test, muc_after_test),
         unit_test_setup_teardown(test_muc_room_is_not_active, muc_before_test, muc_after_test),
         unit_test_setup_teardown(test_muc_active, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_roster_sorted_by_nick, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_occupants_by_role_updated_on_role_change, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_roster_remove_removes_from_role, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_roster_size_counts_occupants, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_last_seen_null_when_no_messages, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_last_seen_keeps_latest, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_last_seen_kept_after_leave, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_message_mentions_nick_ignoring_case, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_message_mentions_trigger, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_message_mentions_new_nick, muc_before_test, muc_after_test),
+        unit_test_setup_teardown(test_muc_roster_add_updates_occupant_in_place, muc_before_test, muc_after_test),
 
         unit_test(cmd_bookmark_shows_message_when_disconnected),
         unit_test(cmd_bookmark_shows_message_when_disconnecting),
@@ -608,6 +687,14 @@ int main(int argc, char* argv[]) {
         unit_test(remove_text_multi_value_removes_when_one),
         unit_test(remove_text_multi_value_removes_when_many),
 
+        unit_test_setup_teardown(caps_create_sets_bits_for_known_features, caps_before_test, caps_after_test),
+        unit_test_setup_teardown(caps_create_ignores_unknown_features, caps_before_test, caps_after_test),
+        unit_test_setup_teardown(caps_create_no_features_sets_no_bits, caps_before_test, caps_after_test),
+        unit_test_setup_teardown(caps_jid_has_feature_false_for_unknown_jid, caps_before_test, caps_after_test),
+        unit_test_setup_teardown(caps_jid_has_feature_found_by_jid, caps_before_test, caps_after_test),
+        unit_test_setup_teardown(caps_jid_has_feature_found_by_ver, caps_before_test, caps_after_test),
+        unit_test_setup_teardown(caps_jid_has_feature_false_after_remove, caps_before_test, caps_after_test),
+
         unit_test(clears_chat_sessions),
     };
 
@@ -27,11 +27,18 @@ jabber_conn_status_t jabber_connect_with_account(const ProfAccount * const accou
 void jabber_disconnect(void) {}
 void jabber_shutdown(void) {}
 void jabber_process_events(int millis) {}
+void jabber_cork(void) {}
+void jabber_uncork(void) {}
 const char * jabber_get_fulljid(void)
 {
     return (char *)mock();
 }
 
+Jid * jabber_get_jid(void)
+{
+    return NULL;
+}
+
 const char * jabber_get_domain(void)
 {
     return NULL;
@@ -132,6 +139,9 @@ gboolean presence_sub_request_exists(const char * const bare_jid)
     return FALSE;
 }
 
+// stream management functions
+void sm_enable(void) {}
+
 // iq functions
 void iq_disable_carbons() {};
 void iq_enable_carbons() {};
@@ -167,15 +177,6 @@ void iq_room_role_set(const char * const room, const char * const nick, char *ro
 void iq_room_role_list(const char * const room, char *role) {}
 void iq_last_activity_request(gchar *jid) {}
 
-// caps functions
-Capabilities* caps_lookup(const char * const jid)
-{
-    return NULL;
-}
-
-void caps_close(void) {}
-void caps_destroy(Capabilities *caps) {}
-
 gboolean bookmark_add(const char *jid, const char *nick, const char *password, const char *autojoin_str)
 {
     check_expected(jid);